@@ -0,0 +1,440 @@
+import json
+import os
+import random
+import shutil
+import sys
+import tempfile
+import uuid
+import zlib
+
+from pdbgen import *
+from pdbtest import *
+
+#
+# Benchmark of pdbex on synthetic PDBs.
+#
+#   python3 Scripts/benchmark.py Build/pdbex -o results.json
+#   python3 Scripts/benchmark.py Build/pdbex -b results.json
+#
+# Each fixture is a generated PDB stressing one part of pdbex:
+#   small_types      - many small structs,
+#   huge_structs     - few structs with tens of thousands of members
+#                      (and a padding between each two of them),
+#   deep_nesting     - structs with deeply nested unnamed types
+#                      and a long chain of structs embedded by value,
+#   massive_enums    - enums with tens of thousands of enumerators,
+#   bitfield_unions  - unions of bitfields and structs of bitfields,
+#   fan_out          - '%' of a tree of structs embedded by value,
+#                      every file prints the whole subtree,
+#   small_types_one  - single struct of small_types (the largest PDB),
+#                      nothing else has to be decoded,
+#   small_types_w0   - small_types with -w 0 (thread per core),
+#                      whatever the -w of the script is.
+#
+# The fixtures are generated from fixed seeds, so they're the same
+# on every run (for the same --scale).  pdbex reports the time
+# of its phases (--stats=json); the load, sort and render (declarations,
+# definitions and files of '%') phases are measured separately, the best
+# time of the runs is taken.
+#
+# Results are printed as a table and they can be written (-o) as JSON.
+# Results stored earlier can be used as the baseline (-b), the phases
+# which got slower by more than the threshold are reported as regressions
+# and the script then fails.
+#
+
+DEFAULT_REPEAT_COUNT = 3
+DEFAULT_THREAD_COUNT = 1
+DEFAULT_SCALE        = 1.0
+DEFAULT_THRESHOLD    = 0.10
+
+#
+# Differences below this time (in seconds) are never regressions,
+# they're in the noise of the measurement.
+#
+
+MIN_REGRESSION_TIME = 0.02
+
+MEASURED_PHASES = ['load', 'sort', 'render', 'total']
+
+
+def scaled(count, scale):
+	return max(1, int(count * scale))
+
+
+def build_small_types(g, rng, scale):
+	basic_types = [(T_CHAR, 1), (T_USHORT, 2), (T_INT4, 4), (T_UQUAD, 8)]
+
+	previous = None
+
+	for i in range(scaled(100000, scale)):
+		members = []
+		offset = 0
+
+		for j in range(rng.randint(2, 4)):
+			type_index, size = rng.choice(basic_types)
+
+			offset = (offset + size - 1) // size * size
+			members.append(('Member%d' % j, type_index, offset))
+			offset += size
+
+		if previous is not None:
+			offset = (offset + 7) // 8 * 8
+			members.append(('Previous', g.pointer(previous), offset))
+			offset += 8
+
+		previous = g.udt('_SMALL%d' % i, members, offset)
+
+
+def build_huge_structs(g, rng, scale):
+	basic_types = [(T_CHAR, 1), (T_USHORT, 2), (T_INT4, 4), (T_UQUAD, 8), (T_REAL64, 8)]
+
+	for i in range(4):
+		members = []
+		offset = 0
+
+		for j in range(scaled(50000, scale)):
+			type_index, size = rng.choice(basic_types)
+
+			members.append(('Member%d' % j, type_index, offset))
+			offset += size + rng.randint(1, 3)
+
+		g.udt('_HUGE%d' % i, members, offset)
+
+
+def build_deep_nesting(g, rng, scale):
+	depth = 32
+
+	for i in range(scaled(500, scale)):
+		#
+		# Unnamed struct in an unnamed union in an unnamed struct ...
+		#
+
+		nested = g.udt('<unnamed-tag>', [('Value', T_UQUAD, 0)], 8)
+
+		for level in range(depth):
+			kind = LF_UNION if level % 2 == 0 else LF_STRUCTURE
+
+			if kind == LF_UNION:
+				members = [('AsQuad%d' % level, T_UQUAD, 0), ('Nested%d' % level, nested, 0)]
+			else:
+				members = [('Nested%d' % level, nested, 0), ('Low%d' % level, T_ULONG, 8)]
+
+			nested = g.udt('<unnamed-tag>', members, 8 if kind == LF_UNION else 16, kind=kind)
+
+		g.udt('_NESTED%d' % i, [('Header', T_ULONG, 0), ('Body', nested, 8)], 24)
+
+	#
+	# Each struct embeds the next one (through its forward reference),
+	# the first one is the deepest for the sorter.
+	#
+
+	length = scaled(20000, scale)
+	forwards = [g.forward('_CHAIN%d' % i) for i in range(length)]
+
+	g.udt('_CHAIN%d' % (length - 1), [('Value', T_INT4, 0)], 4)
+
+	for i in reversed(range(length - 1)):
+		g.udt('_CHAIN%d' % i, [('Next', forwards[i + 1], 0)], 4)
+
+
+def build_massive_enums(g, rng, scale):
+	for i in range(20):
+		values = [('ENUM%d_VALUE%d' % (i, j), rng.randint(-(1 << 31), (1 << 31) - 1)) for j in range(scaled(50000, scale))]
+		g.enum('_ENUM%d' % i, values)
+
+
+def build_bitfield_unions(g, rng, scale):
+	base_types = [(T_UCHAR, 8), (T_USHORT, 16), (T_ULONG, 32), (T_UQUAD, 64)]
+
+	for i in range(scaled(5000, scale)):
+		base_type, base_bits = rng.choice(base_types)
+		base_size = base_bits // 8
+
+		members = []
+		size = base_size
+
+		#
+		# Bitfields directly in the union...
+		#
+
+		for j in range(4):
+			length = rng.randint(1, base_bits)
+			members.append(('Bits%d' % j, g.bitfield(base_type, length, rng.randint(0, base_bits - length)), 0))
+
+		#
+		# ... and in the unnamed structs of the union.
+		#
+
+		for j in range(4):
+			fields = []
+			position = 0
+			offset = 0
+
+			for k in range(8):
+				length = rng.randint(1, base_bits // 4)
+
+				if position + length > base_bits:
+					position = 0
+					offset += base_size
+
+				fields.append(('Field%d_%d' % (j, k), g.bitfield(base_type, length, position), offset))
+				position += length
+
+			members.append(('Parts%d' % j, g.udt('<unnamed-tag>', fields, offset + base_size), 0))
+			size = max(size, offset + base_size)
+
+		members.append(('Raw', g.array(T_UCHAR, size), 0))
+
+		g.udt('_BITFIELDS%d' % i, members, size, kind=LF_UNION)
+
+
+def build_fan_out(g, rng, scale):
+	#
+	# 4-ary tree, each node embeds its children and one
+	# of the shared leaves by value.
+	#
+
+	node_count = scaled(5000, scale)
+	fan_out = 4
+
+	leaves = []
+
+	for i in range(16):
+		members = [('Leaf%d_%d' % (i, j), T_ULONG, 4 * j) for j in range(4)]
+		leaves.append((g.udt('_LEAF%d' % i, members, 16), 16))
+
+	nodes = [None] * node_count
+
+	for i in reversed(range(node_count)):
+		members = [('Id', T_ULONG, 0)]
+		offset = 8
+
+		leaf, size = rng.choice(leaves)
+		members.append(('Leaf', leaf, offset))
+		offset += size
+
+		for child in range(fan_out * i + 1, min(fan_out * i + fan_out + 1, node_count)):
+			type_index, size = nodes[child]
+
+			members.append(('Child%d' % child, type_index, offset))
+			offset += size
+
+		nodes[i] = (g.udt('_NODE%d' % i, members, offset), offset)
+
+
+#
+# (name, builder)
+#
+
+PDBS = [
+	('small_types',     build_small_types),
+	('huge_structs',    build_huge_structs),
+	('deep_nesting',    build_deep_nesting),
+	('massive_enums',   build_massive_enums),
+	('bitfield_unions', build_bitfield_unions),
+	('fan_out',         build_fan_out),
+	]
+
+#
+# (name, PDB, symbol, thread count - None for the -w of the script)
+#
+
+FIXTURES = [
+	('small_types',     'small_types',     '*',       None),
+	('huge_structs',    'huge_structs',    '*',       None),
+	('deep_nesting',    'deep_nesting',    '*',       None),
+	('massive_enums',   'massive_enums',   '*',       None),
+	('bitfield_unions', 'bitfield_unions', '*',       None),
+	('fan_out',         'fan_out',         '%',       None),
+	('small_types_one', 'small_types',     '_SMALL0', None),
+	('small_types_w0',  'small_types',     '*',       0),
+	]
+
+
+def build_fixture(file_pdb, name, builder, scale):
+	seed = zlib.crc32(name.encode('utf-8'))
+
+	build_pdb(file_pdb, builder, random.Random(seed), scale, guid=uuid.UUID(int=seed))
+
+
+def get_phase_times(stats):
+	phases = stats['phases']
+
+	def add(*names):
+		return {
+			'wall': sum(phases[name]['wall_seconds'] for name in names),
+			'cpu':  sum(phases[name]['cpu_seconds'] for name in names),
+			}
+
+	return {
+		'load':   add('load'),
+		'sort':   add('naming', 'sort'),
+		'render': add('declarations', 'definitions', 'functions', 'files'),
+		'total':  add('total'),
+		}
+
+
+def measure_fixture(pdbex, file_pdb, symbol, output_path, thread_count, repeat_count):
+	command = [pdbex, symbol, file_pdb, '-o', output_path, '-w', str(thread_count), '--stats=json']
+
+	result = None
+
+	for _ in range(repeat_count):
+		#
+		# Files are always created anew, the creation costs more
+		# than the overwriting of the existing ones.
+		#
+
+		if os.path.isdir(output_path):
+			shutil.rmtree(output_path)
+		elif os.path.exists(output_path):
+			os.remove(output_path)
+
+		stats = run_pdbex_stats(command)
+		times = get_phase_times(stats)
+
+		if result is None:
+			result = {
+				'phases': times,
+				'peak_rss': stats['counters']['peak_rss'],
+				'written_bytes': stats['counters']['written_bytes'],
+				}
+			continue
+
+		for phase, time in times.items():
+			for clock in ('wall', 'cpu'):
+				result['phases'][phase][clock] = min(result['phases'][phase][clock], time[clock])
+
+		result['peak_rss'] = min(result['peak_rss'], stats['counters']['peak_rss'])
+
+	return result
+
+
+def print_results(results):
+	print('%-16s %-7s %10s %10s %10s %10s %10s' % ('fixture', 'clock', 'load', 'sort', 'render', 'total', 'peak RSS'))
+
+	for name, result in results['fixtures'].items():
+		for clock in ('wall', 'cpu'):
+			print('%-16s %-7s %8.3f s %8.3f s %8.3f s %8.3f s %7d MB' % (
+				name if clock == 'wall' else '',
+				clock,
+				result['phases']['load'][clock],
+				result['phases']['sort'][clock],
+				result['phases']['render'][clock],
+				result['phases']['total'][clock],
+				result['peak_rss'] // (1024 * 1024)
+				))
+
+
+def compare_results(baseline, results, threshold):
+	#
+	# Returns the number of regressions.  CPU time is compared,
+	# it's less affected by the load of the machine than the wall time.
+	#
+
+	for option in ('scale', 'threads'):
+		if baseline.get(option) != results[option]:
+			print('Warning: baseline was measured with %s %s, current with %s' % (option, baseline.get(option), results[option]))
+
+	print('')
+	print('%-16s %-7s %10s %10s %8s' % ('fixture', 'phase', 'baseline', 'current', 'change'))
+
+	regression_count = 0
+
+	for name, result in results['fixtures'].items():
+		if name not in baseline['fixtures']:
+			print('%-16s missing in the baseline' % name)
+			continue
+
+		for phase in MEASURED_PHASES:
+			expected = baseline['fixtures'][name]['phases'][phase]['cpu']
+			actual = result['phases'][phase]['cpu']
+
+			change = (actual - expected) / expected if expected > 0 else 0.0
+			is_regression = change > threshold and actual - expected > MIN_REGRESSION_TIME
+
+			if is_regression:
+				regression_count += 1
+
+			print('%-16s %-7s %8.3f s %8.3f s %+7.1f%%%s' % (
+				name,
+				phase,
+				expected,
+				actual,
+				change * 100,
+				'  REGRESSION' if is_regression else ''
+				))
+
+	return regression_count
+
+
+def main():
+	parser = create_parser()
+	parser.add_argument('-o', '--output', type=str, help='write the results (JSON) into the file')
+	parser.add_argument('-b', '--baseline', type=str, help='compare the results with the baseline (JSON written by -o)')
+	parser.add_argument('-t', '--threshold', type=float, default=DEFAULT_THRESHOLD, help='allowed slowdown against the baseline (0.1 = 10%%)')
+	parser.add_argument('-f', '--fixtures', type=str, nargs='+', choices=[f[0] for f in FIXTURES], help='measured fixtures (all by default)')
+	parser.add_argument('-s', '--scale', type=float, default=DEFAULT_SCALE, help='scale of the number of types in the fixtures')
+	parser.add_argument('-w', '--threads', type=int, default=DEFAULT_THREAD_COUNT, help='number of threads used by pdbex (-w)')
+	parser.add_argument('-r', '--repeat', type=int, default=DEFAULT_REPEAT_COUNT, help='number of runs of each fixture')
+	parser.add_argument('-k', '--keep', type=str, help='directory where the generated PDBs are kept')
+
+	args = parse_arguments(parser)
+	pdbex = args.pdbex
+
+	results = {
+		'pdbex': pdbex,
+		'scale': args.scale,
+		'threads': args.threads,
+		'repeat': args.repeat,
+		'fixtures': {},
+		}
+
+	with tempfile.TemporaryDirectory() as directory:
+		fixture_directory = args.keep or directory
+		os.makedirs(fixture_directory, exist_ok=True)
+
+		built_pdbs = set()
+
+		for name, pdb, symbol, thread_count in FIXTURES:
+			if args.fixtures and name not in args.fixtures:
+				continue
+
+			file_pdb = os.path.join(fixture_directory, pdb + '.pdb')
+
+			print('Measuring %s' % name)
+
+			if pdb not in built_pdbs:
+				build_fixture(file_pdb, pdb, dict(PDBS)[pdb], args.scale)
+				built_pdbs.add(pdb)
+
+			if thread_count is None:
+				thread_count = args.threads
+
+			output_path = os.path.join(directory, name + ('.h' if symbol != '%' else ''))
+			results['fixtures'][name] = measure_fixture(pdbex, file_pdb, symbol, output_path, thread_count, args.repeat)
+
+	print('')
+	print_results(results)
+
+	if args.output:
+		with open(args.output, 'w') as f:
+			json.dump(results, f, indent=2)
+			f.write('\n')
+
+	if args.baseline:
+		with open(args.baseline, 'r') as f:
+			baseline = json.load(f)
+
+		regression_count = compare_results(baseline, results, args.threshold)
+
+		if regression_count != 0:
+			print('Benchmark failed: %d regression(s)' % regression_count)
+			return 1
+
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -0,0 +1,446 @@
+import struct
+import uuid
+import zlib
+
+#
+# Writer of minimal PDB (MSF 7.00) files with synthetic type information.
+#
+# Produced files contain PDB info stream, TPI stream (with its hash stream),
+# DBI stream (machine type + public symbols) and an empty IPI stream.
+# It's enough for pdbex's native reader.
+#
+
+MSF_MAGIC = b'Microsoft C/C++ MSF 7.00\r\n\x1aDS\x00\x00\x00'
+MSF_BLOCK_SIZE = 4096
+
+TPI_HEADER_SIZE = 56
+TPI_VERSION_V80 = 20040203
+TPI_HASH_BUCKETS = 0x3ffff
+TPI_INDEX_OFFSET_INTERVAL = 8192
+
+DBI_VERSION_V70 = 19990903
+PDB_VERSION_VC70 = 20000404
+
+FIRST_TYPE_INDEX = 0x1000
+
+#
+# Simple types.
+#
+
+T_VOID     = 0x0003
+T_HRESULT  = 0x0008
+T_CHAR     = 0x0010
+T_SHORT    = 0x0011
+T_LONG     = 0x0012
+T_QUAD     = 0x0013
+T_UCHAR    = 0x0020
+T_USHORT   = 0x0021
+T_ULONG    = 0x0022
+T_UQUAD    = 0x0023
+T_BOOL08   = 0x0030
+T_REAL32   = 0x0040
+T_REAL64   = 0x0041
+T_WCHAR    = 0x0071
+T_INT4     = 0x0074
+T_UINT4    = 0x0075
+T_64PVOID  = 0x0603
+
+#
+# Leaf kinds.
+#
+
+LF_MODIFIER  = 0x1001
+LF_POINTER   = 0x1002
+LF_PROCEDURE = 0x1008
+LF_ARGLIST   = 0x1201
+LF_FIELDLIST = 0x1203
+LF_BITFIELD  = 0x1205
+LF_INDEX     = 0x1404
+LF_ENUMERATE = 0x1502
+LF_ARRAY     = 0x1503
+LF_CLASS     = 0x1504
+LF_STRUCTURE = 0x1505
+LF_UNION     = 0x1506
+LF_ENUM      = 0x1507
+LF_MEMBER    = 0x150d
+
+LF_CHAR      = 0x8000
+LF_SHORT     = 0x8001
+LF_USHORT    = 0x8002
+LF_LONG      = 0x8003
+LF_ULONG     = 0x8004
+LF_QUADWORD  = 0x8009
+LF_UQUADWORD = 0x800a
+
+CV_PROP_FWDREF        = 0x0080
+CV_PROP_SCOPED        = 0x0100
+CV_PROP_HASUNIQUENAME = 0x0200
+
+S_PUB32 = 0x110e
+
+#
+# Field list records are split when they grow over this size.
+#
+
+MAX_FIELD_LIST_SIZE = 0xff00
+
+
+def hash_string_v1(name):
+	data = name.encode('ascii')
+	result = 0
+
+	count = len(data) // 4
+	for value in struct.unpack_from('<%dI' % count, data):
+		result ^= value
+
+	remainder = data[count * 4:]
+
+	if len(remainder) >= 2:
+		result ^= struct.unpack_from('<H', remainder)[0]
+		remainder = remainder[2:]
+
+	if len(remainder) == 1:
+		result ^= remainder[0]
+
+	result |= 0x20202020
+	result ^= result >> 11
+
+	return (result ^ (result >> 16)) & 0xffffffff
+
+
+def encode_numeric(value):
+	if 0 <= value < 0x8000:
+		return struct.pack('<H', value)
+	if -0x80 <= value < 0x80:
+		return struct.pack('<Hb', LF_CHAR, value)
+	if -0x8000 <= value < 0x8000:
+		return struct.pack('<Hh', LF_SHORT, value)
+	if 0 <= value < 0x10000:
+		return struct.pack('<HH', LF_USHORT, value)
+	if -0x80000000 <= value < 0x80000000:
+		return struct.pack('<Hi', LF_LONG, value)
+	if 0 <= value < 0x100000000:
+		return struct.pack('<HI', LF_ULONG, value)
+	if value < 0:
+		return struct.pack('<Hq', LF_QUADWORD, value)
+	return struct.pack('<HQ', LF_UQUADWORD, value)
+
+
+def encode_name(name):
+	return name.encode('ascii') + b'\x00'
+
+
+def pad_member(data):
+	#
+	# Members of the field list are aligned to 4 bytes
+	# with LF_PAD* bytes.
+	#
+
+	padding = -len(data) % 4
+	return data + bytes(0xf0 | (padding - i) for i in range(padding))
+
+
+class TypeGraph:
+	def __init__(self):
+		self.records = []
+		self.hashes = []
+
+	def next_type_index(self):
+		return FIRST_TYPE_INDEX + len(self.records)
+
+	def add(self, kind, payload, hash_name=None):
+		data = struct.pack('<H', kind) + payload
+		data = pad_member(data)
+
+		type_index = self.next_type_index()
+
+		self.records.append(struct.pack('<H', len(data)) + data)
+		self.hashes.append(
+			hash_string_v1(hash_name) if hash_name is not None
+			else zlib.crc32(data)
+			)
+
+		return type_index
+
+	#
+	# Simple records.
+	#
+
+	def pointer(self, referent, size=8, is_reference=False, is_const=False):
+		mode = 1 if is_reference else 0
+		ptrtype = 0x0c if size == 8 else 0x0a
+		attributes = ptrtype | (mode << 5) | (size << 13)
+
+		if is_const:
+			attributes |= 0x400
+
+		return self.add(LF_POINTER, struct.pack('<II', referent, attributes))
+
+	def modifier(self, modified, is_const=True, is_volatile=False):
+		modifiers = (1 if is_const else 0) | (2 if is_volatile else 0)
+		return self.add(LF_MODIFIER, struct.pack('<IH', modified, modifiers))
+
+	def array(self, element, size, index=T_UQUAD):
+		return self.add(LF_ARRAY, struct.pack('<II', element, index) + encode_numeric(size) + encode_name(''))
+
+	def bitfield(self, base, length, position):
+		return self.add(LF_BITFIELD, struct.pack('<IBB', base, length, position))
+
+	def procedure(self, return_type, arguments):
+		arglist = self.add(LF_ARGLIST, struct.pack('<I', len(arguments)) + struct.pack('<%dI' % len(arguments), *arguments))
+		return self.add(LF_PROCEDURE, struct.pack('<IBBHI', return_type, 0, 0, len(arguments), arglist))
+
+	#
+	# Field lists.
+	#
+
+	def field_list(self, members):
+		#
+		# Long field lists are split into more records
+		# chained by LF_INDEX (which points to the continuation).
+		#
+
+		chunks = [[]]
+		chunk_size = 0
+
+		for member in members:
+			if chunk_size + len(member) > MAX_FIELD_LIST_SIZE:
+				chunks.append([])
+				chunk_size = 0
+
+			chunks[-1].append(member)
+			chunk_size += len(member)
+
+		continuation = None
+
+		for chunk in reversed(chunks):
+			payload = b''.join(chunk)
+
+			if continuation is not None:
+				payload += struct.pack('<HHI', LF_INDEX, 0, continuation)
+
+			continuation = self.add(LF_FIELDLIST, payload)
+
+		return continuation
+
+	@staticmethod
+	def member(name, type_index, offset):
+		return pad_member(struct.pack('<HHI', LF_MEMBER, 3, type_index) + encode_numeric(offset) + encode_name(name))
+
+	@staticmethod
+	def enumerator(name, value):
+		return pad_member(struct.pack('<HH', LF_ENUMERATE, 3) + encode_numeric(value) + encode_name(name))
+
+	#
+	# Tag records.
+	#
+
+	def forward(self, name, kind=LF_STRUCTURE):
+		if kind == LF_ENUM:
+			return self.add(LF_ENUM, struct.pack('<HHII', 0, CV_PROP_FWDREF, 0, 0) + encode_name(name))
+
+		if kind == LF_UNION:
+			return self.add(LF_UNION, struct.pack('<HHI', 0, CV_PROP_FWDREF, 0) + encode_numeric(0) + encode_name(name))
+
+		return self.add(kind, struct.pack('<HHIII', 0, CV_PROP_FWDREF, 0, 0, 0) + encode_numeric(0) + encode_name(name))
+
+	def udt(self, name, members, size, kind=LF_STRUCTURE):
+		field_list = self.field_list([self.member(*m) for m in members])
+
+		if kind == LF_UNION:
+			payload = struct.pack("<HHI", min(len(members), 0xffff), 0, field_list)
+		else:
+			payload = struct.pack("<HHIII", min(len(members), 0xffff), 0, field_list, 0, 0)
+
+		return self.add(kind, payload + encode_numeric(size) + encode_name(name), hash_name=name)
+
+	def enum(self, name, values, underlying=T_INT4):
+		field_list = self.field_list([self.enumerator(*v) for v in values])
+		payload = struct.pack('<HHII', len(values), 0, underlying, field_list)
+
+		return self.add(LF_ENUM, payload + encode_name(name), hash_name=name)
+
+
+class MSFWriter:
+	def __init__(self):
+		self.streams = []
+
+	def add_stream(self, data):
+		self.streams.append(bytes(data))
+		return len(self.streams) - 1
+
+	def write(self, path):
+		#
+		# Block 0 is the super block, blocks 1 and 2 are the free block maps.
+		#
+
+		blocks = [b'', b'', b'']
+
+		def allocate(data):
+			result = []
+
+			for offset in range(0, len(data), MSF_BLOCK_SIZE):
+				result.append(len(blocks))
+				blocks.append(data[offset:offset + MSF_BLOCK_SIZE])
+
+			return result
+
+		stream_blocks = [allocate(data) for data in self.streams]
+
+		directory = struct.pack('<I', len(self.streams))
+		directory += b''.join(struct.pack('<I', len(data)) for data in self.streams)
+
+		for block_list in stream_blocks:
+			directory += b''.join(struct.pack('<I', block) for block in block_list)
+
+		directory_blocks = allocate(directory)
+		block_map = struct.pack('<%dI' % len(directory_blocks), *directory_blocks)
+		block_map_address = allocate(block_map)[0]
+
+		#
+		# All blocks are in use.
+		#
+
+		block_count = len(blocks)
+		blocks[1] = b'\x00' * ((block_count + 7) // 8)
+		blocks[0] = MSF_MAGIC + struct.pack(
+			'<IIIIII',
+			MSF_BLOCK_SIZE,
+			1,
+			block_count,
+			len(directory),
+			0,
+			block_map_address
+			)
+
+		with open(path, 'wb') as f:
+			for block in blocks:
+				f.write(block.ljust(MSF_BLOCK_SIZE, b'\x00'))
+
+
+def build_pdb_info_stream(guid, age):
+	data = struct.pack('<III', PDB_VERSION_VC70, 0, age) + guid.bytes_le
+
+	#
+	# Empty named stream map.
+	#
+
+	data += struct.pack('<I', 0)
+	data += struct.pack('<II', 0, 1)
+	data += struct.pack('<II', 1, 0)
+	data += struct.pack('<I', 0)
+	data += struct.pack('<I', 0)
+
+	return data
+
+
+def build_tpi_streams(graph, hash_stream_index):
+	records = bytearray()
+	index_offsets = bytearray()
+	next_index_offset = 0
+
+	for i, record in enumerate(graph.records):
+		if len(records) >= next_index_offset:
+			index_offsets += struct.pack('<II', FIRST_TYPE_INDEX + i, len(records))
+			next_index_offset = len(records) + TPI_INDEX_OFFSET_INTERVAL
+
+		records += record
+
+	hash_values = b''.join(struct.pack('<I', h % TPI_HASH_BUCKETS) for h in graph.hashes)
+	hash_stream = hash_values + bytes(index_offsets)
+
+	header = struct.pack(
+		'<IIIIIHHIIiIiIiI',
+		TPI_VERSION_V80,
+		TPI_HEADER_SIZE,
+		FIRST_TYPE_INDEX,
+		FIRST_TYPE_INDEX + len(graph.records),
+		len(records),
+		hash_stream_index,
+		0xffff,
+		4,
+		TPI_HASH_BUCKETS,
+		0,
+		len(hash_values),
+		len(hash_values),
+		len(index_offsets),
+		len(hash_stream),
+		0
+		)
+
+	return header + bytes(records), hash_stream
+
+
+def build_empty_tpi_stream():
+	return struct.pack(
+		'<IIIIIHHIIiIiIiI',
+		TPI_VERSION_V80, TPI_HEADER_SIZE, FIRST_TYPE_INDEX, FIRST_TYPE_INDEX, 0,
+		0xffff, 0xffff, 4, TPI_HASH_BUCKETS, 0, 0, 0, 0, 0, 0
+		)
+
+
+def build_dbi_stream(age, machine, symbol_record_stream_index):
+	#
+	# Substreams are empty, except for those which
+	# other PDB readers (LLVM) insist on.
+	#
+
+	source_info = struct.pack('<HH', 0, 0)
+	optional_debug_header = b'\xff' * 22
+	ec_names = struct.pack('<IIIBII', 0xeffeeffe, 1, 1, 0, 1, 0) + struct.pack('<I', 0)
+
+	header = struct.pack(
+		'<iIIHHHHHHiiiiiIiiHHI',
+		-1,
+		DBI_VERSION_V70,
+		age,
+		0xffff,
+		0,
+		0xffff,
+		0,
+		symbol_record_stream_index,
+		0,
+		0,
+		0,
+		0,
+		len(source_info),
+		0,
+		0,
+		len(optional_debug_header),
+		len(ec_names),
+		0,
+		machine,
+		0
+		)
+
+	return header + source_info + ec_names + optional_debug_header
+
+
+def build_symbol_record_stream(functions):
+	data = b''
+
+	for name in functions:
+		record = struct.pack('<HIIH', S_PUB32, 2, 0, 1) + encode_name(name)
+		record += b'\x00' * (-(len(record) + 2) % 4)
+		data += struct.pack('<H', len(record)) + record
+
+	return data
+
+
+def write_pdb(path, graph, guid=None, age=1, machine=0x8664, functions=()):
+	guid = guid or uuid.UUID(int=zlib.crc32(path.encode('utf-8')))
+
+	msf = MSFWriter()
+	msf.add_stream(b'')                                     # 0: old directory
+	msf.add_stream(build_pdb_info_stream(guid, age))        # 1: PDB info
+	msf.add_stream(b'')                                     # 2: TPI
+	msf.add_stream(build_dbi_stream(age, machine, 6))       # 3: DBI
+	msf.add_stream(build_empty_tpi_stream())                # 4: IPI
+	msf.add_stream(b'')                                     # 5: TPI hash
+	msf.add_stream(build_symbol_record_stream(functions))   # 6: symbol records
+
+	tpi_stream, tpi_hash_stream = build_tpi_streams(graph, 5)
+	msf.streams[2] = tpi_stream
+	msf.streams[5] = tpi_hash_stream
+
+	msf.write(path)
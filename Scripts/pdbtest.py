@@ -0,0 +1,87 @@
+import argparse
+import json
+import os
+import subprocess
+
+from pdbgen import TypeGraph, write_pdb
+
+#
+# Helpers shared by the tests and the benchmarks of pdbex.
+#
+# A script creates its parser by create_parser() (the pdbex executable
+# and -v are common to all of them), adds its own arguments and parses
+# them by parse_arguments().  Generated PDBs are built by build_pdb()
+# from a function filling the type graph, pdbex is run by run_pdbex().
+#
+
+VERBOSITY_LEVEL = 0 # 0, 1
+
+
+def create_parser(pdbex_help='pdbex executable'):
+	parser = argparse.ArgumentParser()
+	parser.add_argument('pdbex', type=str, help=pdbex_help)
+	parser.add_argument('-v', '--verbose', action='store_true', help='increase output verbosity')
+
+	return parser
+
+
+def parse_arguments(parser):
+	args = parser.parse_args()
+
+	global VERBOSITY_LEVEL
+
+	if args.verbose:
+		VERBOSITY_LEVEL = 1
+
+	args.pdbex = os.path.abspath(args.pdbex)
+
+	return args
+
+
+def build_pdb(file_pdb, builder, *args, guid=None):
+	#
+	# builder(g, *args) adds the types into the graph g.
+	#
+
+	g = TypeGraph()
+	builder(g, *args)
+
+	write_pdb(file_pdb, g, guid=guid)
+
+
+def print_command(command):
+	if VERBOSITY_LEVEL >= 1:
+		print('    ' + ' '.join(command))
+
+
+def run_pdbex(command, check_stderr=None):
+	#
+	# Returns the stderr of pdbex, check_stderr(stderr) is called
+	# before its exit code is checked.
+	#
+
+	print_command(command)
+
+	result = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, universal_newlines=True)
+
+	if check_stderr is not None:
+		check_stderr(result.stderr)
+
+	if result.returncode != 0:
+		raise Exception('pdbex failed (%d):\n%s' % (result.returncode, result.stderr))
+
+	return result.stderr
+
+
+def run_pdbex_stats(command):
+	#
+	# Returns the statistics of the run, command has to contain
+	# --stats=json.  Statistics are the last thing printed to stderr.
+	#
+
+	stderr = run_pdbex(command)
+
+	if '{' not in stderr:
+		raise Exception('pdbex did not print the statistics:\n' + stderr)
+
+	return json.loads(stderr[stderr.index('{'):])
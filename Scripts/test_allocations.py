@@ -0,0 +1,120 @@
+import os
+import re
+import sys
+import tempfile
+
+from pdbgen import *
+from pdbtest import *
+
+#
+# Checks that printing of the UDT members doesn't allocate.
+#
+# pdbex has to be built with the counting of the allocations:
+#
+#   cmake -S . -B Build -DPDBEX_COUNT_ALLOCATIONS=ON
+#   cmake --build Build
+#   python3 Scripts/test_allocations.py Build/pdbex
+#
+# The same struct is printed with a small and with a big number
+# of members.  Allocations which don't depend on the number of members
+# (names of the types, layouts of the UDTs, growth of the buffers, ...)
+# are the same for both, so the difference has to stay (almost) zero.
+#
+
+SMALL_FIELD_COUNT = 1000
+BIG_FIELD_COUNT   = 16000
+
+#
+# Allowed difference - the buffers (UDT layout, output, ...)
+# grow logarithmically with the number of members.
+#
+
+MAX_ALLOCATION_DIFFERENCE = 64
+
+ALLOCATIONS_RE = re.compile(r'Allocations while printing definitions: (\d+)')
+
+
+def build_types(g, field_count):
+	item = g.udt('_ITEM', [('Value', T_INT4, 0)], 4)
+	unnamed = g.udt('<unnamed-tag>', [('AsLong', T_ULONG, 0), ('AsShort', T_USHORT, 0)], 4, kind=LF_UNION)
+
+	#
+	# Member types: (type index, size).
+	#
+
+	member_types = [
+		(T_INT4, 4),
+		(g.modifier(T_INT4, is_const=True), 4),
+		(g.modifier(T_UQUAD, is_const=False, is_volatile=True), 8),
+		(g.pointer(T_INT4), 8),
+		(g.pointer(g.pointer(T_UCHAR), is_const=True), 8),
+		(g.pointer(item), 8),
+		(g.pointer(g.procedure(T_VOID, [T_INT4, T_64PVOID])), 8),
+		(g.array(T_UCHAR, 16), 16),
+		(g.array(g.array(T_USHORT, 8), 4 * 16), 64),
+		(g.array(T_REAL64, 0), 8),
+		(item, 4),
+		(unnamed, 4),
+		]
+
+	bitfields = [g.bitfield(T_UINT4, 3, 0), g.bitfield(T_UINT4, 5, 3), g.bitfield(T_UINT4, 7, 12)]
+
+	members = []
+	offset = 0
+
+	while len(members) < field_count:
+		for type_index, size in member_types:
+			members.append(('Member%d' % len(members), type_index, offset))
+			offset += size
+
+		for type_index in bitfields:
+			members.append(('BitField%d' % len(members), type_index, offset))
+
+		offset += 4
+
+	g.udt('_TEST', members, offset)
+
+
+def count_allocations(pdbex, file_pdb, file_h):
+	stderr = run_pdbex([pdbex, '*', file_pdb, '-o', file_h])
+
+	match = ALLOCATIONS_RE.search(stderr)
+
+	if match is None:
+		raise Exception('pdbex does not count allocations (build it with -DPDBEX_COUNT_ALLOCATIONS=ON)')
+
+	return int(match.group(1))
+
+
+def main():
+	parser = create_parser('pdbex built with -DPDBEX_COUNT_ALLOCATIONS=ON')
+	args = parse_arguments(parser)
+
+	with tempfile.TemporaryDirectory() as directory:
+		allocations = {}
+
+		for field_count in (SMALL_FIELD_COUNT, BIG_FIELD_COUNT):
+			file_pdb = os.path.join(directory, 'fields%d.pdb' % field_count)
+			file_h   = os.path.join(directory, 'fields%d.h' % field_count)
+
+			build_pdb(file_pdb, build_types, field_count)
+			allocations[field_count] = count_allocations(args.pdbex, file_pdb, file_h)
+
+			print('%6d members: %d allocations' % (field_count, allocations[field_count]))
+
+	difference = allocations[BIG_FIELD_COUNT] - allocations[SMALL_FIELD_COUNT]
+
+	if difference > MAX_ALLOCATION_DIFFERENCE:
+		print('Test failed: %d more allocations for %d more members' % (
+			difference,
+			BIG_FIELD_COUNT - SMALL_FIELD_COUNT
+			))
+
+		return 1
+
+	print('Test passed')
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
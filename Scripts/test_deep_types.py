@@ -0,0 +1,90 @@
+import os
+import re
+import sys
+import tempfile
+
+from pdbgen import *
+from pdbtest import *
+
+#
+# Checks that very deep type graphs don't crash pdbex.
+#
+#   python3 Scripts/test_deep_types.py Build/pdbex
+#
+# The generated PDB contains:
+#   - a chain of structs, each of them embeds the next one by value
+#     (through its forward reference, so that the first struct
+#     is the deepest one for both the loading and the sorting),
+#   - a chain of const modifiers of the same depth.
+#
+# All types are printed ('*') and then the first struct alone
+# (which pulls in the whole chain), with the serial and the parallel
+# loading.  The structs have to be defined from the innermost one.
+#
+# Only the native reader (-a n) decodes the types without the recursion,
+# the DIA reader still recurses through them.
+#
+
+DEFAULT_DEPTH = 1000000
+
+DEFINITION_RE = re.compile(r'^typedef struct (_LEVEL\d+)$', re.MULTILINE)
+
+
+def build_types(g, depth):
+	forwards = [g.forward('_LEVEL%d' % i) for i in range(depth)]
+
+	modified = T_INT4
+
+	for _ in range(depth):
+		modified = g.modifier(modified, is_const=True)
+
+	g.udt('_LEVEL%d' % (depth - 1), [('Value', modified, 0)], 4)
+
+	for i in reversed(range(depth - 1)):
+		g.udt('_LEVEL%d' % i, [('Next', forwards[i + 1], 0)], 4)
+
+
+def check_header(file_h, depth):
+	with open(file_h, 'r') as f:
+		header = f.read()
+
+	names = DEFINITION_RE.findall(header)
+	expected = ['_LEVEL%d' % i for i in reversed(range(depth))]
+
+	if names != expected:
+		raise Exception('%s: %d structs defined, expected %d in the order of the nesting' % (
+			file_h,
+			len(names),
+			depth
+			))
+
+	if 'const int Value;' not in header:
+		raise Exception('%s: member of the modified type not found' % file_h)
+
+
+def main():
+	parser = create_parser()
+	parser.add_argument('-d', '--depth', type=int, default=DEFAULT_DEPTH, help='depth of the generated chains')
+
+	args = parse_arguments(parser)
+
+	with tempfile.TemporaryDirectory() as directory:
+		file_pdb = os.path.join(directory, 'deep.pdb')
+		file_h   = os.path.join(directory, 'deep.h')
+
+		print('Generating chains of depth %d' % args.depth)
+		build_pdb(file_pdb, build_types, args.depth)
+
+		for symbol in ('*', '_LEVEL0'):
+			for thread_count in (1, 4):
+				print('Testing \'%s\' with %d thread(s)' % (symbol, thread_count))
+
+				run_pdbex([args.pdbex, symbol, file_pdb, '-a', 'n', '-w', str(thread_count), '-o', file_h])
+				check_header(file_h, args.depth)
+
+	print('Test passed')
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -0,0 +1,211 @@
+import filecmp
+import os
+import sys
+import tempfile
+
+from pdbgen import *
+from pdbtest import *
+
+#
+# Checks that extractions running in parallel in one process
+# (batch mode) don't share any state.
+#
+# Each job is run separately first, then all of them (repeated a few
+# times) in one batch.  Outputs of the batch have to be the same
+# as the separate ones.  The test is meant for pdbex built with
+# the ThreadSanitizer, any report of it fails the test:
+#
+#   cmake -S . -B Build -DCMAKE_BUILD_TYPE=RelWithDebInfo -DCMAKE_CXX_FLAGS=-fsanitize=thread
+#   cmake --build Build
+#   python3 Scripts/test_parallel_extractions.py Build/pdbex
+#
+# The generated PDBs contain nested unnamed types, bitfields and enums,
+# so that the naming of the unnamed types and the numbering of the padding
+# members and anonymous data types is exercised as well.
+#
+
+DEFAULT_PDB_COUNT    = 3
+DEFAULT_REPEAT_COUNT = 4
+DEFAULT_JOB_COUNT    = 8
+
+#
+# Options of the jobs, '%' writes one file per symbol.  Some jobs
+# use multiple threads, to mix in the pools of the jobs.
+#
+
+JOB_OPTIONS = [
+	('*', []),
+	('*', ['-w', '2']),
+	('*', ['-e', 'a']),
+	('*', ['-e', 'n', '-y']),
+	('*', ['-d-', '-p-', '-i']),
+	('_STRUCT0', []),
+	('%', ['-w', '2']),
+	]
+
+SANITIZER_REPORTS = ('WARNING: ThreadSanitizer', 'ERROR: AddressSanitizer')
+
+
+def build_types(g, seed):
+	basic_types = [(T_CHAR, 1), (T_USHORT, 2), (T_INT4, 4), (T_UQUAD, 8)]
+
+	kind = g.enum('_KIND%d' % seed, [('Kind%d_%d' % (seed, i), i) for i in range(4)])
+
+	unnamed_struct = g.udt('<unnamed-tag>', [('Low', T_ULONG, 0), ('High', T_ULONG, 4)], 8)
+	unnamed = g.udt('<unnamed-tag>', [('AsQuad', T_UQUAD, 0), ('AsParts', unnamed_struct, 0)], 8, kind=LF_UNION)
+
+	bitfields = [g.bitfield(T_ULONG, 3, 0), g.bitfield(T_ULONG, 5, 3)]
+
+	udts = []
+
+	for i in range(16 + seed):
+		members = []
+		offset = 0
+
+		for j in range(4 + (i + seed) % 5):
+			type_index, size = basic_types[(i + j) % len(basic_types)]
+
+			offset = (offset + size - 1) // size * size
+			members.append(('Member%d' % j, type_index, offset))
+			offset += size
+
+		offset = (offset + 7) // 8 * 8
+		members.append(('Unnamed', unnamed, offset))
+		offset += 8
+
+		for type_index in bitfields:
+			members.append(('BitField%d' % len(members), type_index, offset))
+
+		offset += 4
+
+		members.append(('Kind', kind, offset))
+		offset += 4
+
+		if udts:
+			type_index, size = udts[(i * 7) % len(udts)]
+
+			members.append(('Embedded', type_index, offset))
+			offset += size
+
+			members.append(('Pointer', g.pointer(udts[-1][0]), (offset + 7) // 8 * 8))
+			offset = (offset + 7) // 8 * 8 + 8
+
+		#
+		# Trailing padding.
+		#
+
+		offset += 4
+
+		name = '_STRUCT%d' % i
+		g.forward(name)
+		udts.append((g.udt(name, members, offset), offset))
+
+
+def get_output_path(directory, pdb_index, option_index, repeat_index):
+	return os.path.join(directory, 'out%d_%d_%d' % (pdb_index, option_index, repeat_index))
+
+
+def get_job_arguments(file_pdb, option_index, output_path):
+	symbol, options = JOB_OPTIONS[option_index]
+	return [symbol, file_pdb, '-o', output_path] + options
+
+
+def compare_outputs(expected, actual):
+	if os.path.isdir(expected):
+		comparison = filecmp.dircmp(expected, actual)
+
+		return not comparison.left_only and \
+		       not comparison.right_only and \
+		       not filecmp.cmpfiles(expected, actual, comparison.common_files, shallow=False)[1]
+
+	return filecmp.cmp(expected, actual, shallow=False)
+
+
+def check_sanitizer_reports(output):
+	for report in SANITIZER_REPORTS:
+		if report in output:
+			raise Exception('sanitizer report:\n' + output)
+
+
+def main():
+	parser = create_parser('pdbex executable (preferably built with -fsanitize=thread)')
+	parser.add_argument('-p', '--pdbs', type=int, default=DEFAULT_PDB_COUNT, help='number of generated PDBs')
+	parser.add_argument('-r', '--repeat', type=int, default=DEFAULT_REPEAT_COUNT, help='number of repetitions of each job in the batch')
+	parser.add_argument('-j', '--jobs', type=int, default=DEFAULT_JOB_COUNT, help='number of jobs running in parallel')
+
+	args = parse_arguments(parser)
+	pdbex = args.pdbex
+
+	with tempfile.TemporaryDirectory() as directory:
+		file_pdbs = []
+
+		for pdb_index in range(args.pdbs):
+			file_pdb = os.path.join(directory, 'test%d.pdb' % pdb_index)
+			build_pdb(file_pdb, build_types, pdb_index)
+			file_pdbs.append(file_pdb)
+
+		#
+		# Separate runs.
+		#
+
+		expected_directory = os.path.join(directory, 'expected')
+		os.mkdir(expected_directory)
+
+		for pdb_index, file_pdb in enumerate(file_pdbs):
+			for option_index in range(len(JOB_OPTIONS)):
+				output_path = get_output_path(expected_directory, pdb_index, option_index, 0)
+				command = [pdbex] + get_job_arguments(file_pdb, option_index, output_path) + ['-w', '1']
+
+				run_pdbex(command, check_sanitizer_reports)
+
+		#
+		# All jobs in one batch.
+		#
+
+		actual_directory = os.path.join(directory, 'actual')
+		os.mkdir(actual_directory)
+
+		file_manifest = os.path.join(directory, 'manifest.txt')
+
+		with open(file_manifest, 'w') as manifest:
+			for repeat_index in range(args.repeat):
+				for pdb_index, file_pdb in enumerate(file_pdbs):
+					for option_index in range(len(JOB_OPTIONS)):
+						output_path = get_output_path(actual_directory, pdb_index, option_index, repeat_index)
+						arguments = get_job_arguments(file_pdb, option_index, output_path)
+
+						manifest.write(' '.join('"%s"' % argument for argument in arguments) + '\n')
+
+		command = [pdbex, '--batch', file_manifest, '--jobs', str(args.jobs)]
+
+		print('Running %d jobs, %d in parallel' % (args.repeat * len(file_pdbs) * len(JOB_OPTIONS), args.jobs))
+
+		run_pdbex(command, check_sanitizer_reports)
+
+		#
+		# Comparison.
+		#
+
+		mismatch_count = 0
+
+		for repeat_index in range(args.repeat):
+			for pdb_index in range(len(file_pdbs)):
+				for option_index in range(len(JOB_OPTIONS)):
+					expected = get_output_path(expected_directory, pdb_index, option_index, 0)
+					actual = get_output_path(actual_directory, pdb_index, option_index, repeat_index)
+
+					if not compare_outputs(expected, actual):
+						symbol, options = JOB_OPTIONS[option_index]
+						print('Mismatch: %s %s %s' % (symbol, os.path.basename(file_pdbs[pdb_index]), ' '.join(options)))
+						mismatch_count += 1
+
+	if mismatch_count != 0:
+		print('Test failed: %d outputs differ' % mismatch_count)
+		return 1
+
+	print('Test passed')
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -0,0 +1,174 @@
+import os
+import re
+import sys
+import tempfile
+
+from pdbgen import *
+from pdbtest import *
+
+#
+# Checks that a single symbol is printed without decoding the whole PDB.
+#
+#   python3 Scripts/test_single_symbol.py Build/pdbex
+#
+# The generated PDB contains many structs, each of them points to itself
+# (through its forward reference, like a node of a list).  Some of them
+# (the last one among them) embed two structurally identical unnamed
+# unions.  The last struct is printed alone and all structs are printed
+# ('*'), pdbex reports the decoded symbols and the time of its phases
+# (--stats=json):
+#   - the single symbol has to decode only a few symbols (besides
+#     the unnamed ones, which are all named) and take a fraction
+#     of the time of the loading of '*',
+#   - the unnamed unions of the single symbol have to be told apart
+#     and named the same as in '*' (and expanded with -e a).
+#
+
+DEFAULT_STRUCT_COUNT = 100000
+DEFAULT_REPEAT_COUNT = 3
+
+#
+# Every n-th struct embeds the unnamed unions.
+#
+
+UNION_STRIDE = 1000
+UNION_COUNT = 2
+
+#
+# Symbol and its types, pointed types are decoded only by their names.
+# Unnamed symbols (and their types) are decoded on top of that.
+#
+
+MAX_DECODED_SYMBOLS = 16
+
+MAX_TIME_RATIO = 0.25
+
+MEMBER_RE = re.compile(r'union (_TAG_UNNAMED_\w+) (Union\d);')
+
+
+def has_unions(index, struct_count):
+	return (struct_count - 1 - index) % UNION_STRIDE == 0
+
+
+def get_union_count(struct_count):
+	return len([i for i in range(struct_count) if has_unions(i, struct_count)]) * UNION_COUNT
+
+
+def build_types(g, struct_count):
+	for i in range(struct_count):
+		members = [
+			('Id', T_ULONG, 0),
+			('Next', g.pointer(g.forward('_ITEM%d' % i)), 8),
+			]
+
+		if has_unions(i, struct_count):
+			for j in range(UNION_COUNT):
+				union = g.udt('<unnamed-tag>', [('AsQuad', T_UQUAD, 0), ('AsLong', T_ULONG, 0)], 8, kind=LF_UNION)
+				members.append(('Union%d' % j, union, 16 + 8 * j))
+
+		g.udt('_ITEM%d' % i, members, 16 + 8 * UNION_COUNT)
+
+
+def measure(pdbex, symbol, file_pdb, file_h, repeat_count):
+	#
+	# Returns the stats of the run with the lowest CPU time.
+	#
+
+	best = None
+
+	for _ in range(repeat_count):
+		stats = run_pdbex_stats([pdbex, symbol, file_pdb, '-o', file_h, '--stats=json'])
+
+		if best is None or stats['phases']['total']['cpu_seconds'] < best['phases']['total']['cpu_seconds']:
+			best = stats
+
+	return best
+
+
+def get_union_names(pdbex, symbol, file_pdb, file_h, struct_name):
+	run_pdbex([pdbex, symbol, file_pdb, '-e', 'n', '-o', file_h])
+
+	with open(file_h, 'r') as f:
+		header = f.read()
+
+	body = re.search(r'struct %s\n\{(.*?)\n\}' % struct_name, header, re.DOTALL)
+
+	if body is None:
+		raise Exception('%s: struct %s not found' % (file_h, struct_name))
+
+	return [name for name, member in sorted(MEMBER_RE.findall(body.group(1)), key=lambda member: member[1])]
+
+
+def check_names(pdbex, symbol, file_pdb, file_h):
+	names = get_union_names(pdbex, symbol, file_pdb, file_h, symbol)
+
+	if len(names) != UNION_COUNT or len(set(names)) != UNION_COUNT:
+		raise Exception('%s: unnamed unions named %s, expected %d distinct names' % (file_h, names, UNION_COUNT))
+
+	all_names = get_union_names(pdbex, '*', file_pdb, file_h, symbol)
+
+	if names != all_names:
+		raise Exception('%s: unnamed unions named %s, but %s when all symbols are printed' % (file_h, names, all_names))
+
+	run_pdbex([pdbex, symbol, file_pdb, '-e', 'a', '-o', file_h])
+
+	with open(file_h, 'r') as f:
+		header = f.read()
+
+	if '_TAG_UNNAMED_' in header or header.count('AsQuad;') != UNION_COUNT:
+		raise Exception('%s: all unnamed unions have to be expanded with -e a' % file_h)
+
+
+def main():
+	parser = create_parser()
+	parser.add_argument('-c', '--count', type=int, default=DEFAULT_STRUCT_COUNT, help='number of the generated structs')
+	parser.add_argument('-r', '--repeat', type=int, default=DEFAULT_REPEAT_COUNT, help='number of runs of each extraction')
+
+	args = parse_arguments(parser)
+	pdbex = args.pdbex
+	symbol = '_ITEM%d' % (args.count - 1)
+
+	with tempfile.TemporaryDirectory() as directory:
+		file_pdb = os.path.join(directory, 'single.pdb')
+		file_h   = os.path.join(directory, 'single.h')
+
+		print('Generating %d structs' % args.count)
+		build_pdb(file_pdb, build_types, args.count)
+
+		print('Testing \'%s\'' % symbol)
+		single = measure(pdbex, symbol, file_pdb, file_h, args.repeat)
+
+		print('Testing \'*\'')
+		full = measure(pdbex, '*', file_pdb, file_h, args.repeat)
+
+		single_time = single['phases']['total']['cpu_seconds']
+		load_time = full['phases']['load']['cpu_seconds']
+
+		print('  \'%s\': %d symbols, %.3f s' % (symbol, single['counters']['symbols'], single_time))
+		print('  \'*\': %d symbols, %.3f s of loading' % (full['counters']['symbols'], load_time))
+
+		max_symbols = MAX_DECODED_SYMBOLS + get_union_count(args.count)
+
+		if single['counters']['symbols'] > max_symbols:
+			raise Exception('\'%s\' decoded %d symbols, expected at most %d' % (
+				symbol,
+				single['counters']['symbols'],
+				max_symbols
+				))
+
+		if single_time > load_time * MAX_TIME_RATIO:
+			raise Exception('\'%s\' took %.3f s, expected at most %d%% of the loading of \'*\' (%.3f s)' % (
+				symbol,
+				single_time,
+				MAX_TIME_RATIO * 100,
+				load_time
+				))
+
+		check_names(pdbex, symbol, file_pdb, file_h)
+
+	print('Test passed')
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -0,0 +1,148 @@
+import os
+import re
+import sys
+import tempfile
+
+from pdbgen import *
+from pdbtest import *
+
+#
+# Checks that the names of the unnamed types are stable.
+#
+#   python3 Scripts/test_unnamed_names.py Build/pdbex
+#
+# Each generated struct has members of unnamed types (union, struct
+# nested in it, enum and a pointer to the union).  Names of these types
+# (printed as separate definitions, -e n) have to be:
+#   - the same in '*', '%' (with the serial and the parallel writing
+#     of the files) and in the output of the single struct,
+#   - the same when unrelated types (named and unnamed) are added
+#     to the PDB before them,
+#   - defined, if they're referenced.
+#
+
+DEFAULT_UDT_COUNT = 8
+
+MEMBER_RE = re.compile(r'(?:struct|union|enum) _(TAG_UNNAMED_\w+)\W+(\w+);')
+DEFINITION_RE = re.compile(r'^typedef (?:struct|union|enum) (\w+)$', re.MULTILINE)
+UNNAMED_DEFINITION_RE = re.compile(r'^} (TAG_UNNAMED_\w+),', re.MULTILINE)
+
+
+def build_unnamed_types(g, tag):
+	values = g.enum('<unnamed-enum-%s>' % tag, [('%s_First' % tag, 0), ('%s_Second' % tag, 1)])
+	inner = g.udt('<unnamed-tag>', [('%sLow' % tag, T_ULONG, 0), ('%sHigh' % tag, T_ULONG, 4)], 8)
+	union = g.udt('<unnamed-tag>', [('%sQuad' % tag, T_UQUAD, 0), ('%sParts' % tag, inner, 0)], 8, kind=LF_UNION)
+
+	return values, union
+
+
+def build_types(g, udt_count, unrelated):
+	if unrelated:
+		for i in range(udt_count):
+			values, union = build_unnamed_types(g, 'Unrelated%d' % i)
+			g.udt('_UNRELATED%d' % i, [('Union', union, 0), ('Values', values, 8)], 12)
+
+	for i in range(udt_count):
+		values, union = build_unnamed_types(g, 'Struct%d' % i)
+
+		members = [
+			('Union', union, 0),
+			('Values', values, 8),
+			('Pointer', g.pointer(union), 16),
+			]
+
+		g.udt('_STRUCT%d' % i, members, 24)
+
+
+def read_names(file_h):
+	#
+	# Returns {(struct, member): name of the unnamed type}
+	# and the set of the defined unnamed types.
+	#
+
+	with open(file_h, 'r') as f:
+		header = f.read()
+
+	names = {}
+
+	for block in header.split('\n\n'):
+		match = DEFINITION_RE.search(block)
+
+		if match is None:
+			continue
+
+		for name, member in MEMBER_RE.findall(block):
+			names[(match.group(1), member)] = name
+
+	return names, set(UNNAMED_DEFINITION_RE.findall(header))
+
+
+def check_names(description, expected, actual):
+	for key, name in actual.items():
+		if expected.get(key) != name:
+			raise Exception('%s: %s.%s is of type %s, expected %s' % (description, key[0], key[1], name, expected.get(key)))
+
+
+def main():
+	parser = create_parser()
+	parser.add_argument('-u', '--udts', type=int, default=DEFAULT_UDT_COUNT, help='number of generated structs')
+
+	args = parse_arguments(parser)
+	pdbex = args.pdbex
+
+	with tempfile.TemporaryDirectory() as directory:
+		file_pdb = os.path.join(directory, 'unnamed.pdb')
+		file_h   = os.path.join(directory, 'unnamed.h')
+
+		build_pdb(file_pdb, build_types, args.udts, False)
+
+		run_pdbex([pdbex, '*', file_pdb, '-e', 'n', '-o', file_h])
+		expected, defined = read_names(file_h)
+
+		if len(expected) != 3 * args.udts:
+			raise Exception('%d members of unnamed types found, expected %d' % (len(expected), 3 * args.udts))
+
+		if len(set(expected.values())) != 2 * args.udts:
+			raise Exception('%d different unnamed types found, expected %d' % (len(set(expected.values())), 2 * args.udts))
+
+		undefined = set(expected.values()) - defined
+
+		if undefined:
+			raise Exception('unnamed types referenced, but not defined: %s' % ', '.join(sorted(undefined)))
+
+		#
+		# Every struct alone and in its own file.
+		#
+
+		for thread_count in (1, 4):
+			output_directory = os.path.join(directory, 'out%d' % thread_count)
+
+			run_pdbex([pdbex, '%', file_pdb, '-e', 'n', '-w', str(thread_count), '-o', output_directory])
+
+			for i in range(args.udts):
+				names, _ = read_names(os.path.join(output_directory, '_STRUCT%d.h' % i))
+				check_names('%% -w %d' % thread_count, expected, names)
+
+		for i in range(args.udts):
+			run_pdbex([pdbex, '_STRUCT%d' % i, file_pdb, '-e', 'n', '-o', file_h])
+
+			names, _ = read_names(file_h)
+			check_names('_STRUCT%d' % i, expected, names)
+
+		#
+		# Unrelated types added.
+		#
+
+		build_pdb(file_pdb, build_types, args.udts, True)
+
+		run_pdbex([pdbex, '*', file_pdb, '-e', 'n', '-o', file_h])
+		names, _ = read_names(file_h)
+
+		check_names('with unrelated types', names, expected)
+
+	print('Test passed')
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
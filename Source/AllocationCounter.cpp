@@ -0,0 +1,100 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(PDBEX_COUNT_ALLOCATIONS)
+
+namespace
+{
+	//
+	// Counted per thread - extractions running in parallel
+	// (batch mode) don't see the allocations of each other.
+	//
+	thread_local ULONGLONG AllocationCount = 0;
+}
+
+void*
+operator new(
+	size_t Size
+	)
+{
+	AllocationCount += 1;
+
+	if (void* Memory = malloc(Size != 0 ? Size : 1))
+	{
+		return Memory;
+	}
+
+	throw std::bad_alloc();
+}
+
+void*
+operator new[](
+	size_t Size
+	)
+{
+	return operator new(Size);
+}
+
+void
+operator delete(
+	void* Memory
+	) noexcept
+{
+	free(Memory);
+}
+
+void
+operator delete[](
+	void* Memory
+	) noexcept
+{
+	free(Memory);
+}
+
+void
+operator delete(
+	void* Memory,
+	size_t Size
+	) noexcept
+{
+	free(Memory);
+}
+
+void
+operator delete[](
+	void* Memory,
+	size_t Size
+	) noexcept
+{
+	free(Memory);
+}
+
+BOOL
+AllocationCounter::IsEnabled()
+{
+	return TRUE;
+}
+
+ULONGLONG
+AllocationCounter::GetCount()
+{
+	return AllocationCount;
+}
+
+#else
+
+BOOL
+AllocationCounter::IsEnabled()
+{
+	return FALSE;
+}
+
+ULONGLONG
+AllocationCounter::GetCount()
+{
+	return 0;
+}
+
+#endif
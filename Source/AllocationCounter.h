@@ -0,0 +1,26 @@
+#pragma once
+#include "Platform.h"
+
+//
+// Counter of the heap allocations (operator new).
+//
+// Counting replaces the global operator new, therefore it's compiled
+// in only when PDBEX_COUNT_ALLOCATIONS is defined.  Otherwise the
+// counter is disabled and it always returns 0.
+//
+// Used by Scripts/test_allocations.py.
+//
+class AllocationCounter
+{
+	public:
+		static
+		BOOL
+		IsEnabled();
+
+		//
+		// Number of the allocations made so far by the calling thread.
+		//
+		static
+		ULONGLONG
+		GetCount();
+};
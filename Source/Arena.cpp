@@ -0,0 +1,179 @@
+#include "Arena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+Arena::Arena(
+	IN size_t ChunkSize
+	)
+	: m_ChunkSize(ChunkSize)
+{
+
+}
+
+Arena::~Arena()
+{
+	Reset();
+}
+
+Arena::Arena(
+	IN Arena&& Other
+	) noexcept
+	: m_ChunkSize(Other.m_ChunkSize)
+{
+	*this = std::move(Other);
+}
+
+Arena&
+Arena::operator=(
+	IN Arena&& Other
+	) noexcept
+{
+	if (this != &Other)
+	{
+		Reset();
+
+		m_Chunks       = std::move(Other.m_Chunks);
+		m_ChunkSize    = Other.m_ChunkSize;
+		m_Current      = Other.m_Current;
+		m_End          = Other.m_End;
+		m_ReservedSize = Other.m_ReservedSize;
+		m_UsedSize     = Other.m_UsedSize;
+
+		Other.m_Chunks.clear();
+		Other.m_Current      = nullptr;
+		Other.m_End          = nullptr;
+		Other.m_ReservedSize = 0;
+		Other.m_UsedSize     = 0;
+	}
+
+	return *this;
+}
+
+VOID*
+Arena::Allocate(
+	IN size_t Size,
+	IN size_t Alignment
+	)
+{
+	if (Size == 0)
+	{
+		Size = 1;
+	}
+
+	size_t Padding = (Alignment - reinterpret_cast<uintptr_t>(m_Current) % Alignment) % Alignment;
+
+	if (m_Current != nullptr &&
+	    Padding + Size <= static_cast<size_t>(m_End - m_Current))
+	{
+		BYTE* Memory = m_Current + Padding;
+
+		m_Current = Memory + Size;
+		m_UsedSize += Padding + Size;
+
+		return Memory;
+	}
+
+	//
+	// Chunks are allocated by operator new[], so their start
+	// is suitably aligned for any fundamental type.
+	//
+
+	if (Size > m_ChunkSize / 4)
+	{
+		//
+		// Big allocations get their own chunk, so that the rest
+		// of the current chunk isn't wasted.
+		//
+
+		BYTE* Chunk = new BYTE[Size];
+
+		m_Chunks.push_back(Chunk);
+		m_ReservedSize += Size;
+		m_UsedSize += Size;
+
+		return Chunk;
+	}
+
+	BYTE* Chunk = new BYTE[m_ChunkSize];
+
+	m_Chunks.push_back(Chunk);
+	m_ReservedSize += m_ChunkSize;
+	m_UsedSize += Size;
+
+	m_Current = Chunk + Size;
+	m_End = Chunk + m_ChunkSize;
+
+	return Chunk;
+}
+
+CHAR*
+Arena::DuplicateString(
+	IN const CHAR* String
+	)
+{
+	if (String == nullptr)
+	{
+		return nullptr;
+	}
+
+	size_t StringLength = strlen(String) + 1;
+	CHAR* StringCopy = static_cast<CHAR*>(Allocate(StringLength, 1));
+	memcpy(StringCopy, String, StringLength);
+
+	return StringCopy;
+}
+
+VOID
+Arena::Merge(
+	IN Arena& Other
+	)
+{
+	if (this == &Other)
+	{
+		return;
+	}
+
+	//
+	// Unused rest of the current chunk of the Other arena is lost,
+	// allocations continue in our current chunk.
+	//
+
+	m_Chunks.insert(m_Chunks.end(), Other.m_Chunks.begin(), Other.m_Chunks.end());
+	m_ReservedSize += Other.m_ReservedSize;
+	m_UsedSize += Other.m_UsedSize;
+
+	Other.m_Chunks.clear();
+	Other.m_Current      = nullptr;
+	Other.m_End          = nullptr;
+	Other.m_ReservedSize = 0;
+	Other.m_UsedSize     = 0;
+}
+
+VOID
+Arena::Reset()
+{
+	for (BYTE* Chunk : m_Chunks)
+	{
+		delete[] Chunk;
+	}
+
+	m_Chunks.clear();
+	m_Current      = nullptr;
+	m_End          = nullptr;
+	m_ReservedSize = 0;
+	m_UsedSize     = 0;
+}
+
+size_t
+Arena::GetReservedSize() const
+{
+	return m_ReservedSize;
+}
+
+size_t
+Arena::GetUsedSize() const
+{
+	return m_UsedSize;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "Platform.h"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+//
+// Bump allocator.
+//
+// Memory is carved out of large chunks and it is never freed
+// individually - all chunks are released at once by Reset()
+// (or by the destructor).  Only trivially destructible objects
+// can be allocated, since no destructors are ever called.
+//
+// The arena is not thread-safe.  Threads should allocate from their
+// own arenas and Merge() them into the shared one afterwards.
+//
+class Arena
+{
+	public:
+		static constexpr size_t DefaultChunkSize = 1024 * 1024;
+
+		Arena(
+			IN size_t ChunkSize = DefaultChunkSize
+			);
+
+		~Arena();
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		Arena(
+			IN Arena&& Other
+			) noexcept;
+
+		Arena&
+		operator=(
+			IN Arena&& Other
+			) noexcept;
+
+		//
+		// Returns uninitialized memory of the requested size.
+		// Never returns nullptr (zero-sized requests included).
+		//
+		VOID*
+		Allocate(
+			IN size_t Size,
+			IN size_t Alignment = alignof(std::max_align_t)
+			);
+
+		//
+		// Returns an array of Count value-initialized (zeroed) objects.
+		//
+		template <
+			typename T
+		>
+		T*
+		Allocate(
+			IN size_t Count = 1
+			)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed");
+
+			T* Objects = static_cast<T*>(Allocate(sizeof(T) * Count, alignof(T)));
+
+			for (size_t Index = 0; Index < Count; Index++)
+			{
+				new (&Objects[Index]) T();
+			}
+
+			return Objects;
+		}
+
+		//
+		// Returns a copy of the null-terminated string.
+		// Returns nullptr if the String is nullptr.
+		//
+		CHAR*
+		DuplicateString(
+			IN const CHAR* String
+			);
+
+		//
+		// Takes over all chunks of the Other arena.
+		// The Other arena is left empty.
+		//
+		VOID
+		Merge(
+			IN Arena& Other
+			);
+
+		//
+		// Releases all memory.
+		//
+		VOID
+		Reset();
+
+		//
+		// Bytes allocated from the system.
+		//
+		size_t
+		GetReservedSize() const;
+
+		//
+		// Bytes handed out by Allocate() (alignment included).
+		//
+		size_t
+		GetUsedSize() const;
+
+	private:
+		std::vector<BYTE*>   m_Chunks;
+		size_t               m_ChunkSize;
+
+		BYTE*                m_Current = nullptr;
+		BYTE*                m_End = nullptr;
+
+		size_t               m_ReservedSize = 0;
+		size_t               m_UsedSize = 0;
+};
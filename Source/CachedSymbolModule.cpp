@@ -0,0 +1,1057 @@
+#include "CachedSymbolModule.h"
+#include "CodeView.h"
+#include "MSF.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+	static const CHAR CACHE_MAGIC[8] = { 'P', 'D', 'B', 'E', 'X', 'S', 'C', '\0' };
+
+	//
+	// Bump this whenever the layout of the cache file
+	// or the meaning of its content changes.
+	//
+
+	static const DWORD CACHE_FORMAT_VERSION = 2;
+
+	//
+	// Pointers are stored in the file as offsets
+	// from the beginning of the file.
+	//
+
+	using POINTER_VALUE = uintptr_t;
+
+	BOOL
+	IsValidRange(
+		IN ULONGLONG Offset,
+		IN ULONGLONG Count,
+		IN size_t ElementSize,
+		IN size_t Alignment,
+		IN size_t FileSize
+		)
+	{
+		return Offset % Alignment == 0 &&
+		       Offset <= FileSize &&
+		       Count <= (FileSize - Offset) / ElementSize;
+	}
+
+	const CHAR*
+	GetReaderName(
+		IN PDB::ReaderType Reader
+		)
+	{
+		switch (Reader)
+		{
+			case PDB::ReaderType::Dia:    return "dia";
+			case PDB::ReaderType::Native: return "native";
+			default:                      return "default";
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CachedSymbolModule::Writer
+//
+
+//
+// Serializes the symbol graph of the module into the cache file image.
+//
+class CachedSymbolModule::Writer
+{
+	public:
+		Writer(
+			IN std::vector<BYTE>& Buffer
+			)
+			: m_Buffer(Buffer)
+		{
+
+		}
+
+		BOOL
+		Write(
+			IN SymbolModule& Module,
+			IN const CACHE_KEY& Key
+			)
+		{
+			m_Buffer.clear();
+
+			//
+			// Header goes first, so that no valid object
+			// is ever placed at offset 0 (which stands for nullptr).
+			//
+
+			ULONGLONG HeaderOffset = Allocate(sizeof(CACHE_HEADER), alignof(CACHE_HEADER));
+
+			const SymbolMap& Map = Module.GetSymbolMap();
+
+			//
+			// Find all names the symbols can be looked up by.
+			// The lookups are resolved by the module itself, so the cached
+			// module returns the same symbols the original reader would.
+			//
+
+			std::vector<const CHAR*> Names;
+
+			DWORD TypeIdEnd = 0;
+
+			for (const SYMBOL* Symbol : Map)
+			{
+				if (Map.Get(Symbol->TypeId) != Symbol)
+				{
+					//
+					// Symbols must be keyed by their own Type ID,
+					// otherwise the symbol table couldn't be restored.
+					//
+
+					return FALSE;
+				}
+
+				TypeIdEnd = (std::max)(TypeIdEnd, Symbol->TypeId + 1);
+
+				if (Symbol->Name != nullptr &&
+				    !Symbol->IsConst &&
+				    !Symbol->IsVolatile)
+				{
+					Names.push_back(Symbol->Name);
+				}
+			}
+
+			std::sort(Names.begin(), Names.end(), [](const CHAR* Lhs, const CHAR* Rhs) {
+				return strcmp(Lhs, Rhs) < 0;
+			});
+
+			Names.erase(std::unique(Names.begin(), Names.end(), [](const CHAR* Lhs, const CHAR* Rhs) {
+				return strcmp(Lhs, Rhs) == 0;
+			}), Names.end());
+
+			std::vector<CACHE_NAME_ENTRY> NameIndex;
+
+			for (const CHAR* Name : Names)
+			{
+				if (SYMBOL* Symbol = Module.GetSymbolByName(Name))
+				{
+					NameIndex.push_back({ Name, Symbol });
+				}
+			}
+
+			//
+			// Collect every symbol reachable from the map and the name index.
+			//
+
+			for (SYMBOL* Symbol : Map)
+			{
+				AddSymbol(Symbol);
+			}
+
+			for (auto&& Entry : NameIndex)
+			{
+				AddSymbol(Entry.Symbol);
+			}
+
+			for (size_t Index = 0; Index < m_Symbols.size(); Index++)
+			{
+				AddReferencedSymbols(m_Symbols[Index]);
+			}
+
+			ULONGLONG SymbolsOffset = Allocate(sizeof(SYMBOL) * m_Symbols.size(), alignof(SYMBOL));
+
+			for (size_t Index = 0; Index < m_Symbols.size(); Index++)
+			{
+				m_SymbolOffsets[m_Symbols[Index]] = SymbolsOffset + Index * sizeof(SYMBOL);
+			}
+
+			for (const SYMBOL* Symbol : m_Symbols)
+			{
+				WriteSymbol(Symbol);
+			}
+
+			//
+			// Symbol table.
+			//
+
+			ULONGLONG SymbolTableOffset = Allocate(sizeof(POINTER_VALUE) * TypeIdEnd, alignof(POINTER_VALUE));
+
+			for (const SYMBOL* Symbol : Map)
+			{
+				SetSymbolPointer(SymbolTableOffset + Symbol->TypeId * sizeof(POINTER_VALUE), Symbol);
+			}
+
+			//
+			// Name index.
+			//
+
+			ULONGLONG NameIndexOffset = Allocate(sizeof(CACHE_NAME_ENTRY) * NameIndex.size(), alignof(CACHE_NAME_ENTRY));
+
+			for (size_t Index = 0; Index < NameIndex.size(); Index++)
+			{
+				ULONGLONG EntryOffset = NameIndexOffset + Index * sizeof(CACHE_NAME_ENTRY);
+
+				SetStringPointer(EntryOffset + offsetof(CACHE_NAME_ENTRY, Name), NameIndex[Index].Name);
+				SetSymbolPointer(EntryOffset + offsetof(CACHE_NAME_ENTRY, Symbol), NameIndex[Index].Symbol);
+			}
+
+			//
+			// Function names.
+			//
+
+			const FunctionSet& Functions = Module.GetFunctionSet();
+
+			ULONGLONG FunctionTableOffset = Allocate(sizeof(POINTER_VALUE) * Functions.size(), alignof(POINTER_VALUE));
+			ULONGLONG FunctionOffset = FunctionTableOffset;
+
+			for (auto&& Function : Functions)
+			{
+				SetStringPointer(FunctionOffset, Function.c_str());
+				FunctionOffset += sizeof(POINTER_VALUE);
+			}
+
+			//
+			// Relocations.
+			//
+
+			std::sort(m_Relocations.begin(), m_Relocations.end(), [](const CACHE_RELOCATION& Lhs, const CACHE_RELOCATION& Rhs) {
+				return Lhs.PointerOffset < Rhs.PointerOffset;
+			});
+
+			ULONGLONG RelocationTableOffset = Allocate(sizeof(CACHE_RELOCATION) * m_Relocations.size(), alignof(CACHE_RELOCATION));
+
+			if (!m_Relocations.empty())
+			{
+				memcpy(&m_Buffer[RelocationTableOffset], m_Relocations.data(), sizeof(CACHE_RELOCATION) * m_Relocations.size());
+			}
+
+			//
+			// Finally fill the header.
+			//
+
+			CACHE_HEADER Header = {};
+			memcpy(Header.Magic, CACHE_MAGIC, sizeof(Header.Magic));
+			Header.FormatVersion         = CACHE_FORMAT_VERSION;
+			Header.PointerSize           = sizeof(VOID*);
+			Header.SymbolSize            = sizeof(SYMBOL);
+			Header.UdtFieldSize          = sizeof(SYMBOL_UDT_FIELD);
+			Header.EnumFieldSize         = sizeof(SYMBOL_ENUM_FIELD);
+			Header.Key                   = Key;
+			Header.MachineType           = Module.GetMachineType();
+			Header.Language              = static_cast<DWORD>(Module.GetLanguage());
+			Header.FileSize              = m_Buffer.size();
+			Header.SymbolTableOffset     = SymbolTableOffset;
+			Header.SymbolTableCount      = TypeIdEnd;
+			Header.NameIndexOffset       = NameIndexOffset;
+			Header.NameIndexCount        = NameIndex.size();
+			Header.FunctionTableOffset   = FunctionTableOffset;
+			Header.FunctionTableCount    = Functions.size();
+			Header.RelocationTableOffset = RelocationTableOffset;
+			Header.RelocationTableCount  = m_Relocations.size();
+
+			memcpy(&m_Buffer[HeaderOffset], &Header, sizeof(Header));
+
+			return TRUE;
+		}
+
+	private:
+		//
+		// Appends zeroed space to the image, returns its offset.
+		//
+		ULONGLONG
+		Allocate(
+			IN size_t Size,
+			IN size_t Alignment
+			)
+		{
+			size_t Offset = (m_Buffer.size() + Alignment - 1) / Alignment * Alignment;
+			m_Buffer.resize(Offset + Size, 0);
+
+			return Offset;
+		}
+
+		//
+		// Stores the offset of the target at PointerOffset
+		// and remembers the pointer for relocation.
+		//
+		VOID
+		SetPointer(
+			IN ULONGLONG PointerOffset,
+			IN ULONGLONG TargetOffset,
+			IN CacheTarget TargetKind,
+			IN DWORD TargetCount
+			)
+		{
+			POINTER_VALUE Value = static_cast<POINTER_VALUE>(TargetOffset);
+			memcpy(&m_Buffer[PointerOffset], &Value, sizeof(Value));
+
+			if (TargetOffset != 0)
+			{
+				m_Relocations.push_back({ PointerOffset, TargetKind, TargetCount });
+			}
+		}
+
+		VOID
+		SetSymbolPointer(
+			IN ULONGLONG PointerOffset,
+			IN const SYMBOL* Symbol
+			)
+		{
+			SetPointer(PointerOffset, GetSymbolOffset(Symbol), CacheTarget::Symbol, 1);
+		}
+
+		VOID
+		SetStringPointer(
+			IN ULONGLONG PointerOffset,
+			IN const CHAR* String
+			)
+		{
+			SetPointer(
+				PointerOffset,
+				AddString(String),
+				CacheTarget::String,
+				String != nullptr ? static_cast<DWORD>(strlen(String) + 1) : 0
+				);
+		}
+
+		ULONGLONG
+		AddString(
+			IN const CHAR* String
+			)
+		{
+			if (String == nullptr)
+			{
+				return 0;
+			}
+
+			std::string_view StringView(String);
+
+			auto it = m_StringOffsets.find(StringView);
+
+			if (it != m_StringOffsets.end())
+			{
+				return it->second;
+			}
+
+			ULONGLONG Offset = Allocate(StringView.size() + 1, 1);
+			memcpy(&m_Buffer[Offset], StringView.data(), StringView.size());
+
+			m_StringOffsets.emplace(StringView, Offset);
+
+			return Offset;
+		}
+
+		VOID
+		AddSymbol(
+			IN const SYMBOL* Symbol
+			)
+		{
+			if (Symbol != nullptr &&
+			    m_SymbolOffsets.emplace(Symbol, 0).second)
+			{
+				m_Symbols.push_back(Symbol);
+			}
+		}
+
+		VOID
+		AddReferencedSymbols(
+			IN const SYMBOL* Symbol
+			)
+		{
+			switch (Symbol->Tag)
+			{
+				case SymTagEnum:
+					for (DWORD Index = 0; Index < Symbol->u.Enum.FieldCount; Index++)
+					{
+						AddSymbol(Symbol->u.Enum.Fields[Index].Parent);
+					}
+					break;
+
+				case SymTagTypedef:
+					AddSymbol(Symbol->u.Typedef.Type);
+					break;
+
+				case SymTagPointerType:
+					AddSymbol(Symbol->u.Pointer.Type);
+					break;
+
+				case SymTagArrayType:
+					AddSymbol(Symbol->u.Array.ElementType);
+					break;
+
+				case SymTagFunctionType:
+					AddSymbol(Symbol->u.Function.ReturnType);
+
+					for (DWORD Index = 0; Index < Symbol->u.Function.ArgumentCount; Index++)
+					{
+						AddSymbol(Symbol->u.Function.Arguments[Index]);
+					}
+					break;
+
+				case SymTagFunctionArgType:
+					AddSymbol(Symbol->u.FunctionArg.Type);
+					break;
+
+				case SymTagUDT:
+					for (DWORD Index = 0; Index < Symbol->u.Udt.FieldCount; Index++)
+					{
+						AddSymbol(Symbol->u.Udt.Fields[Index].Type);
+						AddSymbol(Symbol->u.Udt.Fields[Index].Parent);
+					}
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		ULONGLONG
+		GetSymbolOffset(
+			IN const SYMBOL* Symbol
+			)
+		{
+			return Symbol != nullptr
+				? m_SymbolOffsets[Symbol]
+				: 0;
+		}
+
+		VOID
+		WriteSymbol(
+			IN const SYMBOL* Symbol
+			)
+		{
+			ULONGLONG Offset = GetSymbolOffset(Symbol);
+
+			//
+			// Copy the plain data, pointers are set separately.
+			//
+
+			SYMBOL SymbolCopy = *Symbol;
+			SymbolCopy.Name = nullptr;
+
+			switch (Symbol->Tag)
+			{
+				case SymTagEnum:            SymbolCopy.u.Enum.Fields = nullptr;        break;
+				case SymTagTypedef:         SymbolCopy.u.Typedef.Type = nullptr;       break;
+				case SymTagPointerType:     SymbolCopy.u.Pointer.Type = nullptr;       break;
+				case SymTagArrayType:       SymbolCopy.u.Array.ElementType = nullptr;  break;
+				case SymTagFunctionArgType: SymbolCopy.u.FunctionArg.Type = nullptr;   break;
+				case SymTagUDT:             SymbolCopy.u.Udt.Fields = nullptr;         break;
+
+				case SymTagFunctionType:
+					SymbolCopy.u.Function.ReturnType = nullptr;
+					SymbolCopy.u.Function.Arguments = nullptr;
+					break;
+
+				default:
+					break;
+			}
+
+			memcpy(&m_Buffer[Offset], &SymbolCopy, sizeof(SymbolCopy));
+
+			SetStringPointer(Offset + offsetof(SYMBOL, Name), Symbol->Name);
+
+			switch (Symbol->Tag)
+			{
+				case SymTagEnum:
+					SetPointer(Offset + offsetof(SYMBOL, u.Enum.Fields), WriteEnumFields(Symbol), CacheTarget::EnumField, Symbol->u.Enum.FieldCount);
+					break;
+
+				case SymTagTypedef:
+					SetSymbolPointer(Offset + offsetof(SYMBOL, u.Typedef.Type), Symbol->u.Typedef.Type);
+					break;
+
+				case SymTagPointerType:
+					SetSymbolPointer(Offset + offsetof(SYMBOL, u.Pointer.Type), Symbol->u.Pointer.Type);
+					break;
+
+				case SymTagArrayType:
+					SetSymbolPointer(Offset + offsetof(SYMBOL, u.Array.ElementType), Symbol->u.Array.ElementType);
+					break;
+
+				case SymTagFunctionType:
+					SetSymbolPointer(Offset + offsetof(SYMBOL, u.Function.ReturnType), Symbol->u.Function.ReturnType);
+					SetPointer(Offset + offsetof(SYMBOL, u.Function.Arguments), WriteArguments(Symbol), CacheTarget::SymbolPointer, Symbol->u.Function.ArgumentCount);
+					break;
+
+				case SymTagFunctionArgType:
+					SetSymbolPointer(Offset + offsetof(SYMBOL, u.FunctionArg.Type), Symbol->u.FunctionArg.Type);
+					break;
+
+				case SymTagUDT:
+					SetPointer(Offset + offsetof(SYMBOL, u.Udt.Fields), WriteUdtFields(Symbol), CacheTarget::UdtField, Symbol->u.Udt.FieldCount);
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		ULONGLONG
+		WriteEnumFields(
+			IN const SYMBOL* Symbol
+			)
+		{
+			DWORD FieldCount = Symbol->u.Enum.FieldCount;
+
+			if (FieldCount == 0)
+			{
+				return 0;
+			}
+
+			ULONGLONG Offset = Allocate(sizeof(SYMBOL_ENUM_FIELD) * FieldCount, alignof(SYMBOL_ENUM_FIELD));
+
+			for (DWORD Index = 0; Index < FieldCount; Index++)
+			{
+				const SYMBOL_ENUM_FIELD* Field = &Symbol->u.Enum.Fields[Index];
+				ULONGLONG FieldOffset = Offset + Index * sizeof(SYMBOL_ENUM_FIELD);
+
+				SYMBOL_ENUM_FIELD FieldCopy = *Field;
+				FieldCopy.Name = nullptr;
+				FieldCopy.Parent = nullptr;
+
+				memcpy(&m_Buffer[FieldOffset], &FieldCopy, sizeof(FieldCopy));
+
+				SetStringPointer(FieldOffset + offsetof(SYMBOL_ENUM_FIELD, Name), Field->Name);
+				SetSymbolPointer(FieldOffset + offsetof(SYMBOL_ENUM_FIELD, Parent), Field->Parent);
+			}
+
+			return Offset;
+		}
+
+		ULONGLONG
+		WriteUdtFields(
+			IN const SYMBOL* Symbol
+			)
+		{
+			DWORD FieldCount = Symbol->u.Udt.FieldCount;
+
+			if (FieldCount == 0)
+			{
+				return 0;
+			}
+
+			ULONGLONG Offset = Allocate(sizeof(SYMBOL_UDT_FIELD) * FieldCount, alignof(SYMBOL_UDT_FIELD));
+
+			for (DWORD Index = 0; Index < FieldCount; Index++)
+			{
+				const SYMBOL_UDT_FIELD* Field = &Symbol->u.Udt.Fields[Index];
+				ULONGLONG FieldOffset = Offset + Index * sizeof(SYMBOL_UDT_FIELD);
+
+				SYMBOL_UDT_FIELD FieldCopy = *Field;
+				FieldCopy.Name = nullptr;
+				FieldCopy.Type = nullptr;
+				FieldCopy.Parent = nullptr;
+
+				memcpy(&m_Buffer[FieldOffset], &FieldCopy, sizeof(FieldCopy));
+
+				SetStringPointer(FieldOffset + offsetof(SYMBOL_UDT_FIELD, Name), Field->Name);
+				SetSymbolPointer(FieldOffset + offsetof(SYMBOL_UDT_FIELD, Type), Field->Type);
+				SetSymbolPointer(FieldOffset + offsetof(SYMBOL_UDT_FIELD, Parent), Field->Parent);
+			}
+
+			return Offset;
+		}
+
+		ULONGLONG
+		WriteArguments(
+			IN const SYMBOL* Symbol
+			)
+		{
+			DWORD ArgumentCount = Symbol->u.Function.ArgumentCount;
+
+			if (ArgumentCount == 0)
+			{
+				return 0;
+			}
+
+			ULONGLONG Offset = Allocate(sizeof(POINTER_VALUE) * ArgumentCount, alignof(POINTER_VALUE));
+
+			for (DWORD Index = 0; Index < ArgumentCount; Index++)
+			{
+				SetSymbolPointer(Offset + Index * sizeof(POINTER_VALUE), Symbol->u.Function.Arguments[Index]);
+			}
+
+			return Offset;
+		}
+
+	private:
+		std::vector<BYTE>&                               m_Buffer;
+
+		std::vector<const SYMBOL*>                       m_Symbols;
+		std::unordered_map<const SYMBOL*, ULONGLONG>     m_SymbolOffsets;
+		std::unordered_map<std::string_view, ULONGLONG>  m_StringOffsets;
+		std::vector<CACHE_RELOCATION>                    m_Relocations;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// CachedSymbolModule - implementation
+//
+
+CachedSymbolModule::CachedSymbolModule(
+	IN const CHAR* CacheDirectory,
+	IN PDB::ReaderType Reader
+	)
+	: m_CacheDirectory(CacheDirectory)
+	, m_Reader(Reader)
+{
+
+}
+
+CachedSymbolModule::~CachedSymbolModule()
+{
+	Close();
+}
+
+BOOL
+CachedSymbolModule::Open(
+	IN const CHAR* Path
+	)
+{
+	Close();
+
+	std::string CachePath;
+	CACHE_KEY Key;
+
+	if (!GetCachePath(m_CacheDirectory.c_str(), m_Reader, Path, CachePath, Key))
+	{
+		return FALSE;
+	}
+
+	if (!MapFile(CachePath.c_str()))
+	{
+		return FALSE;
+	}
+
+	m_Header = reinterpret_cast<const CACHE_HEADER*>(m_BaseAddress);
+
+	if (m_FileSize < sizeof(CACHE_HEADER) ||
+	    memcmp(m_Header->Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+	    m_Header->FormatVersion != CACHE_FORMAT_VERSION ||
+	    m_Header->PointerSize   != sizeof(VOID*) ||
+	    m_Header->SymbolSize    != sizeof(SYMBOL) ||
+	    m_Header->UdtFieldSize  != sizeof(SYMBOL_UDT_FIELD) ||
+	    m_Header->EnumFieldSize != sizeof(SYMBOL_ENUM_FIELD) ||
+	    memcmp(&m_Header->Key, &Key, sizeof(Key)) != 0 ||
+	    m_Header->FileSize != m_FileSize ||
+	    m_Header->SymbolTableCount > 0xFFFFFFFF ||
+	    !Relocate())
+	{
+		Close();
+		return FALSE;
+	}
+
+	const POINTER_VALUE* SymbolTable = reinterpret_cast<const POINTER_VALUE*>(m_BaseAddress + m_Header->SymbolTableOffset);
+
+	m_SymbolMap.Reserve(static_cast<DWORD>(m_Header->SymbolTableCount));
+
+	for (DWORD TypeId = 0; TypeId < m_Header->SymbolTableCount; TypeId++)
+	{
+		if (SymbolTable[TypeId] != 0)
+		{
+			m_SymbolMap.Set(TypeId, reinterpret_cast<SYMBOL*>(SymbolTable[TypeId]));
+		}
+	}
+
+	const POINTER_VALUE* FunctionTable = reinterpret_cast<const POINTER_VALUE*>(m_BaseAddress + m_Header->FunctionTableOffset);
+
+	for (ULONGLONG Index = 0; Index < m_Header->FunctionTableCount; Index++)
+	{
+		m_FunctionSet.insert(reinterpret_cast<const CHAR*>(FunctionTable[Index]));
+	}
+
+	m_NameIndex = reinterpret_cast<const CACHE_NAME_ENTRY*>(m_BaseAddress + m_Header->NameIndexOffset);
+
+	m_MachineType = m_Header->MachineType;
+	m_Language = static_cast<CV_CFL_LANG>(m_Header->Language);
+
+	m_Path = Path;
+
+	return TRUE;
+}
+
+BOOL
+CachedSymbolModule::IsOpen() const
+{
+	return m_Header != nullptr;
+}
+
+VOID
+CachedSymbolModule::Close()
+{
+	SymbolModule::Close();
+
+	UnmapFile();
+
+	m_Header = nullptr;
+	m_NameIndex = nullptr;
+}
+
+SYMBOL*
+CachedSymbolModule::GetSymbolByName(
+	IN const CHAR* SymbolName
+	)
+{
+	if (m_Header == nullptr)
+	{
+		return nullptr;
+	}
+
+	const CACHE_NAME_ENTRY* NameIndexEnd = m_NameIndex + m_Header->NameIndexCount;
+
+	const CACHE_NAME_ENTRY* Entry = std::lower_bound(m_NameIndex, NameIndexEnd, SymbolName, [](const CACHE_NAME_ENTRY& Lhs, const CHAR* Rhs) {
+		return strcmp(Lhs.Name, Rhs) < 0;
+	});
+
+	return Entry != NameIndexEnd && strcmp(Entry->Name, SymbolName) == 0
+		? Entry->Symbol
+		: nullptr;
+}
+
+const SymbolNameMap&
+CachedSymbolModule::GetSymbolNameMap()
+{
+	if (m_Header != nullptr && m_SymbolNameMap.empty())
+	{
+		for (ULONGLONG Index = 0; Index < m_Header->NameIndexCount; Index++)
+		{
+			m_SymbolNameMap[m_NameIndex[Index].Name] = m_NameIndex[Index].Symbol;
+		}
+	}
+
+	return m_SymbolNameMap;
+}
+
+BOOL
+CachedSymbolModule::Save(
+	IN const CHAR* CacheDirectory,
+	IN PDB::ReaderType Reader,
+	IN SymbolModule& Module
+	)
+{
+	if (!Module.IsOpen())
+	{
+		return FALSE;
+	}
+
+	std::string CachePath;
+	CACHE_KEY Key;
+
+	if (!GetCachePath(CacheDirectory, Reader, Module.GetPath(), CachePath, Key))
+	{
+		return FALSE;
+	}
+
+	std::vector<BYTE> Buffer;
+
+	if (!Writer(Buffer).Write(Module, Key))
+	{
+		return FALSE;
+	}
+
+	//
+	// Write into a temporary file first and rename it afterwards,
+	// so that other processes never see a partially written file.
+	//
+
+	std::error_code ErrorCode;
+	std::filesystem::create_directories(CacheDirectory, ErrorCode);
+
+	CHAR Suffix[32];
+	snprintf(Suffix, sizeof(Suffix), ".%08x.tmp", static_cast<unsigned>(std::random_device()()));
+
+	std::string TemporaryPath = CachePath + Suffix;
+
+	{
+		std::ofstream CacheFile(TemporaryPath, std::ios::binary | std::ios::trunc);
+		CacheFile.write(reinterpret_cast<const char*>(Buffer.data()), Buffer.size());
+
+		if (!CacheFile.good())
+		{
+			CacheFile.close();
+			std::filesystem::remove(TemporaryPath, ErrorCode);
+			return FALSE;
+		}
+	}
+
+	std::filesystem::rename(TemporaryPath, CachePath, ErrorCode);
+
+	if (ErrorCode)
+	{
+		std::filesystem::remove(TemporaryPath, ErrorCode);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+BOOL
+CachedSymbolModule::GetCachePath(
+	IN const CHAR* CacheDirectory,
+	IN PDB::ReaderType Reader,
+	IN const CHAR* PdbPath,
+	OUT std::string& CachePath,
+	OUT CACHE_KEY& Key
+	)
+{
+	MSFFile File;
+	MSFStream InfoStream;
+
+	if (!File.Open(PdbPath) ||
+	    !File.ReadStream(MSFStreamPdbInfo, InfoStream) ||
+	    InfoStream.Size < sizeof(PDB_INFO_STREAM_HEADER))
+	{
+		return FALSE;
+	}
+
+	PDB_INFO_STREAM_HEADER InfoHeader;
+	memcpy(&InfoHeader, InfoStream.Data, sizeof(InfoHeader));
+
+	memset(&Key, 0, sizeof(Key));
+	memcpy(Key.Guid, InfoHeader.Guid, sizeof(Key.Guid));
+	Key.Age = InfoHeader.Age;
+	Key.Reader = static_cast<DWORD>(Reader);
+
+	std::error_code ErrorCode;
+	Key.PdbFileSize = std::filesystem::file_size(PdbPath, ErrorCode);
+
+	if (ErrorCode)
+	{
+		return FALSE;
+	}
+
+	//
+	// Same naming scheme as the symbol server uses:
+	// GUID (as a string, without dashes) followed by the age.
+	//
+
+	DWORD Data1;
+	WORD Data2;
+	WORD Data3;
+	memcpy(&Data1, &Key.Guid[0], sizeof(Data1));
+	memcpy(&Data2, &Key.Guid[4], sizeof(Data2));
+	memcpy(&Data3, &Key.Guid[6], sizeof(Data3));
+
+	CHAR FileName[128];
+	snprintf(
+		FileName, sizeof(FileName),
+		"%08X%04X%04X%02X%02X%02X%02X%02X%02X%02X%02X%X.%s.cache",
+		Data1, Data2, Data3,
+		Key.Guid[8], Key.Guid[9], Key.Guid[10], Key.Guid[11],
+		Key.Guid[12], Key.Guid[13], Key.Guid[14], Key.Guid[15],
+		Key.Age,
+		GetReaderName(Reader)
+		);
+
+	CachePath = (std::filesystem::path(CacheDirectory) / FileName).string();
+
+	return TRUE;
+}
+
+BOOL
+CachedSymbolModule::MapFile(
+	IN const CHAR* Path
+	)
+{
+	//
+	// The file is mapped copy-on-write - the relocated pages
+	// are private to this process and the file itself stays intact.
+	//
+
+#if defined(_WIN32)
+	m_FileHandle = CreateFileA(
+		Path,
+		GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_DELETE,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr
+		);
+
+	if (m_FileHandle == INVALID_HANDLE_VALUE)
+	{
+		return FALSE;
+	}
+
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(m_FileHandle, &FileSize) || FileSize.QuadPart == 0)
+	{
+		UnmapFile();
+		return FALSE;
+	}
+
+	m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+
+	if (m_MappingHandle == nullptr)
+	{
+		UnmapFile();
+		return FALSE;
+	}
+
+	m_BaseAddress = static_cast<BYTE*>(MapViewOfFile(m_MappingHandle, FILE_MAP_COPY, 0, 0, 0));
+	m_FileSize = static_cast<size_t>(FileSize.QuadPart);
+#else
+	int FileDescriptor = open(Path, O_RDONLY);
+
+	if (FileDescriptor == -1)
+	{
+		return FALSE;
+	}
+
+	struct stat FileStat;
+	if (fstat(FileDescriptor, &FileStat) != 0 || FileStat.st_size == 0)
+	{
+		close(FileDescriptor);
+		return FALSE;
+	}
+
+	void* BaseAddress = mmap(nullptr, FileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, FileDescriptor, 0);
+
+	close(FileDescriptor);
+
+	if (BaseAddress == MAP_FAILED)
+	{
+		return FALSE;
+	}
+
+	m_BaseAddress = static_cast<BYTE*>(BaseAddress);
+	m_FileSize = static_cast<size_t>(FileStat.st_size);
+#endif
+
+	if (m_BaseAddress == nullptr)
+	{
+		UnmapFile();
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+VOID
+CachedSymbolModule::UnmapFile()
+{
+#if defined(_WIN32)
+	if (m_BaseAddress != nullptr)
+	{
+		UnmapViewOfFile(m_BaseAddress);
+	}
+
+	if (m_MappingHandle != nullptr)
+	{
+		CloseHandle(m_MappingHandle);
+		m_MappingHandle = nullptr;
+	}
+
+	if (m_FileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_FileHandle);
+		m_FileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_BaseAddress != nullptr)
+	{
+		munmap(m_BaseAddress, m_FileSize);
+	}
+#endif
+
+	m_BaseAddress = nullptr;
+	m_FileSize = 0;
+}
+
+//
+// Size and alignment of the objects of the kind,
+// FALSE if the kind is unknown.
+//
+
+BOOL
+CachedSymbolModule::GetTargetLayout(
+	IN CacheTarget TargetKind,
+	OUT size_t& ElementSize,
+	OUT size_t& Alignment
+	)
+{
+	switch (TargetKind)
+	{
+		case CacheTarget::String:        ElementSize = sizeof(CHAR);              Alignment = alignof(CHAR);              return TRUE;
+		case CacheTarget::Symbol:        ElementSize = sizeof(SYMBOL);            Alignment = alignof(SYMBOL);            return TRUE;
+		case CacheTarget::SymbolPointer: ElementSize = sizeof(POINTER_VALUE);     Alignment = alignof(POINTER_VALUE);     return TRUE;
+		case CacheTarget::UdtField:      ElementSize = sizeof(SYMBOL_UDT_FIELD);  Alignment = alignof(SYMBOL_UDT_FIELD);  return TRUE;
+		case CacheTarget::EnumField:     ElementSize = sizeof(SYMBOL_ENUM_FIELD); Alignment = alignof(SYMBOL_ENUM_FIELD); return TRUE;
+		default:                         return FALSE;
+	}
+}
+
+BOOL
+CachedSymbolModule::Relocate()
+{
+	if (!IsValidRange(m_Header->SymbolTableOffset,     m_Header->SymbolTableCount,     sizeof(POINTER_VALUE),    alignof(POINTER_VALUE),    m_FileSize) ||
+	    !IsValidRange(m_Header->NameIndexOffset,       m_Header->NameIndexCount,       sizeof(CACHE_NAME_ENTRY), alignof(CACHE_NAME_ENTRY), m_FileSize) ||
+	    !IsValidRange(m_Header->FunctionTableOffset,   m_Header->FunctionTableCount,   sizeof(POINTER_VALUE),    alignof(POINTER_VALUE),    m_FileSize) ||
+	    !IsValidRange(m_Header->RelocationTableOffset, m_Header->RelocationTableCount, sizeof(CACHE_RELOCATION), alignof(CACHE_RELOCATION), m_FileSize))
+	{
+		return FALSE;
+	}
+
+	const CACHE_RELOCATION* Relocations = reinterpret_cast<const CACHE_RELOCATION*>(m_BaseAddress + m_Header->RelocationTableOffset);
+	const ULONGLONG RelocationTableBegin = m_Header->RelocationTableOffset;
+	const ULONGLONG RelocationTableEnd = RelocationTableBegin + m_Header->RelocationTableCount * sizeof(CACHE_RELOCATION);
+
+	for (ULONGLONG Index = 0; Index < m_Header->RelocationTableCount; Index++)
+	{
+		const CACHE_RELOCATION& Relocation = Relocations[Index];
+		ULONGLONG PointerOffset = Relocation.PointerOffset;
+
+		//
+		// Neither the header nor the relocation table itself
+		// can contain a pointer.
+		//
+
+		if (PointerOffset < sizeof(CACHE_HEADER) ||
+		    !IsValidRange(PointerOffset, 1, sizeof(POINTER_VALUE), alignof(POINTER_VALUE), m_FileSize) ||
+		    (PointerOffset + sizeof(POINTER_VALUE) > RelocationTableBegin && PointerOffset < RelocationTableEnd))
+		{
+			return FALSE;
+		}
+
+		POINTER_VALUE& Pointer = *reinterpret_cast<POINTER_VALUE*>(m_BaseAddress + PointerOffset);
+
+		//
+		// All of the objects the pointer points to have to be
+		// in the file and aligned, strings have to be terminated.
+		//
+
+		size_t ElementSize;
+		size_t Alignment;
+
+		if (!GetTargetLayout(Relocation.TargetKind, ElementSize, Alignment) ||
+		    Relocation.TargetCount == 0 ||
+		    Pointer < sizeof(CACHE_HEADER) ||
+		    !IsValidRange(Pointer, Relocation.TargetCount, ElementSize, Alignment, m_FileSize))
+		{
+			return FALSE;
+		}
+
+		if (Relocation.TargetKind == CacheTarget::String &&
+		    m_BaseAddress[Pointer + Relocation.TargetCount - 1] != '\0')
+		{
+			return FALSE;
+		}
+
+		Pointer += reinterpret_cast<POINTER_VALUE>(m_BaseAddress);
+	}
+
+	return TRUE;
+}
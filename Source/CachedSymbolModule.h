@@ -0,0 +1,216 @@
+#pragma once
+#include "SymbolModule.h"
+
+#include <string>
+
+//
+// Symbols loaded from the cache file.
+//
+// The cache file holds the whole symbol graph of a PDB file, as built
+// by another reader.  Pointers inside the file are stored as offsets
+// from the beginning of the file - the file is mapped copy-on-write
+// and the pointers are relocated in place, no symbol is decoded
+// or allocated.
+//
+// The cache file of the PDB is looked up in the cache directory
+// by the GUID and age of the PDB (and by the reader which created it).
+// Files created by other versions of the cache format, by builds with
+// a different layout of the SYMBOL structure or for other PDB builds
+// are never used.
+//
+class CachedSymbolModule
+	: public SymbolModule
+{
+	public:
+		CachedSymbolModule(
+			IN const CHAR* CacheDirectory,
+			IN PDB::ReaderType Reader
+			);
+
+		~CachedSymbolModule();
+
+		//
+		// Opens the cache file of the provided PDB file.
+		//
+		// Returns FALSE if there is no valid cache file for it.
+		//
+		BOOL
+		Open(
+			IN const CHAR* Path
+			) override;
+
+		BOOL
+		IsOpen() const override;
+
+		VOID
+		Close() override;
+
+		SYMBOL*
+		GetSymbolByName(
+			IN const CHAR* SymbolName
+			) override;
+
+		const SymbolNameMap&
+		GetSymbolNameMap() override;
+
+		//
+		// Writes all symbols of the Module (which has the PDB file
+		// opened) into the cache directory.
+		//
+		// Returns non-zero value on success.
+		//
+		static
+		BOOL
+		Save(
+			IN const CHAR* CacheDirectory,
+			IN PDB::ReaderType Reader,
+			IN SymbolModule& Module
+			);
+
+	private:
+		//
+		// Identification of the PDB build.
+		//
+		// Stripped (public) PDB has the same GUID and age
+		// as the full one, the size of the file tells them apart.
+		//
+		struct CACHE_KEY
+		{
+			BYTE                 Guid[16];
+			DWORD                Age;
+			DWORD                Reader;
+			ULONGLONG            PdbFileSize;
+		};
+
+		//
+		// Header of the cache file.  All offsets are relative
+		// to the beginning of the file.
+		//
+		struct CACHE_HEADER
+		{
+			CHAR                 Magic[8];
+			DWORD                FormatVersion;
+
+			//
+			// Layout of the structures stored in the file.
+			//
+			DWORD                PointerSize;
+			DWORD                SymbolSize;
+			DWORD                UdtFieldSize;
+			DWORD                EnumFieldSize;
+
+			CACHE_KEY            Key;
+
+			DWORD                MachineType;
+			DWORD                Language;
+
+			ULONGLONG            FileSize;
+
+			//
+			// SYMBOL*[], indexed by the Type ID.
+			//
+			ULONGLONG            SymbolTableOffset;
+			ULONGLONG            SymbolTableCount;
+
+			//
+			// CACHE_NAME_ENTRY[], sorted by the name.
+			//
+			ULONGLONG            NameIndexOffset;
+			ULONGLONG            NameIndexCount;
+
+			//
+			// const CHAR*[], names of the functions.
+			//
+			ULONGLONG            FunctionTableOffset;
+			ULONGLONG            FunctionTableCount;
+
+			//
+			// CACHE_RELOCATION[], all pointers in the file.
+			//
+			ULONGLONG            RelocationTableOffset;
+			ULONGLONG            RelocationTableCount;
+		};
+
+		//
+		// Kind of the object(s) a pointer in the file points to.
+		//
+		enum class CacheTarget : DWORD
+		{
+			String,
+			Symbol,
+			SymbolPointer,
+			UdtField,
+			EnumField,
+		};
+
+		//
+		// Pointer stored in the file and what it points to - Count
+		// objects of the TargetKind (characters of a string including
+		// its terminator).  The targets are checked before the pointer
+		// is relocated.
+		//
+		struct CACHE_RELOCATION
+		{
+			ULONGLONG            PointerOffset;
+			CacheTarget          TargetKind;
+			DWORD                TargetCount;
+		};
+
+		//
+		// Result of GetSymbolByName() for each name.
+		//
+		struct CACHE_NAME_ENTRY
+		{
+			const CHAR*          Name;
+			SYMBOL*              Symbol;
+		};
+
+		class Writer;
+
+		//
+		// Determines the key of the PDB file and path
+		// of its cache file.
+		//
+		static
+		BOOL
+		GetCachePath(
+			IN const CHAR* CacheDirectory,
+			IN PDB::ReaderType Reader,
+			IN const CHAR* PdbPath,
+			OUT std::string& CachePath,
+			OUT CACHE_KEY& Key
+			);
+
+		BOOL
+		MapFile(
+			IN const CHAR* Path
+			);
+
+		VOID
+		UnmapFile();
+
+		static BOOL
+		GetTargetLayout(
+			IN CacheTarget TargetKind,
+			OUT size_t& ElementSize,
+			OUT size_t& Alignment
+			);
+
+		BOOL
+		Relocate();
+
+	private:
+		std::string          m_CacheDirectory;
+		PDB::ReaderType      m_Reader;
+
+		BYTE*                m_BaseAddress = nullptr;
+		size_t               m_FileSize = 0;
+
+#if defined(_WIN32)
+		HANDLE               m_FileHandle = INVALID_HANDLE_VALUE;
+		HANDLE               m_MappingHandle = nullptr;
+#endif
+
+		const CACHE_HEADER*     m_Header = nullptr;
+		const CACHE_NAME_ENTRY* m_NameIndex = nullptr;
+};
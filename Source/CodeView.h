@@ -0,0 +1,337 @@
+#pragma once
+#include "Platform.h"
+
+//
+// Subset of the CodeView type records (cvinfo.h)
+// needed for decoding the TPI stream.
+//
+
+//
+// Type indices below this value are not backed by any
+// type record - they describe the "simple" (built-in) types.
+//
+
+#define CV_FIRST_NONPRIMITIVE_TYPE_INDEX 0x1000
+
+#define CV_SIMPLE_TYPE_KIND(TypeIndex)   ((TypeIndex) & 0xff)
+#define CV_SIMPLE_TYPE_MODE(TypeIndex)   (((TypeIndex) >> 8) & 0x7)
+
+enum CV_SIMPLE_TYPE_MODE_E
+{
+	CV_TM_DIRECT = 0,  // not a pointer
+	CV_TM_NPTR   = 1,  // near pointer
+	CV_TM_FPTR   = 2,  // far pointer
+	CV_TM_HPTR   = 3,  // huge pointer
+	CV_TM_NPTR32 = 4,  // 32 bit near pointer
+	CV_TM_FPTR32 = 5,  // 32 bit far pointer
+	CV_TM_NPTR64 = 6,  // 64 bit near pointer
+	CV_TM_NPTR128 = 7, // 128 bit near pointer
+};
+
+enum CV_SIMPLE_TYPE_KIND_E
+{
+	CV_ST_NOTYPE  = 0x00,
+	CV_ST_VOID    = 0x03,
+	CV_ST_HRESULT = 0x08,
+	CV_ST_CHAR    = 0x10,
+	CV_ST_SHORT   = 0x11,
+	CV_ST_LONG    = 0x12,
+	CV_ST_QUAD    = 0x13,
+	CV_ST_OCT     = 0x14,
+	CV_ST_UCHAR   = 0x20,
+	CV_ST_USHORT  = 0x21,
+	CV_ST_ULONG   = 0x22,
+	CV_ST_UQUAD   = 0x23,
+	CV_ST_UOCT    = 0x24,
+	CV_ST_BOOL08  = 0x30,
+	CV_ST_BOOL16  = 0x31,
+	CV_ST_BOOL32  = 0x32,
+	CV_ST_BOOL64  = 0x33,
+	CV_ST_REAL32  = 0x40,
+	CV_ST_REAL64  = 0x41,
+	CV_ST_REAL80  = 0x42,
+	CV_ST_REAL128 = 0x43,
+	CV_ST_REAL16  = 0x46,
+	CV_ST_INT1    = 0x68,
+	CV_ST_UINT1   = 0x69,
+	CV_ST_RCHAR   = 0x70,
+	CV_ST_WCHAR   = 0x71,
+	CV_ST_INT2    = 0x72,
+	CV_ST_UINT2   = 0x73,
+	CV_ST_INT4    = 0x74,
+	CV_ST_UINT4   = 0x75,
+	CV_ST_INT8    = 0x76,
+	CV_ST_UINT8   = 0x77,
+	CV_ST_INT16   = 0x78,
+	CV_ST_UINT16  = 0x79,
+	CV_ST_CHAR16  = 0x7a,
+	CV_ST_CHAR32  = 0x7b,
+	CV_ST_CHAR8   = 0x7c,
+};
+
+enum CV_LEAF_E : WORD
+{
+	LF_MODIFIER    = 0x1001,
+	LF_POINTER     = 0x1002,
+	LF_PROCEDURE   = 0x1008,
+	LF_MFUNCTION   = 0x1009,
+	LF_ARGLIST     = 0x1201,
+	LF_FIELDLIST   = 0x1203,
+	LF_BITFIELD    = 0x1205,
+	LF_BCLASS      = 0x1400,
+	LF_VBCLASS     = 0x1401,
+	LF_IVBCLASS    = 0x1402,
+	LF_INDEX       = 0x1404,
+	LF_VFUNCTAB    = 0x1409,
+	LF_ENUMERATE   = 0x1502,
+	LF_ARRAY       = 0x1503,
+	LF_CLASS       = 0x1504,
+	LF_STRUCTURE   = 0x1505,
+	LF_UNION       = 0x1506,
+	LF_ENUM        = 0x1507,
+	LF_MEMBER      = 0x150d,
+	LF_STMEMBER    = 0x150e,
+	LF_METHOD      = 0x150f,
+	LF_NESTTYPE    = 0x1510,
+	LF_ONEMETHOD   = 0x1511,
+	LF_INTERFACE   = 0x1519,
+
+	//
+	// Numeric leaves.
+	//
+
+	LF_NUMERIC     = 0x8000,
+	LF_CHAR        = 0x8000,
+	LF_SHORT       = 0x8001,
+	LF_USHORT      = 0x8002,
+	LF_LONG        = 0x8003,
+	LF_ULONG       = 0x8004,
+	LF_QUADWORD    = 0x8009,
+	LF_UQUADWORD   = 0x800a,
+
+	//
+	// Padding of the field list members.
+	//
+
+	LF_PAD0        = 0xf0,
+};
+
+//
+// CV_prop_t
+//
+
+#define CV_PROP_FWDREF          0x0080
+#define CV_PROP_SCOPED          0x0100
+#define CV_PROP_HASUNIQUENAME   0x0200
+
+//
+// CV_modifier_t
+//
+
+#define CV_MODIFIER_CONST       0x0001
+#define CV_MODIFIER_VOLATILE    0x0002
+
+//
+// CV_ptrmode_e
+//
+
+#define CV_PTR_MODE_LVREF       0x01
+#define CV_PTR_MODE_RVREF       0x04
+
+//
+// CV_methodprop_e
+//
+
+#define CV_MTINTRO              0x04
+#define CV_MTPUREINTRO          0x06
+
+//
+// Symbol record kinds (of the symbol record stream).
+//
+
+#define S_PUB32                 0x110e
+
+//
+// CV_PUBSYMFLAGS
+//
+
+#define CV_PUBSYMFLAGS_FUNCTION 0x00000002
+
+#pragma pack(push, 1)
+
+struct TPI_STREAM_HEADER
+{
+	DWORD Version;
+	DWORD HeaderSize;
+	DWORD TypeIndexBegin;
+	DWORD TypeIndexEnd;
+	DWORD TypeRecordBytes;
+
+	WORD  HashStreamIndex;
+	WORD  HashAuxStreamIndex;
+	DWORD HashKeySize;
+	DWORD NumHashBuckets;
+
+	LONG  HashValueBufferOffset;
+	DWORD HashValueBufferLength;
+
+	LONG  IndexOffsetBufferOffset;
+	DWORD IndexOffsetBufferLength;
+
+	LONG  HashAdjBufferOffset;
+	DWORD HashAdjBufferLength;
+};
+
+//
+// Entry of the index-offset buffer in the TPI hash stream.
+//
+
+struct TPI_INDEX_OFFSET
+{
+	DWORD TypeIndex;
+	DWORD Offset;
+};
+
+//
+// Header of the PDB info stream.
+// Signature, Age and Guid identify the build the PDB belongs to.
+//
+
+struct PDB_INFO_STREAM_HEADER
+{
+	DWORD Version;
+	DWORD Signature;
+	DWORD Age;
+	BYTE  Guid[16];
+};
+
+struct DBI_STREAM_HEADER
+{
+	LONG  VersionSignature;
+	DWORD VersionHeader;
+	DWORD Age;
+	WORD  GlobalStreamIndex;
+	WORD  BuildNumber;
+	WORD  PublicStreamIndex;
+	WORD  PdbDllVersion;
+	WORD  SymRecordStream;
+	WORD  PdbDllRbld;
+	LONG  ModInfoSize;
+	LONG  SectionContributionSize;
+	LONG  SectionMapSize;
+	LONG  SourceInfoSize;
+	LONG  TypeServerMapSize;
+	DWORD MFCTypeServerIndex;
+	LONG  OptionalDbgHeaderSize;
+	LONG  ECSubstreamSize;
+	WORD  Flags;
+	WORD  Machine;
+	DWORD Padding;
+};
+
+//
+// Common prefix of all type records and symbol records.
+// Length does not include the Length field itself.
+//
+
+struct CV_RECORD_HEADER
+{
+	WORD  Length;
+	WORD  Kind;
+};
+
+struct CV_MODIFIER_RECORD
+{
+	DWORD ModifiedType;
+	WORD  Modifiers;
+};
+
+struct CV_POINTER_RECORD
+{
+	DWORD ReferentType;
+	DWORD Attributes;
+};
+
+struct CV_PROCEDURE_RECORD
+{
+	DWORD ReturnType;
+	BYTE  CallingConvention;
+	BYTE  FunctionAttributes;
+	WORD  ParameterCount;
+	DWORD ArgumentList;
+};
+
+struct CV_MFUNCTION_RECORD
+{
+	DWORD ReturnType;
+	DWORD ClassType;
+	DWORD ThisType;
+	BYTE  CallingConvention;
+	BYTE  FunctionAttributes;
+	WORD  ParameterCount;
+	DWORD ArgumentList;
+	LONG  ThisAdjustment;
+};
+
+struct CV_ARGLIST_RECORD
+{
+	DWORD Count;
+	DWORD Arguments[1];
+};
+
+struct CV_BITFIELD_RECORD
+{
+	DWORD Type;
+	BYTE  Length;
+	BYTE  Position;
+};
+
+struct CV_ARRAY_RECORD
+{
+	DWORD ElementType;
+	DWORD IndexType;
+	// numeric Size;
+	// char Name[];
+};
+
+struct CV_CLASS_RECORD
+{
+	WORD  Count;
+	WORD  Properties;
+	DWORD FieldList;
+	DWORD DerivedFrom;
+	DWORD VShape;
+	// numeric Size;
+	// char Name[];
+	// char UniqueName[];
+};
+
+struct CV_UNION_RECORD
+{
+	WORD  Count;
+	WORD  Properties;
+	DWORD FieldList;
+	// numeric Size;
+	// char Name[];
+	// char UniqueName[];
+};
+
+struct CV_ENUM_RECORD
+{
+	WORD  Count;
+	WORD  Properties;
+	DWORD UnderlyingType;
+	DWORD FieldList;
+	// char Name[];
+	// char UniqueName[];
+};
+
+struct CV_PUBSYM32_RECORD
+{
+	DWORD Flags;
+	DWORD Offset;
+	WORD  Segment;
+	// char Name[];
+};
+
+#pragma pack(pop)
@@ -0,0 +1,610 @@
+#include "DiaSymbolModule.h"
+#include "PDBCallback.h"
+
+#include <cassert>
+
+#include <string>
+#include <memory>
+
+DiaSymbolModule::DiaSymbolModule()
+{
+	HRESULT hr = CoInitialize(nullptr);
+
+	assert(hr == S_OK);
+}
+
+DiaSymbolModule::~DiaSymbolModule()
+{
+	Close();
+}
+
+HRESULT
+DiaSymbolModule::LoadDiaViaCoCreateInstance()
+{
+	return CoCreateInstance(
+		__uuidof(DiaSource),
+		nullptr,
+		CLSCTX_INPROC_SERVER,
+		__uuidof(IDiaDataSource),
+		(void**)& m_DataSource
+		);
+}
+
+HRESULT
+DiaSymbolModule::LoadDiaViaLoadLibrary()
+{
+	HRESULT Result;
+	HMODULE Module = LoadLibrary(TEXT("msdia140.dll"));
+
+	if (!Module)
+	{
+		Result = HRESULT_FROM_WIN32(GetLastError());
+		return Result;
+	}
+
+	using PDLLGETCLASSOBJECT_ROUTINE = HRESULT(WINAPI*)(REFCLSID, REFIID, LPVOID);
+	auto DllGetClassObject = reinterpret_cast<PDLLGETCLASSOBJECT_ROUTINE>(GetProcAddress(Module, "DllGetClassObject"));
+
+	if (!DllGetClassObject)
+	{
+		Result = HRESULT_FROM_WIN32(GetLastError());
+		return Result;
+	}
+
+	CComPtr<IClassFactory> ClassFactory;
+	Result = DllGetClassObject(__uuidof(DiaSource), __uuidof(IClassFactory), &ClassFactory);
+
+	if (FAILED(Result))
+	{
+		return Result;
+	}
+
+	return ClassFactory->CreateInstance(nullptr, __uuidof(IDiaDataSource), (void**)& m_DataSource);
+}
+
+BOOL
+DiaSymbolModule::OpenSession(
+	IN const CHAR* Path
+	)
+{
+	HRESULT   Result            = S_OK;
+	LPCOLESTR PDBSearchPath     = L"srv*.\\Symbols*https://msdl.microsoft.com/download/symbols";
+
+	//
+	// Load msdia140.dll.
+	// First try registered COM class, if it fails,
+	// do LoadLibrary() directly.
+	//
+
+	if (FAILED(Result = LoadDiaViaCoCreateInstance()) &&
+	    FAILED(Result = LoadDiaViaLoadLibrary()))
+	{
+		return FALSE;
+	}
+
+	//
+	// Convert Path to WCHAR string.
+	//
+
+	int PathUnicodeLength = MultiByteToWideChar(CP_UTF8, 0, Path, -1, NULL, 0);
+	auto PathUnicode       = std::make_unique<WCHAR[]>(PathUnicodeLength);
+	MultiByteToWideChar(CP_UTF8, 0, Path, -1, PathUnicode.get(), PathUnicodeLength);
+
+	//
+	// Parse the file extension.
+	//
+
+	WCHAR FileExtension[8] = { 0 };
+	_wsplitpath_s(
+		PathUnicode.get(),
+		nullptr,
+		0,
+		nullptr,
+		0,
+		nullptr,
+		0,
+		FileExtension,
+		_countof(FileExtension));
+
+	//
+	// If PDB file is specified, load it directly.
+	// Otherwise, try to find the corresponding PDB for
+	// the specified file (locally / symbol server).
+	//
+
+	if (_wcsicmp(FileExtension, L".pdb") == 0)
+	{
+		Result = m_DataSource->loadDataFromPdb(PathUnicode.get());
+	}
+	else
+	{
+		PDBCallback Callback;
+		Callback.AddRef();
+
+		Result = m_DataSource->loadDataForExe(PathUnicode.get(), PDBSearchPath, &Callback);
+	}
+
+	//
+	// Check if PDB is open.
+	//
+
+	if (FAILED(Result))
+	{
+		goto Error;
+	}
+
+	//
+	// Open DIA session.
+	//
+
+	Result = m_DataSource->openSession(&m_Session);
+
+	if (FAILED(Result))
+	{
+		goto Error;
+	}
+
+	//
+	// Get root symbol.
+	//
+
+	Result = m_Session->get_globalScope(&m_GlobalSymbol);
+
+	if (FAILED(Result))
+	{
+		goto Error;
+	}
+
+	return TRUE;
+
+Error:
+	CloseSession();
+	return FALSE;
+}
+
+VOID
+DiaSymbolModule::CloseSession()
+{
+	m_GlobalSymbol.Release();
+	m_Session.Release();
+	m_DataSource.Release();
+
+	CoUninitialize();
+}
+
+BOOL
+DiaSymbolModule::Open(
+	IN const CHAR* Path
+	)
+{
+	BOOL Result;
+
+	Result = OpenSession(Path);
+
+	if (Result == FALSE)
+	{
+		return FALSE;
+	}
+
+	m_Path = Path;
+
+	m_GlobalSymbol->get_machineType(&m_MachineType);
+
+	DWORD Language;
+	m_GlobalSymbol->get_language(&Language);
+	m_Language = static_cast<CV_CFL_LANG>(Language);
+
+	BuildSymbolMap();
+
+	return TRUE;
+}
+
+BOOL
+DiaSymbolModule::IsOpen() const
+{
+	return m_DataSource && m_Session && m_GlobalSymbol;
+}
+
+VOID
+DiaSymbolModule::Close()
+{
+	CloseSession();
+
+	SymbolModule::Close();
+}
+
+const CHAR*
+DiaSymbolModule::GetSymbolName(
+	IN IDiaSymbol* DiaSymbol
+	)
+{
+	BSTR SymbolNameBstr;
+
+	if (DiaSymbol->get_name(&SymbolNameBstr) != S_OK)
+	{
+		//
+		// Not all symbols have the name.
+		//
+
+		return nullptr;
+	}
+
+	//
+	// BSTR is essentially a wide char string.
+	// Since we work in multibyte character set,
+	// we need to convert it.
+	//
+	// The name is converted into the reused buffer and then
+	// stored in the string pool, so that repeated names
+	// are kept only once.
+	//
+
+	size_t SymbolNameLength;
+
+	SymbolNameLength = (size_t)SysStringLen(SymbolNameBstr) + 1;
+	m_NameBuffer.assign(SymbolNameLength, '\0');
+	wcstombs(m_NameBuffer.data(), SymbolNameBstr, SymbolNameLength - 1);
+
+	//
+	// BSTR is supposed to be freed by this call.
+	//
+
+	SysFreeString(SymbolNameBstr);
+
+	return m_StringPool.Intern(m_NameBuffer.data());
+}
+
+SYMBOL*
+DiaSymbolModule::GetSymbol(
+	IN IDiaSymbol* DiaSymbol
+	)
+{
+	DWORD TypeId;
+	DiaSymbol->get_symIndexId(&TypeId);
+
+	if (SYMBOL* Symbol = m_SymbolMap.Get(TypeId))
+	{
+		return Symbol;
+	}
+
+	SYMBOL* Symbol = CreateSymbol(TypeId);
+
+	InitSymbol(DiaSymbol, Symbol);
+
+	RegisterSymbolName(Symbol);
+
+	return Symbol;
+}
+
+VOID
+DiaSymbolModule::BuildSymbolMapFromEnumerator(
+	IN IDiaEnumSymbols* DiaSymbolEnumerator
+	)
+{
+	IDiaSymbol* Result;
+	ULONG FetchedSymbolCount = 0;
+
+	while (SUCCEEDED(DiaSymbolEnumerator->Next(1, &Result, &FetchedSymbolCount)) && (FetchedSymbolCount == 1))
+	{
+		CComPtr<IDiaSymbol> DiaChildSymbol(Result);
+
+		GetSymbol(DiaChildSymbol);
+	}
+}
+
+VOID
+DiaSymbolModule::BuildFunctionSetFromEnumerator(
+	IN IDiaEnumSymbols* DiaSymbolEnumerator
+	)
+{
+	IDiaSymbol* Result;
+	ULONG FetchedSymbolCount = 0;
+
+	while (SUCCEEDED(DiaSymbolEnumerator->Next(1, &Result, &FetchedSymbolCount)) && (FetchedSymbolCount == 1))
+	{
+		CComPtr<IDiaSymbol> DiaChildSymbol(Result);
+
+		BOOL IsFunction;
+		DiaChildSymbol->get_function(&IsFunction);
+
+		if (IsFunction)
+		{
+			const CHAR* FunctionName = GetSymbolName(DiaChildSymbol);
+
+			DWORD DwordResult;
+			DiaChildSymbol->get_symTag(&DwordResult);
+			// auto Tag = static_cast<enum SymTagEnum>(DwordResult);
+
+			m_FunctionSet.insert(FunctionName);
+		}
+	}
+}
+
+VOID
+DiaSymbolModule::BuildSymbolMap()
+{
+	if (CComPtr<IDiaEnumSymbols> DiaSymbolEnumerator;
+	    SUCCEEDED(m_GlobalSymbol->findChildren(SymTagPublicSymbol, nullptr, nsNone, &DiaSymbolEnumerator)))
+	{
+		BuildFunctionSetFromEnumerator(DiaSymbolEnumerator);
+	}
+
+	if (CComPtr<IDiaEnumSymbols> DiaSymbolEnumerator;
+	    SUCCEEDED(m_GlobalSymbol->findChildren(SymTagEnum, nullptr, nsNone, &DiaSymbolEnumerator)))
+	{
+		BuildSymbolMapFromEnumerator(DiaSymbolEnumerator);
+	}
+
+	if (CComPtr<IDiaEnumSymbols> DiaSymbolEnumerator;
+	    SUCCEEDED(m_GlobalSymbol->findChildren(SymTagUDT, nullptr, nsNone, &DiaSymbolEnumerator)))
+	{
+		BuildSymbolMapFromEnumerator(DiaSymbolEnumerator);
+	}
+}
+
+VOID
+DiaSymbolModule::InitSymbol(
+	IN IDiaSymbol* DiaSymbol,
+	IN SYMBOL* Symbol
+	)
+{
+	DWORD DwordResult;
+	ULONGLONG UlonglongResult;
+	BOOL BoolResult;
+
+	DiaSymbol->get_symTag(&DwordResult);
+	Symbol->Tag = static_cast<enum SymTagEnum>(DwordResult);
+
+	DiaSymbol->get_dataKind(&DwordResult);
+	Symbol->DataKind = static_cast<enum DataKind>(DwordResult);
+
+	DiaSymbol->get_baseType(&DwordResult);
+	Symbol->BaseType = static_cast<BasicType>(DwordResult);
+
+	DiaSymbol->get_typeId(&DwordResult);
+	Symbol->TypeId = DwordResult;
+
+	DiaSymbol->get_length(&UlonglongResult);
+	Symbol->Size = static_cast<DWORD>(UlonglongResult);
+
+	DiaSymbol->get_constType(&BoolResult);
+	Symbol->IsConst = static_cast<BOOL>(BoolResult);
+
+	DiaSymbol->get_volatileType(&BoolResult);
+	Symbol->IsVolatile = static_cast<BOOL>(BoolResult);
+
+	Symbol->Name = GetSymbolName(DiaSymbol);
+
+	switch (Symbol->Tag)
+	{
+		case SymTagUDT:             ProcessSymbolUdt        (DiaSymbol, Symbol); break;
+		case SymTagEnum:            ProcessSymbolEnum       (DiaSymbol, Symbol); break;
+		case SymTagFunctionType:    ProcessSymbolFunction   (DiaSymbol, Symbol); break;
+		case SymTagPointerType:     ProcessSymbolPointer    (DiaSymbol, Symbol); break;
+		case SymTagArrayType:       ProcessSymbolArray      (DiaSymbol, Symbol); break;
+		case SymTagBaseType:        ProcessSymbolBase       (DiaSymbol, Symbol); break;
+		case SymTagTypedef:         ProcessSymbolTypedef    (DiaSymbol, Symbol); break;
+		case SymTagFunctionArgType: ProcessSymbolFunctionArg(DiaSymbol, Symbol); break;
+		default:                                                                 break;
+	}
+}
+
+VOID
+DiaSymbolModule::ProcessSymbolBase(
+	IN IDiaSymbol* DiaSymbol,
+	IN SYMBOL* Symbol
+	)
+{
+
+}
+
+VOID
+DiaSymbolModule::ProcessSymbolEnum(
+	IN IDiaSymbol* DiaSymbol,
+	IN SYMBOL* Symbol
+	)
+{
+	CComPtr<IDiaEnumSymbols> DiaSymbolEnumerator;
+
+	if (FAILED(DiaSymbol->findChildren(SymTagNull, nullptr, nsNone, &DiaSymbolEnumerator)))
+	{
+		return;
+	}
+
+	LONG ChildCount;
+	DiaSymbolEnumerator->get_Count(&ChildCount);
+
+	Symbol->u.Enum.FieldCount = static_cast<DWORD>(ChildCount);
+	Symbol->u.Enum.Fields = m_Arena.Allocate<SYMBOL_ENUM_FIELD>(ChildCount);
+
+	IDiaSymbol* Result;
+	ULONG FetchedSymbolCount = 0;
+	DWORD Index = 0;
+
+	while (SUCCEEDED(DiaSymbolEnumerator->Next(1, &Result, &FetchedSymbolCount)) && (FetchedSymbolCount == 1))
+	{
+		CComPtr<IDiaSymbol> DiaChildSymbol(Result);
+
+		SYMBOL_ENUM_FIELD* EnumValue = &Symbol->u.Enum.Fields[Index];
+
+		EnumValue->Parent = Symbol;
+		EnumValue->Name = GetSymbolName(DiaChildSymbol);
+
+		VariantInit(&EnumValue->Value);
+		DiaChildSymbol->get_value(&EnumValue->Value);
+
+		Index += 1;
+	}
+}
+
+VOID
+DiaSymbolModule::ProcessSymbolTypedef(
+	IN IDiaSymbol* DiaSymbol,
+	IN SYMBOL* Symbol
+	)
+{
+	CComPtr<IDiaSymbol> DiaTypedefSymbol;
+
+	DiaSymbol->get_type(&DiaTypedefSymbol);
+
+	Symbol->u.Typedef.Type = GetSymbol(DiaTypedefSymbol);
+}
+
+VOID
+DiaSymbolModule::ProcessSymbolPointer(
+	IN IDiaSymbol* DiaSymbol,
+	IN SYMBOL* Symbol
+	)
+{
+	CComPtr<IDiaSymbol> DiaPointerSymbol;
+
+	DiaSymbol->get_type(&DiaPointerSymbol);
+	DiaSymbol->get_reference(&Symbol->u.Pointer.IsReference);
+
+	Symbol->u.Pointer.Type = GetSymbol(DiaPointerSymbol);
+
+	GuessMachineType(Symbol);
+}
+
+VOID
+DiaSymbolModule::ProcessSymbolArray(
+	IN IDiaSymbol* DiaSymbol,
+	IN SYMBOL* Symbol
+	)
+{
+	CComPtr<IDiaSymbol> DiaDataTypeSymbol;
+
+	DiaSymbol->get_type(&DiaDataTypeSymbol);
+	Symbol->u.Array.ElementType = GetSymbol(DiaDataTypeSymbol);
+
+	DiaSymbol->get_count(&Symbol->u.Array.ElementCount);
+}
+
+VOID
+DiaSymbolModule::ProcessSymbolFunction(
+	IN IDiaSymbol* DiaSymbol,
+	IN SYMBOL* Symbol
+	)
+{
+	//
+	// Calling convention.
+	//
+
+	DWORD CallingConvention;
+	DiaSymbol->get_callingConvention(&CallingConvention);
+
+	Symbol->u.Function.CallingConvention = static_cast<CV_call_e>(CallingConvention);
+
+	//
+	// Return type.
+	//
+
+	CComPtr<IDiaSymbol> DiaReturnTypeSymbol;
+	DiaSymbol->get_type(&DiaReturnTypeSymbol);
+	Symbol->u.Function.ReturnType = GetSymbol(DiaReturnTypeSymbol);
+
+	//
+	// Arguments.
+	//
+
+	CComPtr<IDiaEnumSymbols> DiaSymbolEnumerator;
+
+	if (FAILED(DiaSymbol->findChildren(SymTagNull, nullptr, nsNone, &DiaSymbolEnumerator)))
+	{
+		return;
+	}
+
+	LONG ChildCount;
+
+	DiaSymbolEnumerator->get_Count(&ChildCount);
+
+	Symbol->u.Function.ArgumentCount = static_cast<DWORD>(ChildCount);
+	Symbol->u.Function.Arguments = m_Arena.Allocate<SYMBOL*>(ChildCount);
+
+	IDiaSymbol* Result;
+	ULONG FetchedSymbolCount = 0;
+	DWORD Index = 0;
+
+	while (SUCCEEDED(DiaSymbolEnumerator->Next(1, &Result, &FetchedSymbolCount)) && (FetchedSymbolCount == 1))
+	{
+		CComPtr<IDiaSymbol> DiaChildSymbol(Result);
+
+		SYMBOL* Argument;
+		Argument = GetSymbol(DiaChildSymbol);
+		Symbol->u.Function.Arguments[Index] = Argument;
+
+		Index += 1;
+	}
+}
+
+VOID
+DiaSymbolModule::ProcessSymbolFunctionArg(
+	IN IDiaSymbol* DiaSymbol,
+	IN SYMBOL* Symbol
+	)
+{
+	CComPtr<IDiaSymbol> DiaArgumentTypeSymbol;
+
+	DiaSymbol->get_type(&DiaArgumentTypeSymbol);
+	Symbol->u.FunctionArg.Type = GetSymbol(DiaArgumentTypeSymbol);
+}
+
+VOID
+DiaSymbolModule::ProcessSymbolUdt(
+	IN IDiaSymbol* DiaSymbol,
+	IN SYMBOL* Symbol
+	)
+{
+	DWORD Kind;
+	DiaSymbol->get_udtKind(&Kind);
+	Symbol->u.Udt.Kind = static_cast<UdtKind>(Kind);
+
+	CComPtr<IDiaEnumSymbols> DiaSymbolEnumerator;
+
+	if (FAILED(DiaSymbol->findChildren(SymTagData, nullptr, nsNone, &DiaSymbolEnumerator)))
+	{
+		return;
+	}
+
+	LONG ChildCount;
+
+	DiaSymbolEnumerator->get_Count(&ChildCount);
+
+	Symbol->u.Udt.FieldCount = static_cast<DWORD>(ChildCount);
+	Symbol->u.Udt.Fields = m_Arena.Allocate<SYMBOL_UDT_FIELD>(ChildCount + 1);
+
+	IDiaSymbol* Result;
+	ULONG FetchedSymbolCount = 0;
+	DWORD Index = 0;
+
+	while (SUCCEEDED(DiaSymbolEnumerator->Next(1, &Result, &FetchedSymbolCount)) && (FetchedSymbolCount == 1))
+	{
+		CComPtr<IDiaSymbol> DiaChildSymbol(Result);
+
+		SYMBOL_UDT_FIELD* Member = &Symbol->u.Udt.Fields[Index];
+
+		Member->Name = GetSymbolName(DiaChildSymbol);
+		Member->Parent = Symbol;
+
+		LONG Offset = 0;
+		DiaChildSymbol->get_offset(&Offset);
+		Member->Offset = static_cast<DWORD>(Offset);
+
+		ULONGLONG Bits = 0;
+		DiaChildSymbol->get_length(&Bits);
+		Member->Bits = static_cast<DWORD>(Bits);
+
+		DiaChildSymbol->get_bitPosition(&Member->BitPosition);
+
+		CComPtr<IDiaSymbol> MemberTypeDiaSymbol;
+		DiaChildSymbol->get_type(&MemberTypeDiaSymbol);
+		Member->Type = GetSymbol(MemberTypeDiaSymbol);
+
+		Index += 1;
+	}
+
+	//
+	// Padding.
+	//
+	CreatePaddingMember(Symbol);
+}
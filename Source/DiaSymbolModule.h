@@ -0,0 +1,132 @@
+#pragma once
+#include "SymbolModule.h"
+
+#include <dia2.h>       // IDia* interfaces
+#include <atlcomcli.h>
+
+#include <vector>
+
+//
+// PDB reader backed by the msdia140.dll.
+//
+// Besides the PDB files, it can also load PDBs for the executables
+// (locally or from the symbol server).
+//
+class DiaSymbolModule
+	: public SymbolModule
+{
+	public:
+		DiaSymbolModule();
+
+		~DiaSymbolModule();
+
+		BOOL
+		Open(
+			IN const CHAR* Path
+			) override;
+
+		BOOL
+		IsOpen() const override;
+
+		VOID
+		Close() override;
+
+	private:
+		HRESULT
+		LoadDiaViaCoCreateInstance();
+
+		HRESULT
+		LoadDiaViaLoadLibrary();
+
+		BOOL
+		OpenSession(
+			IN const CHAR* Path
+			);
+
+		VOID
+		CloseSession();
+
+		SYMBOL*
+		GetSymbol(
+			IN IDiaSymbol* DiaSymbol
+			);
+
+		const CHAR*
+		GetSymbolName(
+			IN IDiaSymbol* DiaSymbol
+			);
+
+		VOID
+		BuildSymbolMapFromEnumerator(
+			IN IDiaEnumSymbols* DiaSymbolEnumerator
+			);
+
+		VOID
+		BuildFunctionSetFromEnumerator(
+			IN IDiaEnumSymbols* DiaSymbolEnumerator
+			);
+
+		VOID
+		BuildSymbolMap();
+
+		VOID
+		InitSymbol(
+			IN IDiaSymbol* DiaSymbol,
+			IN SYMBOL* Symbol
+			);
+
+		VOID
+		ProcessSymbolBase(
+			IN IDiaSymbol* DiaSymbol,
+			IN SYMBOL* Symbol
+			);
+
+		VOID
+		ProcessSymbolEnum(
+			IN IDiaSymbol* DiaSymbol,
+			IN SYMBOL* Symbol
+			);
+
+		VOID
+		ProcessSymbolTypedef(
+			IN IDiaSymbol* DiaSymbol,
+			IN SYMBOL* Symbol
+			);
+
+		VOID
+		ProcessSymbolPointer(
+			IN IDiaSymbol* DiaSymbol,
+			IN SYMBOL* Symbol
+			);
+
+		VOID
+		ProcessSymbolArray(
+			IN IDiaSymbol* DiaSymbol,
+			IN SYMBOL* Symbol
+			);
+
+		VOID
+		ProcessSymbolFunction(
+			IN IDiaSymbol* DiaSymbol,
+			IN SYMBOL* Symbol
+			);
+
+		VOID
+		ProcessSymbolFunctionArg(
+			IN IDiaSymbol* DiaSymbol,
+			IN SYMBOL* Symbol
+			);
+
+		VOID
+		ProcessSymbolUdt(
+			IN IDiaSymbol* DiaSymbol,
+			IN SYMBOL* Symbol
+			);
+
+	private:
+		CComPtr<IDiaDataSource> m_DataSource;
+		CComPtr<IDiaSession>    m_Session;
+		CComPtr<IDiaSymbol>     m_GlobalSymbol;
+
+		std::vector<CHAR>       m_NameBuffer;
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include "Platform.h"
+
+#include <cstring>
+#include <string>
+
+//
+// Append-only string with an inline buffer.
+//
+// Pieces of the member definitions are short, they fit into
+// the inline buffer without touching the heap.  Longer strings spill
+// into the std::string, which keeps its capacity over Clear(),
+// so a reused object doesn't allocate again.
+//
+template <
+	size_t CAPACITY
+>
+class InlineString
+{
+	public:
+		VOID
+		Clear()
+		{
+			m_Length = 0;
+			m_Spill.clear();
+		}
+
+		VOID
+		Append(
+			IN const CHAR* String,
+			IN size_t Length
+			)
+		{
+			if (m_Spill.empty() && m_Length + Length <= CAPACITY)
+			{
+				memcpy(&m_Buffer[m_Length], String, Length);
+				m_Length += Length;
+			}
+			else
+			{
+				if (m_Spill.empty())
+				{
+					m_Spill.assign(m_Buffer, m_Length);
+				}
+
+				m_Spill.append(String, Length);
+			}
+		}
+
+		VOID
+		Append(
+			IN const CHAR* String
+			)
+		{
+			Append(String, strlen(String));
+		}
+
+		//
+		// Same as Append(std::to_string(Value)).
+		//
+		VOID
+		AppendDecimal(
+			IN ULONGLONG Value
+			)
+		{
+			CHAR Digits[24];
+			CHAR* Begin = &Digits[sizeof(Digits)];
+
+			do
+			{
+				*--Begin = static_cast<CHAR>('0' + Value % 10);
+				Value /= 10;
+			} while (Value != 0);
+
+			Append(Begin, &Digits[sizeof(Digits)] - Begin);
+		}
+
+		const CHAR*
+		GetData() const
+		{
+			return m_Spill.empty() ? m_Buffer : m_Spill.data();
+		}
+
+		size_t
+		GetLength() const
+		{
+			return m_Spill.empty() ? m_Length : m_Spill.size();
+		}
+
+	private:
+		CHAR        m_Buffer[CAPACITY];
+		size_t      m_Length = 0;
+		std::string m_Spill;
+};
@@ -0,0 +1,406 @@
+#include "MSF.h"
+
+#include <cstring>
+
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+	//
+	// Magic at the very beginning of the MSF 7.00 file.
+	//
+
+	static const char MSF_MAGIC[] =
+		"Microsoft C/C++ MSF 7.00\r\n\x1a" "DS\0\0";
+
+	static const DWORD MSF_NIL_STREAM_SIZE = 0xFFFFFFFF;
+
+#pragma pack(push, 1)
+	struct MSF_SUPERBLOCK
+	{
+		CHAR  FileMagic[32];
+		DWORD BlockSize;
+		DWORD FreeBlockMapBlock;
+		DWORD NumBlocks;
+		DWORD NumDirectoryBytes;
+		DWORD Unknown;
+		DWORD BlockMapAddr;
+	};
+#pragma pack(pop)
+}
+
+MSFFile::MSFFile()
+{
+
+}
+
+MSFFile::~MSFFile()
+{
+	Close();
+}
+
+BOOL
+MSFFile::Open(
+	IN const CHAR* Path
+	)
+{
+	if (!MapFile(Path))
+	{
+		return FALSE;
+	}
+
+	if (!ParseStreamDirectory())
+	{
+		Close();
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+VOID
+MSFFile::Close()
+{
+	UnmapFile();
+
+	m_BlockSize = 0;
+	m_BlockCount = 0;
+
+	m_StreamSizes.clear();
+	m_StreamFirstBlock.clear();
+	m_StreamBlocks.clear();
+}
+
+BOOL
+MSFFile::IsOpen() const
+{
+	return m_BaseAddress != nullptr;
+}
+
+DWORD
+MSFFile::GetStreamCount() const
+{
+	return static_cast<DWORD>(m_StreamSizes.size());
+}
+
+DWORD
+MSFFile::GetStreamSize(
+	IN DWORD StreamIndex
+	) const
+{
+	return StreamIndex < m_StreamSizes.size()
+		? m_StreamSizes[StreamIndex]
+		: 0;
+}
+
+BOOL
+MSFFile::ReadStream(
+	IN DWORD StreamIndex,
+	OUT MSFStream& Stream
+	) const
+{
+	Stream.Data = nullptr;
+	Stream.Size = 0;
+	Stream.Buffer.clear();
+
+	if (StreamIndex >= m_StreamSizes.size())
+	{
+		return FALSE;
+	}
+
+	return ReadBlocks(
+		&m_StreamBlocks[m_StreamFirstBlock[StreamIndex]],
+		m_StreamSizes[StreamIndex],
+		Stream
+		);
+}
+
+BOOL
+MSFFile::MapFile(
+	IN const CHAR* Path
+	)
+{
+#if defined(_WIN32)
+	m_FileHandle = CreateFileA(
+		Path,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr
+		);
+
+	if (m_FileHandle == INVALID_HANDLE_VALUE)
+	{
+		return FALSE;
+	}
+
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(m_FileHandle, &FileSize) || FileSize.QuadPart == 0)
+	{
+		UnmapFile();
+		return FALSE;
+	}
+
+	m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (m_MappingHandle == nullptr)
+	{
+		UnmapFile();
+		return FALSE;
+	}
+
+	m_BaseAddress = static_cast<const BYTE*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	m_FileSize = static_cast<size_t>(FileSize.QuadPart);
+#else
+	int FileDescriptor = open(Path, O_RDONLY);
+
+	if (FileDescriptor == -1)
+	{
+		return FALSE;
+	}
+
+	struct stat FileStat;
+	if (fstat(FileDescriptor, &FileStat) != 0 || FileStat.st_size == 0)
+	{
+		close(FileDescriptor);
+		return FALSE;
+	}
+
+	void* BaseAddress = mmap(nullptr, FileStat.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+
+	//
+	// The mapping holds its own reference to the file.
+	//
+
+	close(FileDescriptor);
+
+	if (BaseAddress == MAP_FAILED)
+	{
+		return FALSE;
+	}
+
+	m_BaseAddress = static_cast<const BYTE*>(BaseAddress);
+	m_FileSize = static_cast<size_t>(FileStat.st_size);
+#endif
+
+	if (m_BaseAddress == nullptr)
+	{
+		UnmapFile();
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+VOID
+MSFFile::UnmapFile()
+{
+#if defined(_WIN32)
+	if (m_BaseAddress != nullptr)
+	{
+		UnmapViewOfFile(m_BaseAddress);
+	}
+
+	if (m_MappingHandle != nullptr)
+	{
+		CloseHandle(m_MappingHandle);
+		m_MappingHandle = nullptr;
+	}
+
+	if (m_FileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_FileHandle);
+		m_FileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_BaseAddress != nullptr)
+	{
+		munmap(const_cast<BYTE*>(m_BaseAddress), m_FileSize);
+	}
+#endif
+
+	m_BaseAddress = nullptr;
+	m_FileSize = 0;
+}
+
+BOOL
+MSFFile::ParseStreamDirectory()
+{
+	//
+	// Validate the superblock.
+	//
+
+	if (m_FileSize < sizeof(MSF_SUPERBLOCK))
+	{
+		return FALSE;
+	}
+
+	const MSF_SUPERBLOCK* SuperBlock = reinterpret_cast<const MSF_SUPERBLOCK*>(m_BaseAddress);
+
+	if (memcmp(SuperBlock->FileMagic, MSF_MAGIC, sizeof(SuperBlock->FileMagic)) != 0)
+	{
+		return FALSE;
+	}
+
+	switch (SuperBlock->BlockSize)
+	{
+		case 512:
+		case 1024:
+		case 2048:
+		case 4096:
+			break;
+
+		default:
+			return FALSE;
+	}
+
+	m_BlockSize = SuperBlock->BlockSize;
+	m_BlockCount = SuperBlock->NumBlocks;
+
+	if (static_cast<ULONGLONG>(m_BlockSize) * m_BlockCount > m_FileSize)
+	{
+		return FALSE;
+	}
+
+	//
+	// The block at BlockMapAddr holds the list of blocks
+	// the stream directory is stored in.
+	//
+
+	DWORD DirectoryBlockCount = (SuperBlock->NumDirectoryBytes + m_BlockSize - 1) / m_BlockSize;
+
+	if (SuperBlock->BlockMapAddr >= m_BlockCount ||
+	    DirectoryBlockCount * sizeof(DWORD) > m_BlockSize)
+	{
+		return FALSE;
+	}
+
+	const DWORD* DirectoryBlocks = reinterpret_cast<const DWORD*>(
+		m_BaseAddress + static_cast<size_t>(SuperBlock->BlockMapAddr) * m_BlockSize
+		);
+
+	MSFStream Directory;
+	if (!ReadBlocks(DirectoryBlocks, SuperBlock->NumDirectoryBytes, Directory))
+	{
+		return FALSE;
+	}
+
+	//
+	// Stream directory layout:
+	//
+	// DWORD NumStreams;
+	// DWORD StreamSizes[NumStreams];
+	// DWORD StreamBlocks[NumStreams][];
+	//
+
+	const DWORD* DirectoryData = reinterpret_cast<const DWORD*>(Directory.Data);
+	DWORD DirectoryDwordCount = Directory.Size / sizeof(DWORD);
+
+	if (DirectoryDwordCount < 1 || DirectoryData[0] > DirectoryDwordCount - 1)
+	{
+		return FALSE;
+	}
+
+	DWORD StreamCount = DirectoryData[0];
+	const DWORD* StreamSizes = &DirectoryData[1];
+	const DWORD* StreamBlocks = &DirectoryData[1 + StreamCount];
+	const DWORD* EndOfDirectory = &DirectoryData[DirectoryDwordCount];
+
+	m_StreamSizes.resize(StreamCount);
+	m_StreamFirstBlock.resize(StreamCount);
+
+	for (DWORD StreamIndex = 0; StreamIndex < StreamCount; StreamIndex++)
+	{
+		DWORD StreamSize = StreamSizes[StreamIndex] == MSF_NIL_STREAM_SIZE
+			? 0
+			: StreamSizes[StreamIndex];
+
+		DWORD StreamBlockCount = (StreamSize + m_BlockSize - 1) / m_BlockSize;
+
+		if (StreamBlocks + StreamBlockCount > EndOfDirectory)
+		{
+			return FALSE;
+		}
+
+		m_StreamSizes[StreamIndex] = StreamSize;
+		m_StreamFirstBlock[StreamIndex] = static_cast<DWORD>(m_StreamBlocks.size());
+		m_StreamBlocks.insert(m_StreamBlocks.end(), StreamBlocks, StreamBlocks + StreamBlockCount);
+
+		StreamBlocks += StreamBlockCount;
+	}
+
+	//
+	// Sentinel, so that even empty streams have
+	// a valid pointer into the m_StreamBlocks.
+	//
+
+	m_StreamBlocks.push_back(0);
+
+	return TRUE;
+}
+
+BOOL
+MSFFile::ReadBlocks(
+	IN const DWORD* BlockIndices,
+	IN DWORD Size,
+	OUT MSFStream& Stream
+	) const
+{
+	DWORD BlockCount = (Size + m_BlockSize - 1) / m_BlockSize;
+	BOOL IsContiguous = TRUE;
+
+	for (DWORD i = 0; i < BlockCount; i++)
+	{
+		if (BlockIndices[i] >= m_BlockCount)
+		{
+			return FALSE;
+		}
+
+		if (i > 0 && BlockIndices[i] != BlockIndices[i - 1] + 1)
+		{
+			IsContiguous = FALSE;
+		}
+	}
+
+	Stream.Size = Size;
+
+	if (BlockCount == 0)
+	{
+		Stream.Data = m_BaseAddress;
+		return TRUE;
+	}
+
+	if (IsContiguous)
+	{
+		//
+		// Fast path - serve the stream directly from the mapping.
+		//
+
+		Stream.Data = m_BaseAddress + static_cast<size_t>(BlockIndices[0]) * m_BlockSize;
+		return TRUE;
+	}
+
+	Stream.Buffer.resize(Size);
+
+	for (DWORD i = 0; i < BlockCount; i++)
+	{
+		DWORD Offset = i * m_BlockSize;
+		DWORD Length = Size - Offset < m_BlockSize ? Size - Offset : m_BlockSize;
+
+		memcpy(
+			&Stream.Buffer[Offset],
+			m_BaseAddress + static_cast<size_t>(BlockIndices[i]) * m_BlockSize,
+			Length
+			);
+	}
+
+	Stream.Data = Stream.Buffer.data();
+	return TRUE;
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include "Platform.h"
+
+#include <vector>
+
+//
+// Well-known stream indices of the PDB file.
+//
+enum MSFStreamIndex : DWORD
+{
+	MSFStreamOldDirectory = 0,
+	MSFStreamPdbInfo      = 1,
+	MSFStreamTpi          = 2,
+	MSFStreamDbi          = 3,
+	MSFStreamIpi          = 4,
+
+	MSFStreamInvalid      = 0xFFFF,
+};
+
+//
+// Content of a single MSF stream.
+//
+// If all blocks of the stream are laid out contiguously
+// in the file, Data points directly into the mapped file.
+// Otherwise the blocks are gathered into the Buffer
+// and Data points to the Buffer.
+//
+struct MSFStream
+{
+	const BYTE*          Data = nullptr;
+	DWORD                Size = 0;
+	std::vector<BYTE>    Buffer;
+};
+
+//
+// Read-only view of the MSF (multi-stream file) container,
+// which is the physical format of the PDB files.
+//
+// The whole file is memory-mapped, the superblock and the stream
+// directory are parsed on Open().  Content of the particular streams
+// is then served straight out of the mapping whenever possible.
+//
+class MSFFile
+{
+	public:
+		MSFFile();
+
+		~MSFFile();
+
+		//
+		// Maps the file and parses the stream directory.
+		//
+		// Returns non-zero value on success.
+		//
+		BOOL
+		Open(
+			IN const CHAR* Path
+			);
+
+		//
+		// Unmaps the file.
+		//
+		VOID
+		Close();
+
+		BOOL
+		IsOpen() const;
+
+		//
+		// Returns number of streams in the stream directory.
+		//
+		DWORD
+		GetStreamCount() const;
+
+		//
+		// Returns size of the stream in bytes.
+		// Non-existent streams have size of 0.
+		//
+		DWORD
+		GetStreamSize(
+			IN DWORD StreamIndex
+			) const;
+
+		//
+		// Provides content of the whole stream.
+		//
+		// Returns non-zero value on success.
+		//
+		BOOL
+		ReadStream(
+			IN DWORD StreamIndex,
+			OUT MSFStream& Stream
+			) const;
+
+	private:
+		BOOL
+		MapFile(
+			IN const CHAR* Path
+			);
+
+		VOID
+		UnmapFile();
+
+		BOOL
+		ParseStreamDirectory();
+
+		BOOL
+		ReadBlocks(
+			IN const DWORD* BlockIndices,
+			IN DWORD Size,
+			OUT MSFStream& Stream
+			) const;
+
+	private:
+		const BYTE*          m_BaseAddress = nullptr;
+		size_t               m_FileSize = 0;
+
+#if defined(_WIN32)
+		HANDLE               m_FileHandle = INVALID_HANDLE_VALUE;
+		HANDLE               m_MappingHandle = nullptr;
+#endif
+
+		DWORD                m_BlockSize = 0;
+		DWORD                m_BlockCount = 0;
+
+		//
+		// Size of each stream and index of its first block
+		// in the m_StreamBlocks array.
+		//
+		std::vector<DWORD>   m_StreamSizes;
+		std::vector<DWORD>   m_StreamFirstBlock;
+
+		//
+		// Concatenated block lists of all streams.
+		//
+		std::vector<DWORD>   m_StreamBlocks;
+};
@@ -0,0 +1,2234 @@
+#include "NativeSymbolModule.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	//
+	// Helpers for reading the (possibly unaligned) fields
+	// of the CodeView records.  All of them advance the Data pointer
+	// and return FALSE if the read would cross the End.
+	//
+
+	template <
+		typename T
+	>
+	BOOL
+	ReadValue(
+		const BYTE*& Data,
+		const BYTE* End,
+		T& Value
+		)
+	{
+		if (End - Data < static_cast<ptrdiff_t>(sizeof(T)))
+		{
+			return FALSE;
+		}
+
+		memcpy(&Value, Data, sizeof(T));
+		Data += sizeof(T);
+
+		return TRUE;
+	}
+
+	template <
+		typename T
+	>
+	BOOL
+	ReadNumericValue(
+		const BYTE*& Data,
+		const BYTE* End,
+		LONGLONG& Value
+		)
+	{
+		T NumericValue;
+
+		if (!ReadValue(Data, End, NumericValue))
+		{
+			return FALSE;
+		}
+
+		Value = static_cast<LONGLONG>(NumericValue);
+		return TRUE;
+	}
+
+	BOOL
+	ReadNumeric(
+		const BYTE*& Data,
+		const BYTE* End,
+		LONGLONG& Value
+		)
+	{
+		WORD Leaf;
+
+		if (!ReadValue(Data, End, Leaf))
+		{
+			return FALSE;
+		}
+
+		if (Leaf < LF_NUMERIC)
+		{
+			//
+			// Small values are stored directly in the leaf.
+			//
+
+			Value = Leaf;
+			return TRUE;
+		}
+
+		switch (Leaf)
+		{
+			case LF_CHAR:       return ReadNumericValue<int8_t>  (Data, End, Value);
+			case LF_SHORT:      return ReadNumericValue<int16_t> (Data, End, Value);
+			case LF_USHORT:     return ReadNumericValue<uint16_t>(Data, End, Value);
+			case LF_LONG:       return ReadNumericValue<int32_t> (Data, End, Value);
+			case LF_ULONG:      return ReadNumericValue<uint32_t>(Data, End, Value);
+			case LF_QUADWORD:   return ReadNumericValue<int64_t> (Data, End, Value);
+			case LF_UQUADWORD:  return ReadNumericValue<uint64_t>(Data, End, Value);
+			default:            return FALSE;
+		}
+	}
+
+	BOOL
+	ReadName(
+		const BYTE*& Data,
+		const BYTE* End,
+		const CHAR*& Name
+		)
+	{
+		if (Data >= End)
+		{
+			return FALSE;
+		}
+
+		auto Terminator = static_cast<const BYTE*>(memchr(Data, 0, End - Data));
+
+		if (Terminator == nullptr)
+		{
+			return FALSE;
+		}
+
+		Name = reinterpret_cast<const CHAR*>(Data);
+		Data = Terminator + 1;
+
+		return TRUE;
+	}
+
+	VOID
+	SkipPadding(
+		const BYTE*& Data,
+		const BYTE* End
+		)
+	{
+		while (Data < End && *Data >= LF_PAD0)
+		{
+			Data += 1;
+		}
+	}
+
+	const BYTE*
+	GetRecordData(
+		const CV_RECORD_HEADER* Record
+		)
+	{
+		return reinterpret_cast<const BYTE*>(Record + 1);
+	}
+
+	const BYTE*
+	GetRecordEnd(
+		const CV_RECORD_HEADER* Record
+		)
+	{
+		return reinterpret_cast<const BYTE*>(Record) + sizeof(Record->Length) + Record->Length;
+	}
+
+	//
+	// Hash function used for the names of UDTs and enums
+	// in the TPI hash stream (hashStringV1 in LLVM).
+	//
+
+	DWORD
+	HashStringV1(
+		const CHAR* String
+		)
+	{
+		auto Data = reinterpret_cast<const BYTE*>(String);
+		size_t Length = strlen(String);
+
+		DWORD Result = 0;
+
+		for (; Length >= 4; Length -= 4, Data += 4)
+		{
+			DWORD Value;
+			memcpy(&Value, Data, sizeof(Value));
+			Result ^= Value;
+		}
+
+		if (Length >= 2)
+		{
+			WORD Value;
+			memcpy(&Value, Data, sizeof(Value));
+			Result ^= Value;
+
+			Length -= 2;
+			Data += 2;
+		}
+
+		if (Length == 1)
+		{
+			Result ^= *Data;
+		}
+
+		Result |= 0x20202020;
+		Result ^= (Result >> 11);
+
+		return Result ^ (Result >> 16);
+	}
+
+	//
+	// Terminator of the hash bucket chains.
+	//
+
+	static const DWORD HASH_BUCKET_END = 0xFFFFFFFF;
+
+	//
+	// Largest number of the hash buckets allowed by the format.
+	//
+
+	static const DWORD MAX_HASH_BUCKET_COUNT = 0x40000;
+
+	//
+	// Decoded LF_CLASS, LF_STRUCTURE, LF_INTERFACE,
+	// LF_UNION and LF_ENUM records.
+	//
+
+	struct TAG_RECORD
+	{
+		UdtKind     Kind;
+		WORD        Properties;
+		DWORD       FieldList;
+		DWORD       UnderlyingType;
+		LONGLONG    Size;
+		const CHAR* Name;
+		const CHAR* UniqueName;
+	};
+
+	BOOL
+	IsTagRecord(
+		const CV_RECORD_HEADER* Record
+		)
+	{
+		switch (Record->Kind)
+		{
+			case LF_CLASS:
+			case LF_STRUCTURE:
+			case LF_INTERFACE:
+			case LF_UNION:
+			case LF_ENUM:
+				return TRUE;
+
+			default:
+				return FALSE;
+		}
+	}
+
+	BOOL
+	DecodeTagRecord(
+		const CV_RECORD_HEADER* Record,
+		TAG_RECORD& Tag
+		)
+	{
+		const BYTE* Data = GetRecordData(Record);
+		const BYTE* End = GetRecordEnd(Record);
+
+		Tag = TAG_RECORD{};
+
+		switch (Record->Kind)
+		{
+			case LF_CLASS:
+			case LF_STRUCTURE:
+			case LF_INTERFACE:
+			{
+				CV_CLASS_RECORD Class;
+
+				if (!ReadValue(Data, End, Class) ||
+				    !ReadNumeric(Data, End, Tag.Size))
+				{
+					return FALSE;
+				}
+
+				//
+				// Interfaces are not expressible in C,
+				// print them as structs.
+				//
+
+				Tag.Kind       = Record->Kind == LF_CLASS ? UdtClass : UdtStruct;
+				Tag.Properties = Class.Properties;
+				Tag.FieldList  = Class.FieldList;
+				break;
+			}
+
+			case LF_UNION:
+			{
+				CV_UNION_RECORD Union;
+
+				if (!ReadValue(Data, End, Union) ||
+				    !ReadNumeric(Data, End, Tag.Size))
+				{
+					return FALSE;
+				}
+
+				Tag.Kind       = UdtUnion;
+				Tag.Properties = Union.Properties;
+				Tag.FieldList  = Union.FieldList;
+				break;
+			}
+
+			case LF_ENUM:
+			{
+				CV_ENUM_RECORD Enum;
+
+				if (!ReadValue(Data, End, Enum))
+				{
+					return FALSE;
+				}
+
+				Tag.Properties     = Enum.Properties;
+				Tag.FieldList      = Enum.FieldList;
+				Tag.UnderlyingType = Enum.UnderlyingType;
+				break;
+			}
+
+			default:
+				return FALSE;
+		}
+
+		if (!ReadName(Data, End, Tag.Name))
+		{
+			return FALSE;
+		}
+
+		if ((Tag.Properties & CV_PROP_HASUNIQUENAME) == 0 ||
+		    !ReadName(Data, End, Tag.UniqueName))
+		{
+			Tag.UniqueName = nullptr;
+		}
+
+		return TRUE;
+	}
+
+	//
+	// Name under which the forward references are matched
+	// with their definitions.
+	//
+
+	const CHAR*
+	GetTagRecordKey(
+		const TAG_RECORD& Tag
+		)
+	{
+		return Tag.UniqueName ? Tag.UniqueName : Tag.Name;
+	}
+
+	//
+	// Returns TRUE for the records which describe a type on their own
+	// (ie. not field lists, argument lists, bitfields, ...) and which
+	// are not forward references.
+	//
+
+	BOOL
+	IsTypeDefinitionRecord(
+		const CV_RECORD_HEADER* Record
+		)
+	{
+		switch (Record->Kind)
+		{
+			case LF_MODIFIER:
+			case LF_POINTER:
+			case LF_ARRAY:
+			case LF_PROCEDURE:
+			case LF_MFUNCTION:
+				return TRUE;
+
+			case LF_CLASS:
+			case LF_STRUCTURE:
+			case LF_INTERFACE:
+			case LF_UNION:
+			case LF_ENUM:
+			{
+				TAG_RECORD Tag;
+				return DecodeTagRecord(Record, Tag) && !(Tag.Properties & CV_PROP_FWDREF);
+			}
+
+			default:
+				return FALSE;
+		}
+	}
+
+	//
+	// Mapping of the simple (built-in) type kinds
+	// to the basic types.
+	//
+
+	struct SimpleTypeMapElement
+	{
+		DWORD     Kind;
+		BasicType BaseType;
+		DWORD     Size;
+	};
+
+	static const SimpleTypeMapElement SimpleTypeMap[] = {
+		{ CV_ST_NOTYPE,   btNoType,    0 },
+		{ CV_ST_VOID,     btVoid,      0 },
+		{ CV_ST_HRESULT,  btHresult,   4 },
+		{ CV_ST_CHAR,     btChar,      1 },
+		{ CV_ST_SHORT,    btInt,       2 },
+		{ CV_ST_LONG,     btLong,      4 },
+		{ CV_ST_QUAD,     btInt,       8 },
+		{ CV_ST_OCT,      btInt,      16 },
+		{ CV_ST_UCHAR,    btUInt,      1 },
+		{ CV_ST_USHORT,   btUInt,      2 },
+		{ CV_ST_ULONG,    btULong,     4 },
+		{ CV_ST_UQUAD,    btUInt,      8 },
+		{ CV_ST_UOCT,     btUInt,     16 },
+		{ CV_ST_BOOL08,   btBool,      1 },
+		{ CV_ST_BOOL16,   btBool,      2 },
+		{ CV_ST_BOOL32,   btBool,      4 },
+		{ CV_ST_BOOL64,   btBool,      8 },
+		{ CV_ST_REAL32,   btFloat,     4 },
+		{ CV_ST_REAL64,   btFloat,     8 },
+		{ CV_ST_REAL80,   btFloat,    10 },
+		{ CV_ST_REAL128,  btFloat,    16 },
+		{ CV_ST_REAL16,   btFloat,     2 },
+		{ CV_ST_INT1,     btInt,       1 },
+		{ CV_ST_UINT1,    btUInt,      1 },
+		{ CV_ST_RCHAR,    btChar,      1 },
+		{ CV_ST_WCHAR,    btWChar,     2 },
+		{ CV_ST_INT2,     btInt,       2 },
+		{ CV_ST_UINT2,    btUInt,      2 },
+		{ CV_ST_INT4,     btInt,       4 },
+		{ CV_ST_UINT4,    btUInt,      4 },
+		{ CV_ST_INT8,     btInt,       8 },
+		{ CV_ST_UINT8,    btUInt,      8 },
+		{ CV_ST_INT16,    btInt,      16 },
+		{ CV_ST_UINT16,   btUInt,     16 },
+		{ CV_ST_CHAR16,   btChar16,    2 },
+		{ CV_ST_CHAR32,   btChar32,    4 },
+		{ CV_ST_CHAR8,    btChar8,     1 },
+	};
+
+	const SimpleTypeMapElement*
+	GetSimpleType(
+		DWORD TypeIndex
+		)
+	{
+		for (auto&& e : SimpleTypeMap)
+		{
+			if (e.Kind == CV_SIMPLE_TYPE_KIND(TypeIndex))
+			{
+				return &e;
+			}
+		}
+
+		return nullptr;
+	}
+}
+
+NativeSymbolModule::NativeSymbolModule()
+{
+
+}
+
+NativeSymbolModule::~NativeSymbolModule()
+{
+	Close();
+}
+
+BOOL
+NativeSymbolModule::Open(
+	IN const CHAR* Path
+	)
+{
+	if (!m_File.Open(Path))
+	{
+		return FALSE;
+	}
+
+	if (!LoadDbiStream() ||
+	    !LoadTpiStream())
+	{
+		Close();
+		return FALSE;
+	}
+
+	m_Path = Path;
+
+	//
+	// Symbols are decoded lazily - either when they're looked up
+	// or when the whole symbol map is requested.
+	//
+
+	return TRUE;
+}
+
+BOOL
+NativeSymbolModule::IsOpen() const
+{
+	return m_File.IsOpen();
+}
+
+SYMBOL*
+NativeSymbolModule::GetSymbolByName(
+	IN const CHAR* SymbolName
+	)
+{
+	DWORD TypeIndex = FindDefinitionByName(SymbolName);
+
+	return TypeIndex != 0
+		? GetSymbol(TypeIndex)
+		: nullptr;
+}
+
+SYMBOL*
+NativeSymbolModule::GetSymbolByTypeId(
+	IN DWORD TypeId
+	)
+{
+	if (TypeId >= m_TpiHeader.TypeIndexEnd)
+	{
+		return nullptr;
+	}
+
+	return GetSymbol(TypeId);
+}
+
+const SymbolMap&
+NativeSymbolModule::GetSymbolMap()
+{
+	BuildSymbolMap();
+
+	return m_SymbolMap;
+}
+
+const SymbolNameMap&
+NativeSymbolModule::GetSymbolNameMap()
+{
+	BuildSymbolMap();
+
+	if (m_SymbolNameMap.empty())
+	{
+		for (DWORD TypeIndex = m_TpiHeader.TypeIndexBegin; TypeIndex < m_TpiHeader.TypeIndexEnd; TypeIndex++)
+		{
+			SYMBOL* Symbol = m_SymbolMap.Get(TypeIndex);
+
+			//
+			// Modified (const/volatile) copy of the UDT
+			// must not hide the UDT itself.
+			//
+
+			if (Symbol != nullptr &&
+			    !Symbol->IsConst &&
+			    !Symbol->IsVolatile)
+			{
+				RegisterSymbolName(Symbol);
+			}
+		}
+	}
+
+	return m_SymbolNameMap;
+}
+
+VOID
+NativeSymbolModule::GetUnnamedSymbols(
+	OUT std::vector<const SYMBOL*>& Symbols
+	)
+{
+	//
+	// The names are in the tag records, only the unnamed ones
+	// (and their const/volatile copies) are decoded.  Forward
+	// references which resolve to the definitions are skipped,
+	// the definitions are enumerated on their own.
+	//
+	// All records are located at once, instead of walking them
+	// from the index-offset buffer for each one.  If the walk stops
+	// at a corrupted record, the rest is left to GetTypeRecord().
+	//
+
+	ScanTypeRecords(m_TpiHeader.TypeIndexBegin, m_TpiHeader.HeaderSize, m_TpiHeader.TypeIndexEnd);
+
+	for (DWORD TypeIndex = m_TpiHeader.TypeIndexBegin; TypeIndex < m_TpiHeader.TypeIndexEnd; TypeIndex++)
+	{
+		const CV_RECORD_HEADER* Record = GetTypeRecord(TypeIndex);
+
+		if (Record != nullptr && Record->Kind == LF_MODIFIER)
+		{
+			DWORD ModifiedTypeIndex = ResolveModifiedType(TypeIndex).TypeIndex;
+
+			Record = ModifiedTypeIndex >= CV_FIRST_NONPRIMITIVE_TYPE_INDEX
+				? GetTypeRecord(ModifiedTypeIndex)
+				: nullptr;
+		}
+
+		TAG_RECORD Tag;
+		if (Record == nullptr ||
+		    !IsTagRecord(Record) ||
+		    !DecodeTagRecord(Record, Tag) ||
+		    !PDB::IsUnnamedSymbolName(Tag.Name))
+		{
+			continue;
+		}
+
+		const SYMBOL* Symbol = GetSymbol(TypeIndex);
+
+		if ((Symbol->Tag == SymTagUDT || Symbol->Tag == SymTagEnum) &&
+		    PDB::IsUnnamedSymbol(Symbol) &&
+		    Symbol->TypeId == TypeIndex)
+		{
+			Symbols.push_back(Symbol);
+		}
+	}
+}
+
+VOID
+NativeSymbolModule::Close()
+{
+	SymbolModule::Close();
+
+	m_TypeRecordOffsets.clear();
+	m_IndexOffsets.clear();
+	m_ForwardReferences.clear();
+	m_ModifiedTypes.clear();
+	m_DefinitionsByKey.clear();
+	m_DefinitionsByName.clear();
+	m_HashBucketHeads.clear();
+	m_HashBucketNext.clear();
+	m_HasHashValues = FALSE;
+	m_IsDefinitionIndexBuilt = FALSE;
+	m_IsSymbolMapBuilt = FALSE;
+	m_TpiHashStream = MSFStream();
+	m_TpiStream = MSFStream();
+	m_TpiHeader = TPI_STREAM_HEADER{};
+
+	m_File.Close();
+}
+
+BOOL
+NativeSymbolModule::LoadDbiStream()
+{
+	MSFStream DbiStream;
+
+	if (!m_File.ReadStream(MSFStreamDbi, DbiStream) ||
+	    DbiStream.Size < sizeof(DBI_STREAM_HEADER))
+	{
+		//
+		// DBI stream is not essential for reconstructing the types.
+		//
+
+		return TRUE;
+	}
+
+	DBI_STREAM_HEADER DbiHeader;
+	memcpy(&DbiHeader, DbiStream.Data, sizeof(DbiHeader));
+
+	m_MachineType = DbiHeader.Machine;
+
+	MSFStream SymbolRecordStream;
+
+	if (DbiHeader.SymRecordStream != MSFStreamInvalid &&
+	    m_File.ReadStream(DbiHeader.SymRecordStream, SymbolRecordStream))
+	{
+		BuildFunctionSet(SymbolRecordStream);
+	}
+
+	return TRUE;
+}
+
+BOOL
+NativeSymbolModule::LoadTpiStream()
+{
+	if (!m_File.ReadStream(MSFStreamTpi, m_TpiStream) ||
+	    m_TpiStream.Size < sizeof(TPI_STREAM_HEADER))
+	{
+		return FALSE;
+	}
+
+	memcpy(&m_TpiHeader, m_TpiStream.Data, sizeof(m_TpiHeader));
+
+	if (m_TpiHeader.HeaderSize < sizeof(TPI_STREAM_HEADER) ||
+	    m_TpiHeader.HeaderSize > m_TpiStream.Size ||
+	    m_TpiHeader.TypeIndexBegin < CV_FIRST_NONPRIMITIVE_TYPE_INDEX ||
+	    m_TpiHeader.TypeIndexEnd < m_TpiHeader.TypeIndexBegin)
+	{
+		return FALSE;
+	}
+
+	DWORD TypeRecordCount = m_TpiHeader.TypeIndexEnd - m_TpiHeader.TypeIndexBegin;
+
+	//
+	// Each record takes at least 4 bytes (its length and kind),
+	// more records than that can't fit in the stream.
+	//
+
+	if (TypeRecordCount > (m_TpiStream.Size - m_TpiHeader.HeaderSize) / 4)
+	{
+		return FALSE;
+	}
+
+	//
+	// Offsets are filled on demand.  Zero marks the offset
+	// which hasn't been determined yet (the first record
+	// always starts after the header).
+	//
+
+	m_TypeRecordOffsets.assign(TypeRecordCount, 0);
+	m_SymbolMap.Reserve(m_TpiHeader.TypeIndexEnd);
+
+	LoadTpiHashStream();
+
+	if (!LoadIndexOffsets())
+	{
+		//
+		// Without the index-offset buffer, there is no other way
+		// than to walk all the records.
+		//
+
+		return ScanTypeRecords(m_TpiHeader.TypeIndexBegin, m_TpiHeader.HeaderSize, m_TpiHeader.TypeIndexEnd);
+	}
+
+	return TRUE;
+}
+
+BOOL
+NativeSymbolModule::LoadTpiHashStream()
+{
+	if (m_TpiHeader.HashStreamIndex == MSFStreamInvalid ||
+	    !m_File.ReadStream(m_TpiHeader.HashStreamIndex, m_TpiHashStream))
+	{
+		return FALSE;
+	}
+
+	//
+	// Hash values are usable only if there is one for each type
+	// record and the number of the buckets is sane, otherwise
+	// the definitions are found by the name map.
+	//
+
+	DWORD TypeRecordCount = m_TpiHeader.TypeIndexEnd - m_TpiHeader.TypeIndexBegin;
+
+	m_HasHashValues =
+		m_TpiHeader.HashKeySize == sizeof(DWORD) &&
+		m_TpiHeader.NumHashBuckets != 0 &&
+		m_TpiHeader.NumHashBuckets <= MAX_HASH_BUCKET_COUNT &&
+		m_TpiHeader.HashValueBufferOffset >= 0 &&
+		m_TpiHeader.HashValueBufferLength == static_cast<ULONGLONG>(TypeRecordCount) * sizeof(DWORD) &&
+		static_cast<ULONGLONG>(m_TpiHeader.HashValueBufferOffset) + m_TpiHeader.HashValueBufferLength <= m_TpiHashStream.Size;
+
+	return TRUE;
+}
+
+BOOL
+NativeSymbolModule::LoadIndexOffsets()
+{
+	if (m_TpiHashStream.Data == nullptr ||
+	    m_TpiHeader.IndexOffsetBufferOffset < 0 ||
+	    m_TpiHeader.IndexOffsetBufferLength < sizeof(TPI_INDEX_OFFSET) ||
+	    static_cast<ULONGLONG>(m_TpiHeader.IndexOffsetBufferOffset) + m_TpiHeader.IndexOffsetBufferLength > m_TpiHashStream.Size)
+	{
+		return FALSE;
+	}
+
+	//
+	// The index-offset buffer contains sparse (TypeIndex, Offset)
+	// pairs, sorted by the type index.  Offsets are relative
+	// to the end of the TPI header.
+	//
+
+	DWORD IndexOffsetCount = m_TpiHeader.IndexOffsetBufferLength / sizeof(TPI_INDEX_OFFSET);
+	m_IndexOffsets.resize(IndexOffsetCount);
+
+	memcpy(
+		m_IndexOffsets.data(),
+		m_TpiHashStream.Data + m_TpiHeader.IndexOffsetBufferOffset,
+		IndexOffsetCount * sizeof(TPI_INDEX_OFFSET)
+		);
+
+	DWORD PreviousTypeIndex = 0;
+
+	for (auto&& IndexOffset : m_IndexOffsets)
+	{
+		if (IndexOffset.TypeIndex < m_TpiHeader.TypeIndexBegin ||
+		    IndexOffset.TypeIndex >= m_TpiHeader.TypeIndexEnd ||
+		    IndexOffset.TypeIndex <= PreviousTypeIndex ||
+		    IndexOffset.Offset > m_TpiStream.Size - m_TpiHeader.HeaderSize)
+		{
+			m_IndexOffsets.clear();
+			return FALSE;
+		}
+
+		IndexOffset.Offset += m_TpiHeader.HeaderSize;
+		PreviousTypeIndex = IndexOffset.TypeIndex;
+	}
+
+	return m_IndexOffsets.front().TypeIndex == m_TpiHeader.TypeIndexBegin;
+}
+
+BOOL
+NativeSymbolModule::ScanTypeRecords(
+	IN DWORD TypeIndex,
+	IN DWORD Offset,
+	IN DWORD TypeIndexEnd
+	)
+{
+	//
+	// Type records are stored one after another and the type index
+	// of each record is implied by its position.  Walk them and remember
+	// where each record starts.
+	//
+
+	for (; TypeIndex < TypeIndexEnd; TypeIndex++)
+	{
+		if (Offset + sizeof(CV_RECORD_HEADER) > m_TpiStream.Size)
+		{
+			return FALSE;
+		}
+
+		auto Record = reinterpret_cast<const CV_RECORD_HEADER*>(m_TpiStream.Data + Offset);
+
+		if (Offset + sizeof(Record->Length) + Record->Length > m_TpiStream.Size ||
+		    Record->Length < sizeof(Record->Kind))
+		{
+			return FALSE;
+		}
+
+		m_TypeRecordOffsets[TypeIndex - m_TpiHeader.TypeIndexBegin] = Offset;
+
+		Offset += sizeof(Record->Length) + Record->Length;
+	}
+
+	return TRUE;
+}
+
+VOID
+NativeSymbolModule::BuildDefinitionIndex()
+{
+	if (m_IsDefinitionIndexBuilt)
+	{
+		return;
+	}
+
+	m_IsDefinitionIndexBuilt = TRUE;
+
+	for (DWORD TypeIndex = m_TpiHeader.TypeIndexBegin; TypeIndex < m_TpiHeader.TypeIndexEnd; TypeIndex++)
+	{
+		const CV_RECORD_HEADER* Record = GetTypeRecord(TypeIndex);
+
+		TAG_RECORD Tag;
+		if (Record != nullptr &&
+		    IsTagRecord(Record) &&
+		    DecodeTagRecord(Record, Tag) &&
+		    !(Tag.Properties & CV_PROP_FWDREF))
+		{
+			//
+			// If there are more definitions with the same name,
+			// the first one wins.
+			//
+
+			m_DefinitionsByKey.emplace(GetTagRecordKey(Tag), TypeIndex);
+			m_DefinitionsByName.emplace(Tag.Name, TypeIndex);
+		}
+	}
+}
+
+VOID
+NativeSymbolModule::BuildHashBuckets()
+{
+	if (!m_HashBucketHeads.empty())
+	{
+		return;
+	}
+
+	DWORD TypeRecordCount = m_TpiHeader.TypeIndexEnd - m_TpiHeader.TypeIndexBegin;
+	const BYTE* HashValues = m_TpiHashStream.Data + m_TpiHeader.HashValueBufferOffset;
+
+	m_HashBucketHeads.assign(m_TpiHeader.NumHashBuckets, HASH_BUCKET_END);
+	m_HashBucketNext.assign(TypeRecordCount, HASH_BUCKET_END);
+
+	//
+	// Chain the records backwards, so that each bucket
+	// is ordered by the type index.
+	//
+
+	for (DWORD i = TypeRecordCount; i-- > 0; )
+	{
+		DWORD HashValue;
+		memcpy(&HashValue, HashValues + i * sizeof(DWORD), sizeof(HashValue));
+
+		if (HashValue >= m_TpiHeader.NumHashBuckets)
+		{
+			continue;
+		}
+
+		m_HashBucketNext[i] = m_HashBucketHeads[HashValue];
+		m_HashBucketHeads[HashValue] = i;
+	}
+}
+
+DWORD
+NativeSymbolModule::FindDefinitionByHash(
+	IN const CHAR* Name,
+	IN BOOL IsUniqueName
+	)
+{
+	BuildHashBuckets();
+
+	DWORD HashValue = HashStringV1(Name) % m_TpiHeader.NumHashBuckets;
+
+	for (DWORD i = m_HashBucketHeads[HashValue]; i != HASH_BUCKET_END; i = m_HashBucketNext[i])
+	{
+		const CV_RECORD_HEADER* Record = GetTypeRecord(m_TpiHeader.TypeIndexBegin + i);
+
+		TAG_RECORD Tag;
+		if (Record != nullptr &&
+		    IsTagRecord(Record) &&
+		    DecodeTagRecord(Record, Tag) &&
+		    !(Tag.Properties & CV_PROP_FWDREF))
+		{
+			const CHAR* TagName = IsUniqueName ? Tag.UniqueName : Tag.Name;
+
+			if (TagName != nullptr && strcmp(TagName, Name) == 0)
+			{
+				return m_TpiHeader.TypeIndexBegin + i;
+			}
+		}
+	}
+
+	return 0;
+}
+
+DWORD
+NativeSymbolModule::FindDefinitionByName(
+	IN const CHAR* Name
+	)
+{
+	if (m_HasHashValues)
+	{
+		DWORD TypeIndex = FindDefinitionByHash(Name, FALSE);
+
+		if (TypeIndex != 0)
+		{
+			return TypeIndex;
+		}
+
+		//
+		// Scoped (nested) types are hashed by their unique name,
+		// they can be found only by the full scan.
+		//
+	}
+
+	BuildDefinitionIndex();
+
+	auto it = m_DefinitionsByName.find(Name);
+	return it == m_DefinitionsByName.end() ? 0 : it->second;
+}
+
+VOID
+NativeSymbolModule::BuildFunctionSet(
+	IN const MSFStream& SymbolRecordStream
+	)
+{
+	const BYTE* Data = SymbolRecordStream.Data;
+	const BYTE* End = SymbolRecordStream.Data + SymbolRecordStream.Size;
+
+	while (End - Data >= static_cast<ptrdiff_t>(sizeof(CV_RECORD_HEADER)))
+	{
+		auto Record = reinterpret_cast<const CV_RECORD_HEADER*>(Data);
+		const BYTE* RecordEnd = GetRecordEnd(Record);
+
+		if (RecordEnd > End)
+		{
+			break;
+		}
+
+		if (Record->Kind == S_PUB32)
+		{
+			const BYTE* RecordData = GetRecordData(Record);
+
+			CV_PUBSYM32_RECORD PublicSymbol;
+			const CHAR* Name;
+
+			if (ReadValue(RecordData, RecordEnd, PublicSymbol) &&
+			    ReadName(RecordData, RecordEnd, Name) &&
+			    (PublicSymbol.Flags & CV_PUBSYMFLAGS_FUNCTION))
+			{
+				m_FunctionSet.insert(Name);
+			}
+		}
+
+		Data = RecordEnd;
+	}
+}
+
+VOID
+NativeSymbolModule::GetDefinitions(
+	OUT std::vector<DWORD>& TypeIndices
+	)
+{
+	//
+	// Same as with DIA - enumerations first, then UDTs.
+	// Forward references are not enumerated, they're resolved
+	// when the definition is referenced.
+	//
+
+	for (int Pass = 0; Pass < 2; Pass++)
+	{
+		for (DWORD TypeIndex = m_TpiHeader.TypeIndexBegin; TypeIndex < m_TpiHeader.TypeIndexEnd; TypeIndex++)
+		{
+			const CV_RECORD_HEADER* Record = GetTypeRecord(TypeIndex);
+
+			if (Record == nullptr || !IsTagRecord(Record) || (Record->Kind == LF_ENUM) != (Pass == 0))
+			{
+				continue;
+			}
+
+			if (IsTypeDefinitionRecord(Record))
+			{
+				TypeIndices.push_back(TypeIndex);
+			}
+		}
+	}
+}
+
+VOID
+NativeSymbolModule::BuildSymbolMap()
+{
+	if (m_IsSymbolMapBuilt)
+	{
+		return;
+	}
+
+	m_IsSymbolMapBuilt = TRUE;
+
+	Trace::Span Span(m_Trace, "BuildSymbolMap");
+
+	ThreadPool Pool(m_ThreadCount);
+
+	if (Pool.GetThreadCount() > 1 && BuildSymbolMapParallel(Pool))
+	{
+		return;
+	}
+
+	std::vector<DWORD> Definitions;
+	GetDefinitions(Definitions);
+
+	Trace::Span DecodeSpan(m_Trace, "DecodeTypeRecords", m_TpiHeader.TypeIndexBegin, m_TpiHeader.TypeIndexEnd);
+
+	for (DWORD TypeIndex : Definitions)
+	{
+		GetSymbol(TypeIndex);
+	}
+}
+
+BOOL
+NativeSymbolModule::BuildSymbolMapParallel(
+	IN ThreadPool& Pool
+	)
+{
+	DWORD TypeIndexBegin = m_TpiHeader.TypeIndexBegin;
+	DWORD TypeRecordCount = m_TpiHeader.TypeIndexEnd - TypeIndexBegin;
+
+	//
+	// Phase 1 - locate all type records up front, so that the workers
+	// don't have to modify m_TypeRecordOffsets.  Modifiers are resolved
+	// here too (together with the forward references they point to),
+	// because they need their targets during decoding
+	// (see ProcessSymbolModifier).
+	//
+
+	if (TypeRecordCount == 0 ||
+	    !ScanTypeRecords(TypeIndexBegin, m_TpiHeader.HeaderSize, m_TpiHeader.TypeIndexEnd))
+	{
+		return FALSE;
+	}
+
+	for (DWORD TypeIndex = TypeIndexBegin; TypeIndex < m_TpiHeader.TypeIndexEnd; TypeIndex++)
+	{
+		if (GetTypeRecord(TypeIndex)->Kind == LF_MODIFIER)
+		{
+			ResolveModifiedType(TypeIndex);
+		}
+	}
+
+	//
+	// Phase 2 - decode each type record into its own slot.
+	// References to other symbols are only recorded by the workers.
+	//
+
+	std::vector<DECODE_SLOT> Slots(TypeRecordCount);
+	std::vector<DECODE_CONTEXT> Contexts(Pool.GetThreadCount());
+
+	Pool.ParallelFor(TypeRecordCount, 256, [&](DWORD Worker, size_t First, size_t Last) {
+		DECODE_CONTEXT& Context = Contexts[Worker];
+
+		Trace::Span Span(m_Trace, "DecodeTypeRecords", TypeIndexBegin + First, TypeIndexBegin + Last);
+
+		for (size_t Index = First; Index < Last; Index++)
+		{
+			DWORD TypeIndex = TypeIndexBegin + static_cast<DWORD>(Index);
+
+			if (!IsTypeDefinitionRecord(GetTypeRecord(TypeIndex)))
+			{
+				continue;
+			}
+
+			DECODE_SLOT& Slot = Slots[Index];
+
+			Slot.Symbol         = Context.Allocator.Allocate<SYMBOL>();
+			Slot.Worker         = Worker;
+			Slot.ReferenceBegin = static_cast<DWORD>(Context.References.size());
+			Slot.FixupBegin     = static_cast<DWORD>(Context.Fixups.size());
+
+			InitSymbol(TypeIndex, Slot.Symbol, &Context);
+
+			Slot.ReferenceEnd   = static_cast<DWORD>(Context.References.size());
+			Slot.FixupEnd       = static_cast<DWORD>(Context.Fixups.size());
+		}
+	});
+
+	//
+	// Phase 3 - walk the definitions and insert the reachable symbols
+	// into the symbol map, so that it ends up with exactly the same
+	// symbols as after the serial decoding.  Symbols without the slot
+	// (simple types, unresolved forward references) are decoded serially.
+	//
+
+	std::vector<DWORD> Definitions;
+	GetDefinitions(Definitions);
+
+	std::vector<DWORD> Reachable;
+	std::vector<DWORD> Stack;
+
+	for (DWORD Definition : Definitions)
+	{
+		Stack.push_back(Definition);
+
+		while (!Stack.empty())
+		{
+			DWORD TypeIndex = ResolveForwardReference(Stack.back());
+			Stack.pop_back();
+
+			if (m_SymbolMap.Contains(TypeIndex))
+			{
+				continue;
+			}
+
+			if (TypeIndex < TypeIndexBegin ||
+			    TypeIndex >= m_TpiHeader.TypeIndexEnd ||
+			    Slots[TypeIndex - TypeIndexBegin].Symbol == nullptr)
+			{
+				GetSymbol(TypeIndex);
+				continue;
+			}
+
+			DECODE_SLOT& Slot = Slots[TypeIndex - TypeIndexBegin];
+
+			m_SymbolMap.Set(TypeIndex, Slot.Symbol);
+			Slot.IsReachable = TRUE;
+			Reachable.push_back(TypeIndex - TypeIndexBegin);
+
+			//
+			// Referenced symbols are visited in the order of the references.
+			//
+
+			const auto& References = Contexts[Slot.Worker].References;
+
+			for (DWORD Index = Slot.ReferenceEnd; Index > Slot.ReferenceBegin; Index--)
+			{
+				Stack.push_back(References[Index - 1].TypeIndex);
+			}
+		}
+	}
+
+	//
+	// Phase 4 - link the references, then finish the parts of the symbols
+	// which depend on the referenced symbols.  Underlying types of enums
+	// come first, as they determine the size of the enums.
+	//
+
+	for (DWORD Index : Reachable)
+	{
+		const DECODE_SLOT& Slot = Slots[Index];
+		const DECODE_CONTEXT& Context = Contexts[Slot.Worker];
+
+		for (DWORD ReferenceIndex = Slot.ReferenceBegin; ReferenceIndex < Slot.ReferenceEnd; ReferenceIndex++)
+		{
+			const PENDING_REFERENCE& Reference = Context.References[ReferenceIndex];
+
+			if (Reference.Reference != nullptr)
+			{
+				*Reference.Reference = GetSymbol(Reference.TypeIndex);
+			}
+		}
+	}
+
+	for (DWORD Index : Reachable)
+	{
+		const DECODE_SLOT& Slot = Slots[Index];
+		const DECODE_CONTEXT& Context = Contexts[Slot.Worker];
+
+		for (DWORD FixupIndex = Slot.FixupBegin; FixupIndex < Slot.FixupEnd; FixupIndex++)
+		{
+			const PENDING_FIXUP& Fixup = Context.Fixups[FixupIndex];
+
+			if (Fixup.Symbol->Tag == SymTagEnum)
+			{
+				SetEnumUnderlyingType(Fixup.Symbol, GetSymbol(Fixup.TypeIndex));
+			}
+		}
+	}
+
+	for (DWORD Index : Reachable)
+	{
+		const DECODE_SLOT& Slot = Slots[Index];
+		const DECODE_CONTEXT& Context = Contexts[Slot.Worker];
+
+		for (DWORD FixupIndex = Slot.FixupBegin; FixupIndex < Slot.FixupEnd; FixupIndex++)
+		{
+			const PENDING_FIXUP& Fixup = Context.Fixups[FixupIndex];
+
+			if (Fixup.Symbol->Tag != SymTagEnum)
+			{
+				FinalizeSymbol(Fixup.Symbol, nullptr);
+			}
+		}
+	}
+
+	//
+	// Take over the memory of the workers.  Symbols which turned out
+	// to be unreachable stay in the arena until the module is closed.
+	//
+
+	for (auto&& Context : Contexts)
+	{
+		m_Arena.Merge(Context.Allocator);
+	}
+
+	return TRUE;
+}
+
+const CV_RECORD_HEADER*
+NativeSymbolModule::GetTypeRecord(
+	IN DWORD TypeIndex
+	)
+{
+	if (TypeIndex < m_TpiHeader.TypeIndexBegin ||
+	    TypeIndex >= m_TpiHeader.TypeIndexEnd)
+	{
+		return nullptr;
+	}
+
+	DWORD Offset = m_TypeRecordOffsets[TypeIndex - m_TpiHeader.TypeIndexBegin];
+
+	if (Offset == 0)
+	{
+		//
+		// Walk the records from the closest preceding
+		// entry of the index-offset buffer.
+		//
+
+		auto it = std::upper_bound(
+			m_IndexOffsets.begin(),
+			m_IndexOffsets.end(),
+			TypeIndex,
+			[](DWORD TypeIndex, const TPI_INDEX_OFFSET& IndexOffset) {
+				return TypeIndex < IndexOffset.TypeIndex;
+			});
+
+		if (it == m_IndexOffsets.begin() ||
+		    !ScanTypeRecords((it - 1)->TypeIndex, (it - 1)->Offset, TypeIndex + 1))
+		{
+			return nullptr;
+		}
+
+		Offset = m_TypeRecordOffsets[TypeIndex - m_TpiHeader.TypeIndexBegin];
+	}
+
+	return reinterpret_cast<const CV_RECORD_HEADER*>(m_TpiStream.Data + Offset);
+}
+
+DWORD
+NativeSymbolModule::ResolveForwardReference(
+	IN DWORD TypeIndex
+	)
+{
+	auto it = m_ForwardReferences.find(TypeIndex);
+
+	if (it != m_ForwardReferences.end())
+	{
+		return it->second;
+	}
+
+	const CV_RECORD_HEADER* Record = GetTypeRecord(TypeIndex);
+
+	TAG_RECORD Tag;
+	if (Record == nullptr ||
+	    !IsTagRecord(Record) ||
+	    !DecodeTagRecord(Record, Tag) ||
+	    !(Tag.Properties & CV_PROP_FWDREF))
+	{
+		return TypeIndex;
+	}
+
+	DWORD DefinitionTypeIndex = 0;
+
+	if (m_HasHashValues && !(Tag.Properties & CV_PROP_SCOPED))
+	{
+		//
+		// Unscoped definitions are hashed by their name.
+		//
+
+		DefinitionTypeIndex = FindDefinitionByHash(Tag.Name, FALSE);
+
+		if (DefinitionTypeIndex != 0 && Tag.UniqueName != nullptr)
+		{
+			TAG_RECORD Definition;
+			DecodeTagRecord(GetTypeRecord(DefinitionTypeIndex), Definition);
+
+			if (Definition.UniqueName == nullptr || strcmp(Definition.UniqueName, Tag.UniqueName) != 0)
+			{
+				DefinitionTypeIndex = 0;
+			}
+		}
+	}
+	else if (m_HasHashValues && Tag.UniqueName != nullptr)
+	{
+		//
+		// Scoped definitions are hashed by their unique name.
+		//
+
+		DefinitionTypeIndex = FindDefinitionByHash(Tag.UniqueName, TRUE);
+	}
+	else
+	{
+		BuildDefinitionIndex();
+
+		auto DefinitionIt = m_DefinitionsByKey.find(GetTagRecordKey(Tag));
+
+		if (DefinitionIt != m_DefinitionsByKey.end())
+		{
+			DefinitionTypeIndex = DefinitionIt->second;
+		}
+	}
+
+	if (DefinitionTypeIndex == 0)
+	{
+		DefinitionTypeIndex = TypeIndex;
+	}
+
+	m_ForwardReferences[TypeIndex] = DefinitionTypeIndex;
+
+	return DefinitionTypeIndex;
+}
+
+NativeSymbolModule::MODIFIED_TYPE
+NativeSymbolModule::ResolveModifiedType(
+	IN DWORD TypeIndex
+	)
+{
+	auto it = m_ModifiedTypes.find(TypeIndex);
+
+	if (it != m_ModifiedTypes.end())
+	{
+		return it->second;
+	}
+
+	//
+	// Walk the chain of the modifiers down to the first type
+	// which is not a modifier (or whose result is already known).
+	//
+
+	std::vector<std::pair<DWORD, WORD>>& Chain = m_ModifierChain;
+	Chain.clear();
+
+	DWORD ChainLimit = m_TpiHeader.TypeIndexEnd - m_TpiHeader.TypeIndexBegin;
+
+	MODIFIED_TYPE Result;
+	DWORD CurrentTypeIndex = TypeIndex;
+
+	for (;;)
+	{
+		const CV_RECORD_HEADER* Record = CurrentTypeIndex >= CV_FIRST_NONPRIMITIVE_TYPE_INDEX
+			? GetTypeRecord(CurrentTypeIndex)
+			: nullptr;
+
+		if (Record == nullptr || Record->Kind != LF_MODIFIER)
+		{
+			Result = { CurrentTypeIndex, 0 };
+			break;
+		}
+
+		it = m_ModifiedTypes.find(CurrentTypeIndex);
+
+		if (it != m_ModifiedTypes.end())
+		{
+			Result = it->second;
+			break;
+		}
+
+		const BYTE* Data = GetRecordData(Record);
+		const BYTE* End = GetRecordEnd(Record);
+
+		CV_MODIFIER_RECORD Modifier;
+
+		if (!ReadValue(Data, End, Modifier) || Chain.size() == ChainLimit)
+		{
+			//
+			// Broken record or a cycle of modifiers (malformed PDB),
+			// the modifier resolves to itself.
+			//
+
+			Result = { CurrentTypeIndex, 0 };
+			m_ModifiedTypes[CurrentTypeIndex] = Result;
+			break;
+		}
+
+		Chain.emplace_back(CurrentTypeIndex, Modifier.Modifiers);
+		CurrentTypeIndex = ResolveForwardReference(Modifier.ModifiedType);
+	}
+
+	//
+	// Remember the result for every modifier of the chain.
+	//
+
+	for (auto ChainIt = Chain.rbegin(); ChainIt != Chain.rend(); ++ChainIt)
+	{
+		Result.Modifiers |= ChainIt->second;
+		m_ModifiedTypes[ChainIt->first] = Result;
+	}
+
+	return Result;
+}
+
+VOID
+NativeSymbolModule::ReadFieldList(
+	IN DWORD TypeIndex,
+	OUT FieldList& Members
+	)
+{
+	const CV_RECORD_HEADER* Record = GetTypeRecord(TypeIndex);
+
+	//
+	// Long field lists are split into more records,
+	// chained by the LF_INDEX member.
+	//
+
+	while (Record != nullptr && Record->Kind == LF_FIELDLIST)
+	{
+		const BYTE* Data = GetRecordData(Record);
+		const BYTE* End = GetRecordEnd(Record);
+
+		Record = nullptr;
+
+		while (Data < End)
+		{
+			FIELD_LIST_MEMBER Member = {};
+			WORD Attributes;
+			WORD Padding;
+			DWORD Dummy;
+			LONGLONG DummyNumeric;
+
+			if (!ReadValue(Data, End, Member.Kind))
+			{
+				return;
+			}
+
+			BOOL Success = FALSE;
+
+			switch (Member.Kind)
+			{
+				case LF_MEMBER:
+					Success =
+						ReadValue(Data, End, Attributes) &&
+						ReadValue(Data, End, Member.Type) &&
+						ReadNumeric(Data, End, Member.Value) &&
+						ReadName(Data, End, Member.Name);
+					break;
+
+				case LF_ENUMERATE:
+					Success =
+						ReadValue(Data, End, Attributes) &&
+						ReadNumeric(Data, End, Member.Value) &&
+						ReadName(Data, End, Member.Name);
+					break;
+
+				case LF_STMEMBER:
+					Success =
+						ReadValue(Data, End, Attributes) &&
+						ReadValue(Data, End, Member.Type) &&
+						ReadName(Data, End, Member.Name);
+					break;
+
+				case LF_BCLASS:
+					Success =
+						ReadValue(Data, End, Attributes) &&
+						ReadValue(Data, End, Member.Type) &&
+						ReadNumeric(Data, End, Member.Value);
+					break;
+
+				case LF_VBCLASS:
+				case LF_IVBCLASS:
+					Success =
+						ReadValue(Data, End, Attributes) &&
+						ReadValue(Data, End, Member.Type) &&
+						ReadValue(Data, End, Dummy) &&
+						ReadNumeric(Data, End, DummyNumeric) &&
+						ReadNumeric(Data, End, DummyNumeric);
+					break;
+
+				case LF_INDEX:
+					Success =
+						ReadValue(Data, End, Padding) &&
+						ReadValue(Data, End, Member.Type);
+
+					if (Success)
+					{
+						Record = GetTypeRecord(Member.Type);
+					}
+					break;
+
+				case LF_VFUNCTAB:
+					Success =
+						ReadValue(Data, End, Padding) &&
+						ReadValue(Data, End, Member.Type);
+					break;
+
+				case LF_ONEMETHOD:
+					Success =
+						ReadValue(Data, End, Attributes) &&
+						ReadValue(Data, End, Member.Type);
+
+					if (Success &&
+					   (((Attributes >> 2) & 7) == CV_MTINTRO ||
+					    ((Attributes >> 2) & 7) == CV_MTPUREINTRO))
+					{
+						Success = ReadValue(Data, End, Dummy);
+					}
+
+					Success = Success && ReadName(Data, End, Member.Name);
+					break;
+
+				case LF_METHOD:
+					Success =
+						ReadValue(Data, End, Padding) &&
+						ReadValue(Data, End, Member.Type) &&
+						ReadName(Data, End, Member.Name);
+					break;
+
+				case LF_NESTTYPE:
+					Success =
+						ReadValue(Data, End, Padding) &&
+						ReadValue(Data, End, Member.Type) &&
+						ReadName(Data, End, Member.Name);
+					break;
+
+				default:
+					//
+					// Size of unknown members cannot be determined,
+					// so nothing after them can be read.
+					//
+					break;
+			}
+
+			if (!Success)
+			{
+				return;
+			}
+
+			if (Member.Kind != LF_INDEX)
+			{
+				Members.push_back(Member);
+			}
+
+			SkipPadding(Data, End);
+		}
+	}
+}
+
+SYMBOL*
+NativeSymbolModule::GetSymbol(
+	IN DWORD TypeIndex
+	)
+{
+	TypeIndex = ResolveForwardReference(TypeIndex);
+
+	if (TypeIndex >= m_TpiHeader.TypeIndexEnd)
+	{
+		//
+		// Type index out of range (corrupted record), all of them
+		// share the "no type" symbol.  Primitive type indices are
+		// always below TypeIndexEnd.
+		//
+
+		TypeIndex = CV_ST_NOTYPE;
+	}
+
+	if (SYMBOL* Symbol = m_SymbolMap.Get(TypeIndex))
+	{
+		return Symbol;
+	}
+
+	//
+	// The symbol is inserted into the symbol map before it is decoded,
+	// so that references back to it (cycles) resolve to it.
+	//
+
+	SYMBOL* Symbol = CreateSymbol(TypeIndex);
+
+	m_PendingSymbols.push_back({ Symbol, TypeIndex });
+
+	if (!m_IsDecoding)
+	{
+		DecodePendingSymbols();
+	}
+
+	//
+	// Names are not registered here - name lookups go through
+	// the TPI hash stream, SymbolNameMap is built only on request.
+	//
+
+	return Symbol;
+}
+
+VOID
+NativeSymbolModule::DecodePendingSymbols()
+{
+	//
+	// Symbols referenced during the decoding are only queued
+	// (see GetSymbol), so the depth of the type graph doesn't
+	// matter - there is no recursion.
+	//
+
+	m_IsDecoding = TRUE;
+
+	while (!m_PendingSymbols.empty())
+	{
+		PENDING_SYMBOL PendingSymbol = m_PendingSymbols.back();
+		m_PendingSymbols.pop_back();
+
+		InitSymbol(PendingSymbol.TypeIndex, PendingSymbol.Symbol, nullptr);
+	}
+
+	m_IsDecoding = FALSE;
+
+	//
+	// All referenced symbols are decoded now, so the fixups
+	// don't decode anything.  Underlying types of enums
+	// come first, as they determine the size of the enums.
+	//
+
+	for (const PENDING_FIXUP& Fixup : m_PendingFixups)
+	{
+		if (Fixup.Symbol->Tag == SymTagEnum)
+		{
+			SetEnumUnderlyingType(Fixup.Symbol, GetSymbol(Fixup.TypeIndex));
+		}
+	}
+
+	for (const PENDING_FIXUP& Fixup : m_PendingFixups)
+	{
+		if (Fixup.Symbol->Tag != SymTagEnum)
+		{
+			FinalizeSymbol(Fixup.Symbol, nullptr);
+		}
+	}
+
+	m_PendingFixups.clear();
+}
+
+VOID
+NativeSymbolModule::InitSymbol(
+	IN DWORD TypeIndex,
+	IN SYMBOL* Symbol,
+	IN DECODE_CONTEXT* Context
+	)
+{
+	Symbol->Tag        = SymTagNull;
+	Symbol->DataKind   = DataIsUnknown;
+	Symbol->BaseType   = btNoType;
+	Symbol->TypeId     = TypeIndex;
+	Symbol->Size       = 0;
+	Symbol->IsConst    = FALSE;
+	Symbol->IsVolatile = FALSE;
+	Symbol->Name       = nullptr;
+
+	if (TypeIndex < CV_FIRST_NONPRIMITIVE_TYPE_INDEX)
+	{
+		ProcessSimpleType(TypeIndex, Symbol, Context);
+		return;
+	}
+
+	const CV_RECORD_HEADER* Record = GetTypeRecord(TypeIndex);
+
+	if (Record == nullptr)
+	{
+		//
+		// Type index out of range, treat it as "no type".
+		//
+
+		ProcessSimpleType(CV_ST_NOTYPE, Symbol, Context);
+		return;
+	}
+
+	switch (Record->Kind)
+	{
+		case LF_MODIFIER:   ProcessSymbolModifier(Record, Symbol, Context); break;
+		case LF_POINTER:    ProcessSymbolPointer (Record, Symbol, Context); break;
+		case LF_ARRAY:      ProcessSymbolArray   (Record, Symbol, Context); break;
+		case LF_PROCEDURE:
+		case LF_MFUNCTION:  ProcessSymbolFunction(Record, Symbol, Context); break;
+		case LF_ENUM:       ProcessSymbolEnum    (Record, Symbol, Context); break;
+		case LF_CLASS:
+		case LF_STRUCTURE:
+		case LF_INTERFACE:
+		case LF_UNION:      ProcessSymbolUdt     (Record, Symbol, Context); break;
+		default:                                                            break;
+	}
+}
+
+VOID
+NativeSymbolModule::LinkSymbol(
+	OUT SYMBOL** Reference,
+	IN DWORD TypeIndex,
+	IN DECODE_CONTEXT* Context
+	)
+{
+	if (Context != nullptr)
+	{
+		//
+		// Parallel decoding - the reference is resolved
+		// after all type records are decoded.
+		//
+
+		Context->References.push_back({ Reference, TypeIndex });
+		return;
+	}
+
+	SYMBOL* Symbol = GetSymbol(TypeIndex);
+
+	if (Reference != nullptr)
+	{
+		*Reference = Symbol;
+	}
+}
+
+VOID
+NativeSymbolModule::FinalizeSymbol(
+	IN SYMBOL* Symbol,
+	IN DECODE_CONTEXT* Context
+	)
+{
+	if (Context != nullptr)
+	{
+		Context->Fixups.push_back({ Symbol, 0 });
+		return;
+	}
+
+	if (m_IsDecoding)
+	{
+		//
+		// Serial decoding - the referenced symbols
+		// may be still waiting in the queue.
+		//
+
+		m_PendingFixups.push_back({ Symbol, 0 });
+		return;
+	}
+
+	switch (Symbol->Tag)
+	{
+		case SymTagPointerType:
+			GuessMachineType(Symbol);
+			break;
+
+		case SymTagArrayType:
+			Symbol->u.Array.ElementCount = Symbol->u.Array.ElementType->Size
+				? Symbol->Size / Symbol->u.Array.ElementType->Size
+				: 0;
+			break;
+
+		case SymTagUDT:
+			CreatePaddingMember(Symbol);
+			break;
+
+		default:
+			break;
+	}
+}
+
+VOID
+NativeSymbolModule::SetEnumUnderlyingType(
+	IN SYMBOL* Symbol,
+	IN const SYMBOL* UnderlyingType
+	)
+{
+	Symbol->BaseType = UnderlyingType->BaseType;
+	Symbol->Size     = UnderlyingType->Size;
+
+	//
+	// Type of the value is derived from the underlying type,
+	// just like DIA does.  Until now, the values were kept
+	// as 64-bit integers.
+	//
+
+	BOOL IsSigned =
+		UnderlyingType->BaseType == btInt ||
+		UnderlyingType->BaseType == btLong ||
+		UnderlyingType->BaseType == btChar;
+
+	for (DWORD Index = 0; Index < Symbol->u.Enum.FieldCount; Index++)
+	{
+		VARIANT& Value = Symbol->u.Enum.Fields[Index].Value;
+		ULONGLONG RawValue = Value.ullVal;
+
+		switch (Symbol->Size)
+		{
+			case 1:
+				Value.vt = IsSigned ? VT_I1 : VT_UI1;
+				Value.bVal = static_cast<BYTE>(RawValue);
+				break;
+
+			case 2:
+				Value.vt = IsSigned ? VT_I2 : VT_UI2;
+				Value.uiVal = static_cast<USHORT>(RawValue);
+				break;
+
+			case 8:
+				Value.vt = IsSigned ? VT_I8 : VT_UI8;
+				Value.ullVal = RawValue;
+				break;
+
+			default:
+				Value.vt = IsSigned ? VT_I4 : VT_UI4;
+				Value.ulVal = static_cast<ULONG>(RawValue);
+				break;
+		}
+	}
+}
+
+Arena&
+NativeSymbolModule::GetArena(
+	IN DECODE_CONTEXT* Context
+	)
+{
+	//
+	// Each worker allocates from its own arena.
+	//
+
+	return Context != nullptr
+		? Context->Allocator
+		: m_Arena;
+}
+
+VOID
+NativeSymbolModule::ProcessSimpleType(
+	IN DWORD TypeIndex,
+	IN SYMBOL* Symbol,
+	IN DECODE_CONTEXT* Context
+	)
+{
+	switch (CV_SIMPLE_TYPE_MODE(TypeIndex))
+	{
+		case CV_TM_DIRECT:
+		{
+			const SimpleTypeMapElement* SimpleType = GetSimpleType(TypeIndex);
+
+			Symbol->Tag = SymTagBaseType;
+
+			if (SimpleType != nullptr)
+			{
+				Symbol->BaseType = SimpleType->BaseType;
+				Symbol->Size     = SimpleType->Size;
+			}
+			break;
+		}
+
+		default:
+		{
+			//
+			// Pointer to the simple type, ie. T_64PVOID.
+			//
+
+			Symbol->Tag  = SymTagPointerType;
+			Symbol->Size = CV_SIMPLE_TYPE_MODE(TypeIndex) == CV_TM_NPTR64 ? 8 : 4;
+
+			Symbol->u.Pointer.IsReference = FALSE;
+
+			LinkSymbol(&Symbol->u.Pointer.Type, CV_SIMPLE_TYPE_KIND(TypeIndex), Context);
+			FinalizeSymbol(Symbol, Context);
+			break;
+		}
+	}
+}
+
+VOID
+NativeSymbolModule::ProcessSymbolModifier(
+	IN const CV_RECORD_HEADER* Record,
+	IN SYMBOL* Symbol,
+	IN DECODE_CONTEXT* Context
+	)
+{
+	//
+	// DIA does not have any notion of modifier types.
+	// Instead, const/volatile type is a standalone copy
+	// of the modified type with the IsConst/IsVolatile flag set.
+	//
+	// Modifiers of modifiers are resolved at once (without
+	// the recursion), see ResolveModifiedType.
+	//
+
+	DWORD TypeIndex = Symbol->TypeId;
+
+	MODIFIED_TYPE ModifiedType = ResolveModifiedType(TypeIndex);
+
+	if (ModifiedType.TypeIndex == TypeIndex)
+	{
+		return;
+	}
+
+	InitSymbol(ModifiedType.TypeIndex, Symbol, Context);
+
+	Symbol->TypeId      = TypeIndex;
+	Symbol->IsConst    |= (ModifiedType.Modifiers & CV_MODIFIER_CONST) ? TRUE : FALSE;
+	Symbol->IsVolatile |= (ModifiedType.Modifiers & CV_MODIFIER_VOLATILE) ? TRUE : FALSE;
+}
+
+VOID
+NativeSymbolModule::ProcessSymbolPointer(
+	IN const CV_RECORD_HEADER* Record,
+	IN SYMBOL* Symbol,
+	IN DECODE_CONTEXT* Context
+	)
+{
+	const BYTE* Data = GetRecordData(Record);
+	const BYTE* End = GetRecordEnd(Record);
+
+	CV_POINTER_RECORD Pointer;
+
+	if (!ReadValue(Data, End, Pointer))
+	{
+		return;
+	}
+
+	//
+	// Attributes:
+	//   bits  0 -  4 ... pointer type
+	//   bits  5 -  7 ... pointer mode
+	//   bit   9      ... volatile
+	//   bit  10      ... const
+	//   bits 13 - 18 ... size of the pointer
+	//
+
+	DWORD PointerMode = (Pointer.Attributes >> 5) & 0x07;
+
+	Symbol->Tag        = SymTagPointerType;
+	Symbol->Size       = (Pointer.Attributes >> 13) & 0x3F;
+	Symbol->IsVolatile = (Pointer.Attributes & 0x200) ? TRUE : FALSE;
+	Symbol->IsConst    = (Pointer.Attributes & 0x400) ? TRUE : FALSE;
+
+	Symbol->u.Pointer.IsReference =
+		PointerMode == CV_PTR_MODE_LVREF ||
+		PointerMode == CV_PTR_MODE_RVREF;
+
+	LinkSymbol(&Symbol->u.Pointer.Type, Pointer.ReferentType, Context);
+	FinalizeSymbol(Symbol, Context);
+}
+
+VOID
+NativeSymbolModule::ProcessSymbolArray(
+	IN const CV_RECORD_HEADER* Record,
+	IN SYMBOL* Symbol,
+	IN DECODE_CONTEXT* Context
+	)
+{
+	const BYTE* Data = GetRecordData(Record);
+	const BYTE* End = GetRecordEnd(Record);
+
+	CV_ARRAY_RECORD Array;
+	LONGLONG Size;
+
+	if (!ReadValue(Data, End, Array) ||
+	    !ReadNumeric(Data, End, Size))
+	{
+		return;
+	}
+
+	Symbol->Tag  = SymTagArrayType;
+	Symbol->Size = static_cast<DWORD>(Size);
+
+	//
+	// Element count is computed when the element type is known.
+	//
+
+	LinkSymbol(&Symbol->u.Array.ElementType, Array.ElementType, Context);
+	FinalizeSymbol(Symbol, Context);
+}
+
+VOID
+NativeSymbolModule::ProcessSymbolFunction(
+	IN const CV_RECORD_HEADER* Record,
+	IN SYMBOL* Symbol,
+	IN DECODE_CONTEXT* Context
+	)
+{
+	const BYTE* Data = GetRecordData(Record);
+	const BYTE* End = GetRecordEnd(Record);
+
+	DWORD ReturnType;
+	BYTE CallingConvention;
+	DWORD ArgumentList;
+
+	if (Record->Kind == LF_PROCEDURE)
+	{
+		CV_PROCEDURE_RECORD Procedure;
+
+		if (!ReadValue(Data, End, Procedure))
+		{
+			return;
+		}
+
+		ReturnType        = Procedure.ReturnType;
+		CallingConvention = Procedure.CallingConvention;
+		ArgumentList      = Procedure.ArgumentList;
+	}
+	else
+	{
+		CV_MFUNCTION_RECORD MemberFunction;
+
+		if (!ReadValue(Data, End, MemberFunction))
+		{
+			return;
+		}
+
+		ReturnType        = MemberFunction.ReturnType;
+		CallingConvention = MemberFunction.CallingConvention;
+		ArgumentList      = MemberFunction.ArgumentList;
+	}
+
+	Symbol->Tag = SymTagFunctionType;
+
+	//
+	// Calling convention.
+	//
+
+	Symbol->u.Function.CallingConvention = static_cast<CV_call_e>(CallingConvention);
+
+	//
+	// Return type.
+	//
+
+	LinkSymbol(&Symbol->u.Function.ReturnType, ReturnType, Context);
+
+	//
+	// Arguments.
+	//
+
+	const CV_RECORD_HEADER* ArgumentListRecord = GetTypeRecord(ArgumentList);
+
+	if (ArgumentListRecord == nullptr || ArgumentListRecord->Kind != LF_ARGLIST)
+	{
+		return;
+	}
+
+	Data = GetRecordData(ArgumentListRecord);
+	End = GetRecordEnd(ArgumentListRecord);
+
+	DWORD ArgumentCount;
+
+	if (!ReadValue(Data, End, ArgumentCount) ||
+	    ArgumentCount > (End - Data) / sizeof(DWORD))
+	{
+		return;
+	}
+
+	Symbol->u.Function.ArgumentCount = ArgumentCount;
+	Symbol->u.Function.Arguments = GetArena(Context).Allocate<SYMBOL*>(ArgumentCount);
+
+	for (DWORD Index = 0; Index < ArgumentCount; Index++)
+	{
+		DWORD ArgumentType;
+
+		if (!ReadValue(Data, End, ArgumentType))
+		{
+			Symbol->u.Function.ArgumentCount = Index;
+			return;
+		}
+
+		//
+		// Argument symbols are not backed by any type record.
+		//
+
+		SYMBOL* Argument = GetArena(Context).Allocate<SYMBOL>();
+		Argument->Tag = SymTagFunctionArgType;
+		Argument->TypeId = ArgumentType;
+
+		LinkSymbol(&Argument->u.FunctionArg.Type, ArgumentType, Context);
+
+		Symbol->u.Function.Arguments[Index] = Argument;
+	}
+}
+
+VOID
+NativeSymbolModule::ProcessSymbolEnum(
+	IN const CV_RECORD_HEADER* Record,
+	IN SYMBOL* Symbol,
+	IN DECODE_CONTEXT* Context
+	)
+{
+	TAG_RECORD Tag;
+
+	if (!DecodeTagRecord(Record, Tag))
+	{
+		return;
+	}
+
+	Symbol->Tag      = SymTagEnum;
+	Symbol->Name     = Tag.Name;
+
+	FieldList Members;
+	ReadFieldList(Tag.FieldList, Members);
+
+	DWORD FieldCount = 0;
+
+	for (auto&& Member : Members)
+	{
+		FieldCount += Member.Kind == LF_ENUMERATE;
+	}
+
+	Symbol->u.Enum.FieldCount = FieldCount;
+	Symbol->u.Enum.Fields = GetArena(Context).Allocate<SYMBOL_ENUM_FIELD>(FieldCount);
+
+	DWORD Index = 0;
+
+	for (auto&& Member : Members)
+	{
+		if (Member.Kind != LF_ENUMERATE)
+		{
+			continue;
+		}
+
+		SYMBOL_ENUM_FIELD* EnumValue = &Symbol->u.Enum.Fields[Index];
+
+		EnumValue->Parent = Symbol;
+		EnumValue->Name = Member.Name;
+
+		VariantInit(&EnumValue->Value);
+		EnumValue->Value.vt = VT_I8;
+		EnumValue->Value.ullVal = static_cast<ULONGLONG>(Member.Value);
+
+		Index += 1;
+	}
+
+	//
+	// Size and the type of the values are taken
+	// from the underlying type.
+	//
+
+	if (Context != nullptr)
+	{
+		Context->References.push_back({ nullptr, Tag.UnderlyingType });
+		Context->Fixups.push_back({ Symbol, Tag.UnderlyingType });
+		return;
+	}
+
+	m_PendingFixups.push_back({ Symbol, Tag.UnderlyingType });
+	GetSymbol(Tag.UnderlyingType);
+}
+
+VOID
+NativeSymbolModule::ProcessSymbolUdt(
+	IN const CV_RECORD_HEADER* Record,
+	IN SYMBOL* Symbol,
+	IN DECODE_CONTEXT* Context
+	)
+{
+	TAG_RECORD Tag;
+
+	if (!DecodeTagRecord(Record, Tag))
+	{
+		return;
+	}
+
+	Symbol->Tag        = SymTagUDT;
+	Symbol->Size       = static_cast<DWORD>(Tag.Size);
+	Symbol->Name       = Tag.Name;
+	Symbol->u.Udt.Kind = Tag.Kind;
+
+	FieldList Members;
+	ReadFieldList(Tag.FieldList, Members);
+
+	//
+	// Only non-static data members are of our interest.
+	//
+
+	DWORD FieldCount = 0;
+
+	for (auto&& Member : Members)
+	{
+		FieldCount += Member.Kind == LF_MEMBER;
+	}
+
+	Symbol->u.Udt.FieldCount = FieldCount;
+	Symbol->u.Udt.Fields = GetArena(Context).Allocate<SYMBOL_UDT_FIELD>(FieldCount + 1);
+
+	DWORD Index = 0;
+
+	for (auto&& Member : Members)
+	{
+		if (Member.Kind != LF_MEMBER)
+		{
+			continue;
+		}
+
+		SYMBOL_UDT_FIELD* UdtField = &Symbol->u.Udt.Fields[Index];
+
+		UdtField->Name = Member.Name;
+		UdtField->Parent = Symbol;
+		UdtField->Offset = static_cast<DWORD>(Member.Value);
+		UdtField->Bits = 0;
+		UdtField->BitPosition = 0;
+
+		//
+		// Bitfield members have their own type record,
+		// which wraps the actual type.
+		//
+
+		const CV_RECORD_HEADER* MemberTypeRecord = GetTypeRecord(Member.Type);
+		DWORD MemberType = Member.Type;
+
+		if (MemberTypeRecord != nullptr && MemberTypeRecord->Kind == LF_BITFIELD)
+		{
+			const BYTE* Data = GetRecordData(MemberTypeRecord);
+			const BYTE* End = GetRecordEnd(MemberTypeRecord);
+
+			CV_BITFIELD_RECORD BitField;
+
+			if (ReadValue(Data, End, BitField))
+			{
+				UdtField->Bits = BitField.Length;
+				UdtField->BitPosition = BitField.Position;
+				MemberType = BitField.Type;
+			}
+		}
+
+		LinkSymbol(&UdtField->Type, MemberType, Context);
+
+		Index += 1;
+	}
+
+	//
+	// Padding.
+	//
+	FinalizeSymbol(Symbol, Context);
+}
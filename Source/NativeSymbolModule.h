@@ -0,0 +1,383 @@
+#pragma once
+#include "SymbolModule.h"
+#include "CodeView.h"
+#include "MSF.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class ThreadPool;
+
+//
+// PDB reader which does not depend on the msdia140.dll.
+//
+// The PDB file is memory-mapped and the TPI stream is decoded
+// directly into the SYMBOL structures.  Only PDB files can be
+// opened - there is no support for locating the PDB of an executable.
+//
+// Names of the symbols are not copied, they point straight into
+// the TPI stream - either into the mapped file, or into the buffer
+// of the stream, if its blocks aren't contiguous.
+//
+// Type records are decoded lazily, when they're first looked up
+// (by name or by type index).  The whole symbol map is built only
+// when it is requested - in that case the type records are decoded
+// in parallel.
+//
+class NativeSymbolModule
+	: public SymbolModule
+{
+	public:
+		NativeSymbolModule();
+
+		~NativeSymbolModule();
+
+		BOOL
+		Open(
+			IN const CHAR* Path
+			) override;
+
+		BOOL
+		IsOpen() const override;
+
+		VOID
+		Close() override;
+
+		SYMBOL*
+		GetSymbolByName(
+			IN const CHAR* SymbolName
+			) override;
+
+		SYMBOL*
+		GetSymbolByTypeId(
+			IN DWORD TypeId
+			) override;
+
+		const SymbolMap&
+		GetSymbolMap() override;
+
+		const SymbolNameMap&
+		GetSymbolNameMap() override;
+
+		VOID
+		GetUnnamedSymbols(
+			OUT std::vector<const SYMBOL*>& Symbols
+			) override;
+
+	private:
+		//
+		// Member of the LF_FIELDLIST record.
+		//
+		struct FIELD_LIST_MEMBER
+		{
+			WORD                 Kind;
+			DWORD                Type;
+			LONGLONG             Value;
+			const CHAR*          Name;
+		};
+
+		using FieldList = std::vector<FIELD_LIST_MEMBER>;
+
+		//
+		// Parallel decoding.
+		//
+		// Workers don't touch the shared state - references to other
+		// symbols are recorded and linked (by type index) after all
+		// type records are decoded.  The same goes for everything
+		// which depends on the referenced symbols (see FinalizeSymbol).
+		//
+
+		struct PENDING_REFERENCE
+		{
+			SYMBOL**             Reference;
+			DWORD                TypeIndex;
+		};
+
+		struct PENDING_FIXUP
+		{
+			SYMBOL*              Symbol;
+			DWORD                TypeIndex;
+		};
+
+		struct DECODE_CONTEXT
+		{
+			std::vector<PENDING_REFERENCE> References;
+			std::vector<PENDING_FIXUP>     Fixups;
+			Arena                          Allocator;
+		};
+
+		//
+		// Serial decoding.
+		//
+		// Symbols are decoded from a queue instead of recursively,
+		// so that deep type graphs (long chains of nested types)
+		// don't exhaust the stack.  Fixups wait until the queue
+		// is drained.
+		//
+
+		struct PENDING_SYMBOL
+		{
+			SYMBOL*              Symbol;
+			DWORD                TypeIndex;
+		};
+
+		//
+		// Innermost type of a chain of modifiers (the first one which
+		// is not a modifier) together with the combined modifiers.
+		//
+
+		struct MODIFIED_TYPE
+		{
+			DWORD                TypeIndex;
+			WORD                 Modifiers;
+		};
+
+		//
+		// Symbol decoded from the type record at particular type index.
+		// References and fixups of the symbol are stored in the context
+		// of the worker which decoded it.
+		//
+
+		struct DECODE_SLOT
+		{
+			SYMBOL*              Symbol;
+			DWORD                Worker;
+			DWORD                ReferenceBegin;
+			DWORD                ReferenceEnd;
+			DWORD                FixupBegin;
+			DWORD                FixupEnd;
+			BOOL                 IsReachable;
+		};
+
+	private:
+		BOOL
+		LoadDbiStream();
+
+		BOOL
+		LoadTpiStream();
+
+		BOOL
+		LoadTpiHashStream();
+
+		BOOL
+		LoadIndexOffsets();
+
+		BOOL
+		ScanTypeRecords(
+			IN DWORD TypeIndex,
+			IN DWORD Offset,
+			IN DWORD TypeIndexEnd
+			);
+
+		VOID
+		BuildDefinitionIndex();
+
+		VOID
+		BuildHashBuckets();
+
+		DWORD
+		FindDefinitionByHash(
+			IN const CHAR* Name,
+			IN BOOL IsUniqueName
+			);
+
+		DWORD
+		FindDefinitionByName(
+			IN const CHAR* Name
+			);
+
+		VOID
+		BuildFunctionSet(
+			IN const MSFStream& SymbolRecordStream
+			);
+
+		VOID
+		GetDefinitions(
+			OUT std::vector<DWORD>& TypeIndices
+			);
+
+		VOID
+		BuildSymbolMap();
+
+		BOOL
+		BuildSymbolMapParallel(
+			IN ThreadPool& Pool
+			);
+
+		const CV_RECORD_HEADER*
+		GetTypeRecord(
+			IN DWORD TypeIndex
+			);
+
+		DWORD
+		ResolveForwardReference(
+			IN DWORD TypeIndex
+			);
+
+		MODIFIED_TYPE
+		ResolveModifiedType(
+			IN DWORD TypeIndex
+			);
+
+		VOID
+		ReadFieldList(
+			IN DWORD TypeIndex,
+			OUT FieldList& Members
+			);
+
+		SYMBOL*
+		GetSymbol(
+			IN DWORD TypeIndex
+			);
+
+		VOID
+		DecodePendingSymbols();
+
+		VOID
+		InitSymbol(
+			IN DWORD TypeIndex,
+			IN SYMBOL* Symbol,
+			IN DECODE_CONTEXT* Context
+			);
+
+		//
+		// Helpers for the decoding.  When the Context is nullptr
+		// (serial decoding), the referenced symbols are queued
+		// and the fixups are deferred until the queue is drained.
+		//
+
+		VOID
+		LinkSymbol(
+			OUT SYMBOL** Reference,
+			IN DWORD TypeIndex,
+			IN DECODE_CONTEXT* Context
+			);
+
+		VOID
+		FinalizeSymbol(
+			IN SYMBOL* Symbol,
+			IN DECODE_CONTEXT* Context
+			);
+
+		VOID
+		SetEnumUnderlyingType(
+			IN SYMBOL* Symbol,
+			IN const SYMBOL* UnderlyingType
+			);
+
+		Arena&
+		GetArena(
+			IN DECODE_CONTEXT* Context
+			);
+
+		VOID
+		ProcessSimpleType(
+			IN DWORD TypeIndex,
+			IN SYMBOL* Symbol,
+			IN DECODE_CONTEXT* Context
+			);
+
+		VOID
+		ProcessSymbolModifier(
+			IN const CV_RECORD_HEADER* Record,
+			IN SYMBOL* Symbol,
+			IN DECODE_CONTEXT* Context
+			);
+
+		VOID
+		ProcessSymbolPointer(
+			IN const CV_RECORD_HEADER* Record,
+			IN SYMBOL* Symbol,
+			IN DECODE_CONTEXT* Context
+			);
+
+		VOID
+		ProcessSymbolArray(
+			IN const CV_RECORD_HEADER* Record,
+			IN SYMBOL* Symbol,
+			IN DECODE_CONTEXT* Context
+			);
+
+		VOID
+		ProcessSymbolFunction(
+			IN const CV_RECORD_HEADER* Record,
+			IN SYMBOL* Symbol,
+			IN DECODE_CONTEXT* Context
+			);
+
+		VOID
+		ProcessSymbolEnum(
+			IN const CV_RECORD_HEADER* Record,
+			IN SYMBOL* Symbol,
+			IN DECODE_CONTEXT* Context
+			);
+
+		VOID
+		ProcessSymbolUdt(
+			IN const CV_RECORD_HEADER* Record,
+			IN SYMBOL* Symbol,
+			IN DECODE_CONTEXT* Context
+			);
+
+	private:
+		MSFFile              m_File;
+		MSFStream            m_TpiStream;
+		TPI_STREAM_HEADER    m_TpiHeader = {};
+		MSFStream            m_TpiHashStream;
+
+		//
+		// Offset of each type record within the TPI stream,
+		// indexed by (TypeIndex - TypeIndexBegin).
+		// Zero if the offset hasn't been determined yet.
+		//
+		std::vector<DWORD>   m_TypeRecordOffsets;
+
+		//
+		// Entries of the index-offset buffer of the TPI hash stream.
+		// Offsets are relative to the start of the TPI stream.
+		//
+		std::vector<TPI_INDEX_OFFSET> m_IndexOffsets;
+
+		//
+		// Forward references of UDTs and enums
+		// mapped to the type index of their definition.
+		//
+		std::unordered_map<DWORD, DWORD> m_ForwardReferences;
+
+		//
+		// Modifiers mapped to their resolved modified type
+		// (see ResolveModifiedType).
+		//
+		std::unordered_map<DWORD, MODIFIED_TYPE> m_ModifiedTypes;
+		std::vector<std::pair<DWORD, WORD>> m_ModifierChain;
+
+		//
+		// Chains of the type records sharing the same hash value,
+		// indexed by (TypeIndex - TypeIndexBegin).  Built on the first
+		// lookup from the hash value buffer of the TPI hash stream.
+		//
+		std::vector<DWORD>   m_HashBucketHeads;
+		std::vector<DWORD>   m_HashBucketNext;
+		BOOL                 m_HasHashValues = FALSE;
+
+		//
+		// Definitions of UDTs and enums, keyed by their (unique) name.
+		// Names point directly into the TPI stream.
+		// Used when the TPI hash stream does not have hash values
+		// (or when the name cannot be found through them).
+		//
+		std::unordered_map<std::string_view, DWORD> m_DefinitionsByKey;
+		std::unordered_map<std::string_view, DWORD> m_DefinitionsByName;
+
+		BOOL                 m_IsDefinitionIndexBuilt = FALSE;
+		BOOL                 m_IsSymbolMapBuilt = FALSE;
+
+		//
+		// Queue of the serial decoding (see DecodePendingSymbols).
+		//
+		std::vector<PENDING_SYMBOL> m_PendingSymbols;
+		std::vector<PENDING_FIXUP>  m_PendingFixups;
+		BOOL                 m_IsDecoding = FALSE;
+};
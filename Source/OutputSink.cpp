@@ -0,0 +1,64 @@
+#include "OutputSink.h"
+
+#include <chrono>
+
+#include <cstdarg>
+#include <cstdio>
+
+VOID
+OutputSink::WriteFormatted(
+	IN const CHAR* Format,
+	...
+	)
+{
+	va_list ArgList;
+	va_list ArgListCopy;
+
+	va_start(ArgList, Format);
+	va_copy(ArgListCopy, ArgList);
+
+	int Length = vsnprintf(nullptr, 0, Format, ArgListCopy);
+
+	va_end(ArgListCopy);
+
+	if (Length > 0)
+	{
+		//
+		// Format directly into the buffer (vsnprintf needs
+		// one extra byte for the terminating null character).
+		//
+
+		size_t Size = m_Buffer.size();
+
+		m_Buffer.resize(Size + Length + 1);
+		vsnprintf(&m_Buffer[Size], Length + 1, Format, ArgList);
+		m_Buffer.resize(Size + Length);
+	}
+
+	m_WriteStatistics.Count += 1;
+
+	va_end(ArgList);
+}
+
+VOID
+OutputSink::Flush(
+	IN std::ostream& Output
+	)
+{
+	if (!m_Buffer.empty())
+	{
+		if (Output.rdbuf() != nullptr)
+		{
+			auto Start = std::chrono::steady_clock::now();
+
+			Output.write(m_Buffer.data(), m_Buffer.size());
+
+			m_WriteStatistics.Size += m_Buffer.size();
+			m_WriteStatistics.Nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - Start
+				).count();
+		}
+
+		m_Buffer.clear();
+	}
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include "Platform.h"
+
+#include <cstring>
+#include <ostream>
+#include <string>
+
+//
+// Append-only output buffer.
+//
+// Text is collected in a large buffer and written into the output
+// stream only by Flush(), in one piece.  The common pieces of the
+// output (strings, runs of spaces, decimal and hexadecimal numbers)
+// are appended directly, without going through printf-like formatting;
+// WriteFormatted() is available for everything else.
+//
+class OutputSink
+{
+	public:
+		static constexpr size_t DefaultCapacity = 256 * 1024;
+
+		//
+		// Count of the Write*() calls, bytes passed to the output
+		// streams by Flush() and the time it took (discarding streams
+		// are not counted).
+		//
+		struct WriteStatistics
+		{
+			ULONGLONG Size        = 0;
+			ULONGLONG Count       = 0;
+			ULONGLONG Nanoseconds = 0;
+		};
+
+		OutputSink(
+			IN size_t Capacity = DefaultCapacity
+			)
+		{
+			m_Buffer.reserve(Capacity);
+		}
+
+		//
+		// Number of bytes waiting for the Flush().
+		//
+		size_t
+		GetSize() const
+		{
+			return m_Buffer.size();
+		}
+
+		//
+		// Bytes waiting for the Flush(), starting at the Offset.
+		//
+		std::string
+		GetBuffered(
+			IN size_t Offset
+			) const
+		{
+			return m_Buffer.substr(Offset);
+		}
+
+		VOID
+		Write(
+			IN const CHAR* String,
+			IN size_t Length
+			)
+		{
+			m_Buffer.append(String, Length);
+			m_WriteStatistics.Count += 1;
+		}
+
+		//
+		// Inlined, so the length of string literals
+		// is computed at the compile time.
+		//
+		VOID
+		Write(
+			IN const CHAR* String
+			)
+		{
+			Write(String, strlen(String));
+		}
+
+		VOID
+		Write(
+			IN const std::string& String
+			)
+		{
+			Write(String.data(), String.size());
+		}
+
+		VOID
+		WriteSpaces(
+			IN size_t Count
+			)
+		{
+			m_Buffer.append(Count, ' ');
+			m_WriteStatistics.Count += 1;
+		}
+
+		//
+		// Same as printf("%lld").
+		//
+		VOID
+		WriteDecimal(
+			IN LONGLONG Value
+			)
+		{
+			CHAR Digits[24];
+			CHAR* Begin = &Digits[sizeof(Digits)];
+
+			ULONGLONG Magnitude = Value < 0
+				? 0 - static_cast<ULONGLONG>(Value)
+				: static_cast<ULONGLONG>(Value);
+
+			do
+			{
+				*--Begin = static_cast<CHAR>('0' + Magnitude % 10);
+				Magnitude /= 10;
+			} while (Magnitude != 0);
+
+			if (Value < 0)
+			{
+				*--Begin = '-';
+			}
+
+			Write(Begin, &Digits[sizeof(Digits)] - Begin);
+		}
+
+		//
+		// Same as printf("%0*llx", MinimumDigits).
+		//
+		VOID
+		WriteHex(
+			IN ULONGLONG Value,
+			IN DWORD MinimumDigits = 1
+			)
+		{
+			static const CHAR HexDigits[] = "0123456789abcdef";
+
+			CHAR Digits[16];
+			CHAR* Begin = &Digits[sizeof(Digits)];
+
+			do
+			{
+				*--Begin = HexDigits[Value & 0xf];
+				Value >>= 4;
+			} while (Value != 0);
+
+			size_t Length = &Digits[sizeof(Digits)] - Begin;
+
+			if (Length < MinimumDigits)
+			{
+				m_Buffer.append(MinimumDigits - Length, '0');
+			}
+
+			Write(Begin, Length);
+		}
+
+		//
+		// Drops the bytes waiting for the Flush(), starting at the Offset.
+		//
+		VOID
+		Truncate(
+			IN size_t Offset
+			)
+		{
+			m_Buffer.resize(Offset);
+		}
+
+		VOID
+		WriteFormatted(
+			IN const CHAR* Format,
+			...
+			);
+
+		//
+		// Writes the buffered content into the Output
+		// and empties the buffer.
+		//
+		VOID
+		Flush(
+			IN std::ostream& Output
+			);
+
+		const WriteStatistics&
+		GetWriteStatistics() const
+		{
+			return m_WriteStatistics;
+		}
+
+	private:
+		std::string m_Buffer;
+		WriteStatistics m_WriteStatistics;
+};
@@ -1,14 +1,11 @@
 #pragma once
-#define _CRT_SECURE_NO_WARNINGS
-#include <windows.h>
-
-#include <dia2.h>
+#include "Platform.h"
+#include "SymbolMap.h"
 
 #include <set>
-#include <unordered_set>
+#include <string>
 #include <unordered_map>
-
-typedef struct _SYMBOL SYMBOL, *PSYMBOL;
+#include <vector>
 
 //
 // Representation of the enum field.
@@ -28,7 +25,7 @@ typedef struct _SYMBOL_ENUM_FIELD
 	//
 	// Name of the enumeration field.
 	//
-	CHAR*                Name;
+	const CHAR*          Name;
 
 	//
 	// Assigned value of the enumeration field.
@@ -59,7 +56,7 @@ typedef struct _SYMBOL_UDT_FIELD
 	//
 	// Name of the UDT field.
 	//
-	CHAR*                Name;
+	const CHAR*          Name;
 
 	//
 	// Type of the field.
@@ -270,7 +267,7 @@ struct _SYMBOL
 	//
 	// Name of the type.
 	//
-	CHAR*                Name;
+	const CHAR*          Name;
 
 	union
 	{
@@ -285,15 +282,33 @@ struct _SYMBOL
 };
 
 class SymbolModule;
+class PDBUdtLayout;
+class Trace;
 
-using SymbolMap     = std::unordered_map<DWORD, SYMBOL*>;
 using SymbolNameMap = std::unordered_map<std::string, SYMBOL*>;
-using SymbolSet     = std::unordered_set<SYMBOL*>;
 using FunctionSet   = std::set<std::string>;
 
 class PDB
 {
 	public:
+		enum class ReaderType
+		{
+			//
+			// DIA on Windows, native reader elsewhere.
+			//
+			Default,
+
+			//
+			// Read the PDB via msdia140.dll (Windows only).
+			//
+			Dia,
+
+			//
+			// Read the memory-mapped PDB file directly.
+			//
+			Native,
+		};
+
 		//
 		// Default constructor.
 		//
@@ -303,7 +318,8 @@ class PDB
 		// Instantiates PDB class with particular PDB file.
 		//
 		PDB(
-			IN const CHAR* Path
+			IN const CHAR* Path,
+			IN ReaderType Reader = ReaderType::Default
 			);
 
 		//
@@ -314,11 +330,26 @@ class PDB
 		//
 		// Opens particular PDB file and parses it.
 		//
+		// ThreadCount limits the number of threads used for decoding
+		// the symbols (0 = one thread per CPU).
+		//
+		// If CacheDirectory is provided, the symbols are loaded
+		// from the cache file of the PDB stored in it.  If there is
+		// no valid cache file yet, the PDB is parsed as usual
+		// and the cache file is (re)created.
+		//
+		// If Tracer is provided, the decoding of the symbols
+		// is recorded into it (see Trace).
+		//
 		// Returns non-zero value on success.
 		//
 		BOOL
 		Open(
-			IN const CHAR* Path
+			IN const CHAR* Path,
+			IN ReaderType Reader = ReaderType::Default,
+			IN DWORD ThreadCount = 0,
+			IN const CHAR* CacheDirectory = nullptr,
+			IN Trace* Tracer = nullptr
 			);
 
 		//
@@ -351,6 +382,16 @@ class PDB
 		CV_CFL_LANG
 		GetLanguage() const;
 
+		//
+		// Get number of bytes reserved for the symbols
+		// and number of bytes actually used by them.
+		//
+		size_t
+		GetReservedSymbolMemory() const;
+
+		size_t
+		GetUsedSymbolMemory() const;
+
 		//
 		// Returns a SYMBOL structure of particular name.
 		//
@@ -377,18 +418,54 @@ class PDB
 		const SymbolMap&
 		GetSymbolMap() const;
 
+		//
+		// Returns collection of the symbols decoded so far
+		// (the readers decode the symbols on demand).
+		//
+		const SymbolMap&
+		GetDecodedSymbolMap() const;
+
 		//
 		// Returns collection of all named symbols.
 		//
 		const SymbolNameMap&
 		GetSymbolNameMap() const;
 
+		//
+		// Returns all unnamed UDTs and enums (see IsUnnamedSymbol()),
+		// without decoding the rest of the symbols, if the reader can.
+		//
+		VOID
+		GetUnnamedSymbols(
+			OUT std::vector<const SYMBOL*>& Symbols
+			) const;
+
 		//
 		// Returns collection of all named functions.
 		//
 		const FunctionSet&
 		GetFunctionSet() const;
 
+		//
+		// Returns the layout of the UDT (members, anonymous
+		// unions/structs, bitfields and paddings).
+		// It is computed only once per UDT.
+		//
+		const PDBUdtLayout&
+		GetUdtLayout(
+			IN const SYMBOL* Symbol
+			) const;
+
+		//
+		// Get number of the UDT layouts computed so far
+		// and number of the padding members synthesized in them.
+		//
+		size_t
+		GetUdtLayoutCount() const;
+
+		size_t
+		GetPaddingMemberCount() const;
+
 		//
 		// Returns C-like name of the type of provided symbol.
 		// The symbol must be BaseType.
@@ -438,6 +515,12 @@ class PDB
 			const SYMBOL* Symbol
 			);
 
+		static
+		BOOL
+		IsUnnamedSymbolName(
+			const CHAR* SymbolName
+			);
+
 	private:
 		SymbolModule* m_Impl;
 };
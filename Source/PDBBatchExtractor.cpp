@@ -0,0 +1,336 @@
+#include "PDBBatchExtractor.h"
+#include "PDBExtractor.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	//
+	// Error messages.
+	//
+
+	static const char* MESSAGE_INVALID_PARAMETERS =
+		"Invalid parameters";
+
+	static const char* MESSAGE_MANIFEST_NOT_FOUND =
+		"Manifest file not found";
+
+	//
+	// Our exception class.
+	//
+
+	class PDBBatchException
+		: public std::runtime_error
+	{
+		public:
+			PDBBatchException(const std::string& Message)
+				: std::runtime_error(Message)
+			{
+
+			}
+	};
+
+	//
+	// Splits the manifest line into arguments.
+	// Arguments are separated by whitespace, double quotes
+	// group the characters (including whitespace) into one argument.
+	//
+
+	bool
+	SplitArguments(
+		const std::string& Line,
+		std::vector<std::string>& Arguments
+		)
+	{
+		size_t Index = 0;
+
+		for (;;)
+		{
+			while (Index < Line.size() && isspace(static_cast<unsigned char>(Line[Index])))
+			{
+				Index++;
+			}
+
+			if (Index == Line.size())
+			{
+				return true;
+			}
+
+			std::string Argument;
+			bool Quoted = false;
+
+			while (Index < Line.size() && (Quoted || !isspace(static_cast<unsigned char>(Line[Index]))))
+			{
+				if (Line[Index] == '"')
+				{
+					Quoted = !Quoted;
+				}
+				else
+				{
+					Argument += Line[Index];
+				}
+
+				Index++;
+			}
+
+			if (Quoted)
+			{
+				return false;
+			}
+
+			Arguments.push_back(std::move(Argument));
+		}
+	}
+}
+
+int
+PDBBatchExtractor::Run(
+	int argc,
+	char** argv
+	)
+{
+	try
+	{
+		ParseParameters(argc, argv);
+		ParseManifest();
+	}
+	catch (const PDBBatchException& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	auto StartTime = std::chrono::steady_clock::now();
+
+	//
+	// Jobs are taken one by one - their duration
+	// differs too much for any static partitioning.
+	//
+
+	ThreadPool Pool(m_Settings.JobCount);
+
+	Pool.ParallelFor(m_Jobs.size(), 1, [this](DWORD, size_t Begin, size_t End) {
+		for (size_t Index = Begin; Index < End; Index++)
+		{
+			RunJob(m_Jobs[Index]);
+		}
+	});
+
+	std::chrono::duration<double, std::milli> Duration = std::chrono::steady_clock::now() - StartTime;
+
+	//
+	// Print the output in the order of the manifest,
+	// independently on the order the jobs finished in.
+	//
+
+	for (auto&& BatchJob : m_Jobs)
+	{
+		std::cout << BatchJob.Output;
+	}
+
+	std::cout.flush();
+
+	PrintSummary(Duration.count());
+
+	for (auto&& BatchJob : m_Jobs)
+	{
+		if (BatchJob.Result != EXIT_SUCCESS)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+void
+PDBBatchExtractor::ParseParameters(
+	int argc,
+	char** argv
+	)
+{
+	//
+	// pdbex --batch <manifest> [--jobs <count>] [options]
+	//
+
+	if (argc < 3 || strcmp(argv[1], "--batch") != 0)
+	{
+		throw PDBBatchException(MESSAGE_INVALID_PARAMETERS);
+	}
+
+	m_Settings.ManifestPath = argv[2];
+
+	//
+	// Parallelism comes from running multiple jobs,
+	// jobs themselves are single-threaded by default.
+	//
+
+	m_Settings.CommonArguments = { "-w", "1" };
+
+	for (int ArgumentPointer = 3; ArgumentPointer < argc; ArgumentPointer++)
+	{
+		if (strcmp(argv[ArgumentPointer], "--jobs") == 0)
+		{
+			if (ArgumentPointer + 1 == argc)
+			{
+				throw PDBBatchException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			m_Settings.JobCount = static_cast<unsigned>(strtoul(argv[++ArgumentPointer], nullptr, 10));
+		}
+		else
+		{
+			m_Settings.CommonArguments.push_back(argv[ArgumentPointer]);
+		}
+	}
+}
+
+void
+PDBBatchExtractor::ParseManifest()
+{
+	std::ifstream Manifest(m_Settings.ManifestPath);
+
+	if (!Manifest)
+	{
+		throw PDBBatchException(MESSAGE_MANIFEST_NOT_FOUND);
+	}
+
+	std::string Line;
+	size_t LineNumber = 0;
+
+	while (std::getline(Manifest, Line))
+	{
+		LineNumber++;
+
+		if (!Line.empty() && Line.back() == '\r')
+		{
+			Line.pop_back();
+		}
+
+		size_t FirstCharacter = Line.find_first_not_of(" \t");
+
+		if (FirstCharacter == std::string::npos || Line[FirstCharacter] == '#')
+		{
+			continue;
+		}
+
+		Job BatchJob;
+		BatchJob.Line = LineNumber;
+
+		//
+		// Each job needs at least <symbol> and <path>.
+		//
+
+		if (!SplitArguments(Line, BatchJob.Arguments) ||
+		    BatchJob.Arguments.size() < 2)
+		{
+			throw PDBBatchException(
+				m_Settings.ManifestPath + "(" + std::to_string(LineNumber) + "): " + MESSAGE_INVALID_PARAMETERS
+				);
+		}
+
+		m_Jobs.push_back(std::move(BatchJob));
+	}
+}
+
+void
+PDBBatchExtractor::RunJob(
+	Job& BatchJob
+	)
+{
+	//
+	// Build the command line as if the job was run separately:
+	// pdbex <symbol> <path> [common options] [job options]
+	//
+
+	std::vector<std::string> Arguments;
+	Arguments.push_back("pdbex");
+	Arguments.push_back(BatchJob.Arguments[0]);
+	Arguments.push_back(BatchJob.Arguments[1]);
+	Arguments.insert(Arguments.end(), m_Settings.CommonArguments.begin(), m_Settings.CommonArguments.end());
+	Arguments.insert(Arguments.end(), BatchJob.Arguments.begin() + 2, BatchJob.Arguments.end());
+
+	std::vector<char*> ArgumentPointers;
+
+	for (auto&& Argument : Arguments)
+	{
+		ArgumentPointers.push_back(&Argument[0]);
+	}
+
+	ArgumentPointers.push_back(nullptr);
+
+	auto StartTime = std::chrono::steady_clock::now();
+
+	std::ostringstream Output;
+
+	try
+	{
+		PDBExtractor Instance;
+
+		BatchJob.Result = Instance.Run(
+			static_cast<int>(Arguments.size()),
+			ArgumentPointers.data(),
+			Output,
+			BatchJob.ErrorMessage
+			);
+	}
+	catch (const std::exception& e)
+	{
+		BatchJob.Result = EXIT_FAILURE;
+		BatchJob.ErrorMessage = e.what();
+	}
+
+	std::chrono::duration<double, std::milli> Duration = std::chrono::steady_clock::now() - StartTime;
+
+	BatchJob.Output = Output.str();
+	BatchJob.Milliseconds = Duration.count();
+}
+
+void
+PDBBatchExtractor::PrintSummary(
+	double Milliseconds
+	)
+{
+	size_t FailedJobCount = 0;
+	double TotalMilliseconds = 0.0;
+
+	fprintf(stderr, "%6s  %-6s  %10s  %s\n", "Line", "Result", "Time (ms)", "Job");
+
+	for (auto&& BatchJob : m_Jobs)
+	{
+		std::string Description = BatchJob.Arguments[0] + " " + BatchJob.Arguments[1];
+
+		if (BatchJob.Result != EXIT_SUCCESS)
+		{
+			Description += " (" + BatchJob.ErrorMessage + ")";
+			FailedJobCount++;
+		}
+
+		fprintf(
+			stderr, "%6zu  %-6s  %10.1f  %s\n",
+			BatchJob.Line,
+			BatchJob.Result == EXIT_SUCCESS ? "OK" : "FAILED",
+			BatchJob.Milliseconds,
+			Description.c_str()
+			);
+
+		TotalMilliseconds += BatchJob.Milliseconds;
+	}
+
+	fprintf(
+		stderr, "%zu job(s), %zu failed, %.1f ms in jobs, %.1f ms elapsed\n",
+		m_Jobs.size(),
+		FailedJobCount,
+		TotalMilliseconds,
+		Milliseconds
+		);
+}
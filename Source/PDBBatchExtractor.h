@@ -0,0 +1,80 @@
+#pragma once
+#include "Platform.h"
+
+#include <string>
+#include <vector>
+
+//
+// Runs multiple extraction jobs listed in the manifest file
+// in a single process.
+//
+// Every job is executed by its own PDBExtractor instance (therefore
+// with its own PDB, header reconstructor and symbol visitor),
+// jobs are distributed among a bounded number of threads.
+//
+class PDBBatchExtractor
+{
+	public:
+		struct Settings
+		{
+			std::string ManifestPath;
+			unsigned JobCount = 0;
+
+			//
+			// Options prepended to the options of each job.
+			//
+			std::vector<std::string> CommonArguments;
+		};
+
+		int Run(
+			int argc,
+			char** argv
+			);
+
+	private:
+		struct Job
+		{
+			//
+			// Line of the manifest the job comes from.
+			//
+			size_t Line = 0;
+
+			//
+			// <symbol> <path> [options]
+			//
+			std::vector<std::string> Arguments;
+
+			//
+			// Content printed to stdout by the job.
+			//
+			std::string Output;
+
+			int Result = 0;
+			std::string ErrorMessage;
+			double Milliseconds = 0.0;
+		};
+
+		void
+		ParseParameters(
+			int argc,
+			char** argv
+			);
+
+		void
+		ParseManifest();
+
+		void
+		RunJob(
+			Job& BatchJob
+			);
+
+		void
+		PrintSummary(
+			double Milliseconds
+			);
+
+	private:
+		Settings m_Settings;
+
+		std::vector<Job> m_Jobs;
+};
@@ -1,13 +1,24 @@
 #include "PDBExtractor.h"
+#include "AllocationCounter.h"
 #include "PDBHeaderReconstructor.h"
 #include "PDBSymbolVisitor.h"
 #include "PDBSymbolSorter.h"
 #include "PDBSymbolSorterAlphabetical.h"
+#include "ThreadPool.h"
 #include "UdtFieldDefinition.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <fstream>
+#include <filesystem>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 
 namespace
 {
@@ -77,6 +88,71 @@ namespace
 
 			}
 	};
+
+	//
+	// One file of the '%' dump.
+	//
+
+	struct SymbolFile
+	{
+		std::filesystem::path Path;
+		const SYMBOL* Symbol = nullptr;
+		std::vector<const SYMBOL*> ReferencedSymbols;
+
+		//
+		// Numbering at the beginning of the file.
+		//
+		PDBHeaderReconstructor::NumberingState State;
+
+		bool IsOverwritten = false;
+	};
+
+	//
+	// Reconstructor and visitor of one thread.
+	//
+
+	struct SymbolPrinter
+	{
+		PDBHeaderReconstructor::Settings Settings;
+		std::unique_ptr<PDBHeaderReconstructor> HeaderReconstructor;
+		std::unique_ptr<PDBSymbolVisitor<UdtFieldDefinition>> SymbolVisitor;
+
+		//
+		// Discards everything written into it.
+		//
+		std::ostream NullOutput{ nullptr };
+
+		void
+		Initialize(
+			const PDB* Pdb,
+			const PDBHeaderReconstructor::Settings& ReconstructorSettings,
+			UdtFieldDefinition::Settings* MemberDefinitionSettings,
+			const PDBUnnamedSymbolNames* UnnamedSymbolNames
+			)
+		{
+			Settings = ReconstructorSettings;
+			Settings.OutputFile = &NullOutput;
+
+			HeaderReconstructor = std::make_unique<PDBHeaderReconstructor>(
+				&Settings
+				);
+
+			HeaderReconstructor->SetUnnamedSymbolNames(UnnamedSymbolNames);
+
+			SymbolVisitor = std::make_unique<PDBSymbolVisitor<UdtFieldDefinition>>(
+				Pdb,
+				HeaderReconstructor.get(),
+				MemberDefinitionSettings
+				);
+		}
+	};
+
+	//
+	// Number of definitions of '*' rendered by the threads
+	// before they're written, bounds the memory held by their text.
+	//
+
+	constexpr size_t PARALLEL_DEFINITION_WINDOW = 4096;
 }
 
 int
@@ -85,7 +161,43 @@ PDBExtractor::Run(
 	char** argv
 	)
 {
-	int Result = ERROR_SUCCESS;
+	std::string ErrorMessage;
+
+	int Result = Run(argc, argv, std::cout, ErrorMessage);
+
+	if (Result != EXIT_SUCCESS)
+	{
+		std::cerr << ErrorMessage << std::endl;
+	}
+
+	return Result;
+}
+
+int
+PDBExtractor::Run(
+	int argc,
+	char** argv,
+	std::ostream& StandardOutput,
+	std::string& ErrorMessage
+	)
+{
+	int Result = EXIT_SUCCESS;
+
+	m_Settings.PdbHeaderReconstructorSettings.OutputFile = &StandardOutput;
+
+	//
+	// Early check for help parameter.  The usage goes to the provided
+	// output as well - the process (which may run other extractions)
+	// is not terminated.
+	//
+
+	if ( argc == 1 ||
+	    (argc == 2 && strcmp(argv[1], "-h") == 0) ||
+	    (argc == 2 && strcmp(argv[1], "--help") == 0))
+	{
+		PrintUsage(StandardOutput);
+		return EXIT_SUCCESS;
+	}
 
 	try
 	{
@@ -108,10 +220,13 @@ PDBExtractor::Run(
 		}
 
 		PrintTestFooter();
+
+		PrintStatistics();
+		WriteTrace();
 	}
 	catch (const PDBDumperException& e)
 	{
-		std::cerr << e.what() << std::endl;
+		ErrorMessage = e.what();
 		Result = EXIT_FAILURE;
 	}
 
@@ -121,46 +236,87 @@ PDBExtractor::Run(
 }
 
 void
-PDBExtractor::PrintUsage()
+PDBExtractor::PrintUsage(
+	std::ostream& Output
+	)
 {
-	printf("Extracts types and structures from PDB (Program database).\n");
-	printf("Version v%s\n", PDBEX_VERSION_STRING);
-	printf("\n");
-	printf("pdbex <symbol> <path> [-o <filename>] [-t <filename>] [-e <type>]\n");
-	printf("                     [-u <prefix>] [-s prefix] [-r prefix] [-g suffix]\n");
-	printf("                     [-p] [-x] [-m] [-b] [-d] [-i] [-l]\n");
-	printf("\n");
-	printf("<symbol>             Symbol name to extract\n");
-	printf("                     Use '*' if all symbols should be extracted.\n");
-	printf("                     Use '%%' if all symbols should be extracted separately.\n");
-	printf("<path>               Path to the PDB file.\n");
-	printf(" -o filename         Specifies the output file.                       (stdout)\n");
-	printf(" -t filename         Specifies the output test file.                  (off)\n");
-	printf(" -e [n,i,a]          Specifies expansion of nested structures/unions. (i)\n");
-	printf("                       n = none            Only top-most type is printed.\n");
-	printf("                       i = inline unnamed  Unnamed types are nested.\n");
-	printf("                       a = inline all      All types are nested.\n");
-	printf(" -u prefix           Unnamed union prefix  (in combination with -d).\n");
-	printf(" -s prefix           Unnamed struct prefix (in combination with -d).\n");
-	printf(" -r prefix           Prefix for all symbols.\n");
-	printf(" -g suffix           Suffix for all symbols.\n");
-	printf("\n");
-	printf("Following options can be explicitly turned off by adding trailing '-'.\n");
-	printf("Example: -p-\n");
-	printf(" -p                  Create padding members.                          (T)\n");
-	printf(" -x                  Show offsets.                                    (T)\n");
-	printf(" -m                  Create Microsoft typedefs.                       (T)\n");
-	printf(" -b                  Allow bitfields in union.                        (F)\n");
-	printf(" -d                  Allow unnamed data types.                        (T)\n");
-	printf(" -i                  Use types from stdint.h instead of native types. (F)\n");
-	printf(" -j                  Print definitions of referenced types.           (T)\n");
-	printf(" -k                  Print header.                                    (T)\n");
-	printf(" -n                  Print declarations.                              (T)\n");
-	printf(" -l                  Print definitions.                               (T)\n");
-	printf(" -f                  Print functions.                                 (F)\n");
-	printf(" -z                  Print #pragma pack directives.                   (T)\n");
-	printf(" -y                  Sort declarations and definitions.               (F)\n");
-	printf("\n");
+	Output << "Extracts types and structures from PDB (Program database).\n";
+	Output << "Version v" PDBEX_VERSION_STRING "\n";
+	Output << "\n";
+	Output << "pdbex <symbol> <path> [-o <filename>] [-t <filename>] [-e <type>]\n";
+	Output << "                     [-u <prefix>] [-s prefix] [-r prefix] [-g suffix]\n";
+	Output << "                     [-a <reader>] [-w <count>] [-p] [-x] [-m] [-b] [-d]\n";
+	Output << "                     [-i] [-l] [--cache-dir <directory>]\n";
+	Output << "                     [--stats[=text|json]] [--trace <filename>]\n";
+	Output << "\n";
+	Output << "<symbol>             Symbol name to extract\n";
+	Output << "                     Use '*' if all symbols should be extracted.\n";
+	Output << "                     Use '%' if all symbols should be extracted separately.\n";
+	Output << "<path>               Path to the PDB file.\n";
+	Output << " -o filename         Specifies the output file.                       (stdout)\n";
+	Output << " -t filename         Specifies the output test file.                  (off)\n";
+	Output << " -e [n,i,a]          Specifies expansion of nested structures/unions. (i)\n";
+	Output << "                       n = none            Only top-most type is printed.\n";
+	Output << "                       i = inline unnamed  Unnamed types are nested.\n";
+	Output << "                       a = inline all      All types are nested.\n";
+	Output << " -u prefix           Unnamed union prefix  (in combination with -d).\n";
+	Output << " -s prefix           Unnamed struct prefix (in combination with -d).\n";
+	Output << " -r prefix           Prefix for all symbols.\n";
+	Output << " -g suffix           Suffix for all symbols.\n";
+#if defined(_WIN32)
+	Output << " -a [d,n]            Specifies the PDB reader.                        (d)\n";
+#else
+	Output << " -a [d,n]            Specifies the PDB reader.                        (n)\n";
+#endif
+	Output << "                       d = DIA             Uses msdia140.dll (Windows only).\n";
+	Output << "                                           Default on Windows.\n";
+	Output << "                       n = native          Reads the PDB file directly.\n";
+	Output << "                                           Default on other platforms.\n";
+	Output << " -w count            Number of threads.                               (0)\n";
+	Output << "                       Used by the native reader, for printing\n";
+	Output << "                       the definitions of '*' and for writing\n";
+	Output << "                       the files of '%'.\n";
+	Output << "                       0 = one thread per CPU.\n";
+	Output << " --cache-dir dir     Directory of the symbol cache.                   (off)\n";
+	Output << "                       Parsed PDB files are stored there and loaded\n";
+	Output << "                       from there on the next run.\n";
+	Output << " --stats[=format]    Print statistics to stderr.                      (off)\n";
+	Output << "                       Time of the phases, peak memory and counts\n";
+	Output << "                       of the symbols and written bytes,\n";
+	Output << "                       as text (default) or json.\n";
+	Output << " --trace filename    Writes the trace of the extraction.              (off)\n";
+	Output << "                       Spans of the loading, sorting and printing\n";
+	Output << "                       of each symbol and file, in the Chrome\n";
+	Output << "                       trace-event format (chrome://tracing, Perfetto).\n";
+	Output << "\n";
+	Output << "Following options can be explicitly turned off by adding trailing '-'.\n";
+	Output << "Example: -p-\n";
+	Output << " -p                  Create padding members.                          (T)\n";
+	Output << " -x                  Show offsets.                                    (T)\n";
+	Output << " -m                  Create Microsoft typedefs.                       (T)\n";
+	Output << " -b                  Allow bitfields in union.                        (F)\n";
+	Output << " -d                  Allow unnamed data types.                        (T)\n";
+	Output << " -i                  Use types from stdint.h instead of native types. (F)\n";
+	Output << " -j                  Print definitions of referenced types.           (T)\n";
+	Output << " -k                  Print header.                                    (T)\n";
+	Output << " -n                  Print declarations.                              (T)\n";
+	Output << " -l                  Print definitions.                               (T)\n";
+	Output << " -f                  Print functions.                                 (F)\n";
+	Output << " -z                  Print #pragma pack directives.                   (T)\n";
+	Output << " -y                  Sort declarations and definitions.               (F)\n";
+	Output << "\n";
+	Output << "pdbex --batch <manifest> [--jobs <count>] [options]\n";
+	Output << "\n";
+	Output << "<manifest>           File with one job per line: <symbol> <path> [options]\n";
+	Output << "                     Empty lines and lines starting with '#' are ignored.\n";
+	Output << "                     Arguments containing spaces can be enclosed in quotes.\n";
+	Output << " --jobs count        Number of jobs running in parallel.              (0)\n";
+	Output << "                       0 = one job per CPU.\n";
+	Output << "[options]            Options applied to all jobs, before their own ones.\n";
+	Output << "                     Jobs use '-w 1' unless specified otherwise.\n";
+	Output << "Output of the jobs without '-o' is printed to stdout in the manifest order,\n";
+	Output << "status and time of each job is printed to stderr.\n";
+	Output << "\n";
 }
 
 void
@@ -169,21 +325,9 @@ PDBExtractor::ParseParameters(
 	char** argv
 	)
 {
-	//
-	// Early check for help parameter.
-	//
-
-	if ( argc == 1 ||
-	    (argc == 2 && strcmp(argv[1], "-h") == 0) ||
-	    (argc == 2 && strcmp(argv[1], "--help") == 0))
+	if (argc < 3)
 	{
-		PrintUsage();
-
-		//
-		// Kitten died when I wrote this.
-		//
-
-		exit(EXIT_SUCCESS);
+		throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
 	}
 
 	int ArgumentPointer = 0;
@@ -204,6 +348,49 @@ PDBExtractor::ParseParameters(
 			? strlen(CurrentArgument)
 			: 0;
 
+		//
+		// Handling of long options.
+		//
+
+		if (strcmp(CurrentArgument, "--cache-dir") == 0)
+		{
+			if (!NextArgument)
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++ArgumentPointer;
+			m_Settings.CacheDirectory = NextArgument;
+			continue;
+		}
+
+		if (strcmp(CurrentArgument, "--trace") == 0)
+		{
+			if (!NextArgument)
+			{
+				throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+			}
+
+			++ArgumentPointer;
+			m_Settings.TraceFilename = NextArgument;
+			continue;
+		}
+
+		if (strcmp(CurrentArgument, "--stats") == 0 ||
+		    strcmp(CurrentArgument, "--stats=text") == 0)
+		{
+			m_Settings.PrintStatistics = true;
+			m_Settings.StatisticsFormat = Statistics::Format::Text;
+			continue;
+		}
+
+		if (strcmp(CurrentArgument, "--stats=json") == 0)
+		{
+			m_Settings.PrintStatistics = true;
+			m_Settings.StatisticsFormat = Statistics::Format::Json;
+			continue;
+		}
+
 		//
 		// Handling of -X- switches.
 		//
@@ -331,6 +518,38 @@ PDBExtractor::ParseParameters(
 				m_Settings.PdbHeaderReconstructorSettings.SymbolSuffix = NextArgument;
 				break;
 
+			case 'a':
+				if (!NextArgument)
+				{
+					throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+				}
+
+				++ArgumentPointer;
+				switch (NextArgument[0])
+				{
+					case 'd':
+						m_Settings.Reader = PDB::ReaderType::Dia;
+						break;
+
+					case 'n':
+						m_Settings.Reader = PDB::ReaderType::Native;
+						break;
+
+					default:
+						throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+				}
+				break;
+
+			case 'w':
+				if (!NextArgument)
+				{
+					throw PDBDumperException(MESSAGE_INVALID_PARAMETERS);
+				}
+
+				++ArgumentPointer;
+				m_Settings.ThreadCount = static_cast<unsigned>(strtoul(NextArgument, nullptr, 10));
+				break;
+
 			case 'p':
 				m_Settings.PdbHeaderReconstructorSettings.CreatePaddingMembers = !OffSwitch;
 				break;
@@ -393,6 +612,7 @@ PDBExtractor::ParseParameters(
 		);
 
 	m_SymbolVisitor = std::make_unique<PDBSymbolVisitor<UdtFieldDefinition>>(
+		&m_PDB,
 		m_HeaderReconstructor.get(),
 		&m_Settings.UdtFieldDefinitionSettings
 		);
@@ -405,23 +625,48 @@ PDBExtractor::ParseParameters(
 	{
 		m_SymbolSorter = std::make_unique<PDBSymbolSorter>();
 	}
+
+	if (m_Settings.PrintStatistics)
+	{
+		m_Statistics = std::make_unique<Statistics>();
+	}
+
+	if (m_Settings.TraceFilename)
+	{
+		m_Trace = std::make_unique<Trace>();
+	}
 }
 
 void
 PDBExtractor::OpenPDBFile()
 {
-	if (m_PDB.Open(m_Settings.PdbPath.c_str()) == FALSE)
+	Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Load);
+	Trace::Span Span(m_Trace.get(), "OpenPDB", m_Settings.PdbPath.c_str());
+
+	const char* CacheDirectory = !m_Settings.CacheDirectory.empty()
+		? m_Settings.CacheDirectory.c_str()
+		: nullptr;
+
+	if (m_PDB.Open(m_Settings.PdbPath.c_str(), m_Settings.Reader, m_Settings.ThreadCount, CacheDirectory, m_Trace.get()) == FALSE)
 	{
 		throw PDBDumperException(MESSAGE_FILE_NOT_FOUND);
 	}
 }
 
+const SymbolMap&
+PDBExtractor::LoadSymbolMap()
+{
+	Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Load);
+
+	return m_PDB.GetSymbolMap();
+}
+
 void
 PDBExtractor::PrintTestHeader()
 {
 	if (m_Settings.PdbHeaderReconstructorSettings.TestFile != nullptr)
 	{
-		static char TEST_FILE_HEADER_FORMATTED[16 * 1024];
+		char TEST_FILE_HEADER_FORMATTED[16 * 1024];
 		sprintf_s(
 			TEST_FILE_HEADER_FORMATTED, TEST_FILE_HEADER,
 			m_Settings.OutputFilename
@@ -441,11 +686,13 @@ PDBExtractor::PrintTestFooter()
 }
 
 void
-PDBExtractor::PrintPDBHeader()
+PDBExtractor::PrintPDBHeader(
+	PDBHeaderReconstructor& HeaderReconstructor
+	)
 {
 	if (m_Settings.PrintHeader)
 	{
-		static const char* const ArchitectureString =
+		const char* const ArchitectureString =
 			m_PDB.GetMachineType() == IMAGE_FILE_MACHINE_I386  ? "i386"  :
 			m_PDB.GetMachineType() == IMAGE_FILE_MACHINE_AMD64 ? "AMD64" :
 			m_PDB.GetMachineType() == IMAGE_FILE_MACHINE_IA64  ? "IA64"  :
@@ -454,7 +701,7 @@ PDBExtractor::PrintPDBHeader()
 			m_PDB.GetMachineType() == IMAGE_FILE_MACHINE_CHPE_X86 ? "CHPE_X86" :
 			                                                     "Unknown";
 
-		static char HEADER_FILE_HEADER_FORMATTED[16 * 1024];
+		char HEADER_FILE_HEADER_FORMATTED[16 * 1024];
 
 		sprintf_s(
 			HEADER_FILE_HEADER_FORMATTED, HEADER_FILE_HEADER,
@@ -463,7 +710,7 @@ PDBExtractor::PrintPDBHeader()
 			m_PDB.GetMachineType()
 			);
 
-		*m_Settings.PdbHeaderReconstructorSettings.OutputFile << HEADER_FILE_HEADER_FORMATTED;
+		HeaderReconstructor.WriteText(HEADER_FILE_HEADER_FORMATTED);
 	}
 }
 
@@ -476,30 +723,37 @@ PDBExtractor::PrintPDBDeclarations()
 
 	if (m_Settings.PrintDeclarations)
 	{
-		for (auto&& e : m_SymbolSorter->GetSortedSymbols())
+		Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Declarations);
+
+		for (auto&& e : m_SymbolSorter->GetDeclaredSymbols())
 		{
 			if (e->Tag == SymTagUDT && !PDB::IsUnnamedSymbol(e))
 			{
-				*m_Settings.PdbHeaderReconstructorSettings.OutputFile
-					<< PDB::GetUdtKindString(e->u.Udt.Kind)
-					<< " " << m_HeaderReconstructor->GetCorrectedSymbolName(e) << ";"
-					<< std::endl;
+				m_HeaderReconstructor->WriteText(PDB::GetUdtKindString(e->u.Udt.Kind));
+				m_HeaderReconstructor->WriteText(" ");
+				m_HeaderReconstructor->WriteText(m_HeaderReconstructor->GetCorrectedSymbolName(e));
+				m_HeaderReconstructor->WriteText(";\n");
 			}
 			else if (e->Tag == SymTagEnum)
 			{
-				*m_Settings.PdbHeaderReconstructorSettings.OutputFile
-					<< "enum"
-					<< " " << m_HeaderReconstructor->GetCorrectedSymbolName(e) << ";"
-					<< std::endl;
+				m_HeaderReconstructor->WriteText("enum ");
+				m_HeaderReconstructor->WriteText(m_HeaderReconstructor->GetCorrectedSymbolName(e));
+				m_HeaderReconstructor->WriteText(";\n");
 			}
 		}
 
-		*m_Settings.PdbHeaderReconstructorSettings.OutputFile << std::endl;
+		m_HeaderReconstructor->WriteText("\n");
 	}
 }
 
 void
-PDBExtractor::PrintPDBDefinitions()
+PDBExtractor::PrintPDBDefinitions(
+	const std::vector<const SYMBOL*>& Symbols,
+	PDBHeaderReconstructor& HeaderReconstructor,
+	PDBSymbolVisitor<UdtFieldDefinition>& SymbolVisitor,
+	bool InParallel,
+	const RenderedDefinitions* Definitions
+	)
 {
 	//
 	// Write definitions.
@@ -509,48 +763,170 @@ PDBExtractor::PrintPDBDefinitions()
 	{
 		if (m_Settings.UdtFieldDefinitionSettings.UseStdInt)
 		{
-			*m_Settings.PdbHeaderReconstructorSettings.OutputFile
-				<< DEFINITIONS_INCLUDE_STDINT
-				<< std::endl;
+			HeaderReconstructor.WriteText(DEFINITIONS_INCLUDE_STDINT);
+			HeaderReconstructor.WriteText("\n");
 		}
 
 		if (m_Settings.PrintPragmaPack)
 		{
-			*m_Settings.PdbHeaderReconstructorSettings.OutputFile
-				<< DEFINITIONS_PRAGMA_PACK_BEGIN
-				<< std::endl;
+			HeaderReconstructor.WriteText(DEFINITIONS_PRAGMA_PACK_BEGIN);
+			HeaderReconstructor.WriteText("\n");
 		}
 
-		for (auto&& e : m_SymbolSorter->GetSortedSymbols())
+		ULONGLONG AllocationCount = AllocationCounter::GetCount();
+		ULONGLONG PoolAllocationCount = 0;
+
+		if (InParallel)
+		{
+			PoolAllocationCount = PrintPDBDefinitionsInParallel(Symbols, HeaderReconstructor);
+		}
+		else
 		{
-			bool Expand = true;
+			for (auto&& e : Symbols)
+			{
+				if (!ShouldPrintDefinition(e))
+				{
+					continue;
+				}
 
-			//
-			// Do not expand unnamed types, if they will be inlined.
-			//
+				if (Definitions != nullptr)
+				{
+					HeaderReconstructor.WriteFragment(Definitions->Get(e));
+				}
+				else
+				{
+					Trace::Span Span(m_Trace.get(), "Render", e->Name);
 
-			if (m_Settings.PdbHeaderReconstructorSettings.MemberStructExpansion == PDBHeaderReconstructor::MemberStructExpansionType::InlineUnnamed &&
-			    e->Tag == SymTagUDT &&
-			    PDB::IsUnnamedSymbol(e))
-			{
-				Expand = false;
+					SymbolVisitor.Run(e);
+				}
 			}
+		}
 
-			if (Expand)
-			{
-				m_SymbolVisitor->Run(e);
-			}
+		if (AllocationCounter::IsEnabled())
+		{
+			std::cerr
+				<< "Allocations while printing definitions: "
+				<< AllocationCounter::GetCount() - AllocationCount + PoolAllocationCount
+				<< std::endl;
 		}
 
 		if (m_Settings.PrintPragmaPack)
 		{
-			*m_Settings.PdbHeaderReconstructorSettings.OutputFile
-				<< DEFINITIONS_PRAGMA_PACK_END
-				<< std::endl;
+			HeaderReconstructor.WriteText(DEFINITIONS_PRAGMA_PACK_END);
+			HeaderReconstructor.WriteText("\n");
 		}
 	}
 }
 
+ULONGLONG
+PDBExtractor::PrintPDBDefinitionsInParallel(
+	const std::vector<const SYMBOL*>& Symbols,
+	PDBHeaderReconstructor& HeaderReconstructor
+	)
+{
+	//
+	// Each thread renders the definitions into fragments with its own
+	// reconstructor and visitor.  The fragments are written (a window
+	// of them at a time) in the order of the symbols, the numbers
+	// of the padding members and anonymous data types are filled in
+	// while they're written - the output is the same as of the serial
+	// printing.
+	//
+
+	std::vector<const SYMBOL*> PrintedSymbols;
+
+	for (auto&& e : Symbols)
+	{
+		if (ShouldPrintDefinition(e))
+		{
+			PrintedSymbols.push_back(e);
+		}
+	}
+
+	ThreadPool Pool(m_Settings.ThreadCount);
+
+	std::vector<SymbolPrinter> Printers(Pool.GetThreadCount());
+
+	for (auto&& Printer : Printers)
+	{
+		Printer.Initialize(
+			&m_PDB,
+			m_Settings.PdbHeaderReconstructorSettings,
+			&m_Settings.UdtFieldDefinitionSettings,
+			m_UnnamedSymbolNames.get()
+			);
+	}
+
+	std::vector<PDBHeaderReconstructor::DefinitionFragment> Fragments(
+		(std::min)(PrintedSymbols.size(), PARALLEL_DEFINITION_WINDOW)
+		);
+
+	std::atomic<ULONGLONG> AllocationCount{ 0 };
+
+	for (size_t WindowBegin = 0; WindowBegin < PrintedSymbols.size(); WindowBegin += PARALLEL_DEFINITION_WINDOW)
+	{
+		size_t WindowSize = (std::min)(PrintedSymbols.size() - WindowBegin, PARALLEL_DEFINITION_WINDOW);
+
+		Pool.ParallelFor(WindowSize, 16, [&](DWORD WorkerIndex, size_t Begin, size_t End) {
+			SymbolPrinter& Printer = Printers[WorkerIndex];
+
+			ULONGLONG WorkerAllocationCount = AllocationCounter::GetCount();
+
+			for (size_t Index = Begin; Index < End; Index++)
+			{
+				Trace::Span Span(m_Trace.get(), "Render", PrintedSymbols[WindowBegin + Index]->Name);
+
+				Printer.HeaderReconstructor->BeginFragment(Fragments[Index]);
+				Printer.SymbolVisitor->Run(PrintedSymbols[WindowBegin + Index]);
+				Printer.HeaderReconstructor->EndFragment();
+			}
+
+			AllocationCount += AllocationCounter::GetCount() - WorkerAllocationCount;
+		});
+
+		Trace::Span Span(m_Trace.get(), "WriteFragments", WindowBegin, WindowBegin + WindowSize);
+
+		for (size_t Index = 0; Index < WindowSize; Index++)
+		{
+			HeaderReconstructor.WriteFragment(Fragments[Index]);
+		}
+	}
+
+	return AllocationCount;
+}
+
+bool
+PDBExtractor::CanPrintInParallel() const
+{
+	//
+	// Test file is shared by all the symbols and with InlineAll the output
+	// of each symbol depends on the symbols printed before it.
+	//
+
+	return ThreadPool(m_Settings.ThreadCount).GetThreadCount() > 1 &&
+	       m_Settings.PdbHeaderReconstructorSettings.TestFile == nullptr &&
+	       m_Settings.PdbHeaderReconstructorSettings.MemberStructExpansion != PDBHeaderReconstructor::MemberStructExpansionType::InlineAll;
+}
+
+bool
+PDBExtractor::ShouldPrintDefinition(
+	const SYMBOL* Symbol
+	) const
+{
+	//
+	// Do not expand unnamed types, if they will be inlined.
+	//
+
+	if (m_Settings.PdbHeaderReconstructorSettings.MemberStructExpansion == PDBHeaderReconstructor::MemberStructExpansionType::InlineUnnamed &&
+	    Symbol->Tag == SymTagUDT &&
+	    PDB::IsUnnamedSymbol(Symbol))
+	{
+		return false;
+	}
+
+	return true;
+}
+
 void
 PDBExtractor::PrintPDBFunctions()
 {
@@ -560,23 +936,39 @@ PDBExtractor::PrintPDBFunctions()
 
 	if (m_Settings.PrintFunctions)
 	{
-		*m_Settings.PdbHeaderReconstructorSettings.OutputFile
-			<< "/*"
-			<< std::endl;
+		Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Functions);
+
+		m_HeaderReconstructor->WriteText("/*\n");
 
 		for (auto&& e : m_PDB.GetFunctionSet())
 		{
-			*m_Settings.PdbHeaderReconstructorSettings.OutputFile
-				<< e
-				<< std::endl;
+			m_HeaderReconstructor->WriteText(e);
+			m_HeaderReconstructor->WriteText("\n");
 		}
 
-		*m_Settings.PdbHeaderReconstructorSettings.OutputFile
-			<< "*/"
-			<< std::endl;
+		m_HeaderReconstructor->WriteText("*/\n");
 	}
 }
 
+void
+PDBExtractor::BuildUnnamedSymbolNames()
+{
+	if (m_UnnamedSymbolNames)
+	{
+		return;
+	}
+
+	Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Naming);
+
+	std::vector<const SYMBOL*> Symbols;
+	m_PDB.GetUnnamedSymbols(Symbols);
+
+	m_UnnamedSymbolNames = std::make_unique<PDBUnnamedSymbolNames>();
+	m_UnnamedSymbolNames->Build(Symbols);
+
+	m_HeaderReconstructor->SetUnnamedSymbolNames(m_UnnamedSymbolNames.get());
+}
+
 void
 PDBExtractor::DumpAllSymbols()
 {
@@ -584,44 +976,102 @@ PDBExtractor::DumpAllSymbols()
 	// We are going to print all symbols.
 	//
 
-	PrintPDBHeader();
+	LoadSymbolMap();
+
+	BuildUnnamedSymbolNames();
+
+	PrintPDBHeader(*m_HeaderReconstructor);
 
-	for (auto&& e : m_PDB.GetSymbolMap())
 	{
-		m_SymbolSorter->Visit(e.second);
+		Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Sort);
+		Trace::Span Span(m_Trace.get(), "Sort");
+
+		for (const SYMBOL* Symbol : m_PDB.GetSymbolMap())
+		{
+			m_SymbolSorter->Visit(Symbol);
+		}
 	}
 
 	PrintPDBDeclarations();
-	PrintPDBDefinitions();
+
+	{
+		Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Definitions);
+
+		PrintPDBDefinitions(
+			m_SymbolSorter->GetSortedSymbols(),
+			*m_HeaderReconstructor,
+			*m_SymbolVisitor,
+			CanPrintInParallel(),
+			nullptr
+			);
+	}
+
 	PrintPDBFunctions();
+
+	m_HeaderReconstructor->Flush();
 }
 
 void
 PDBExtractor::DumpOneSymbol()
 {
-	const SYMBOL* Symbol = m_PDB.GetSymbolByName(m_Settings.SymbolName.c_str());
+	const SYMBOL* Symbol;
+
+	{
+		Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Load);
+
+		Symbol = m_PDB.GetSymbolByName(m_Settings.SymbolName.c_str());
+	}
 
 	if (Symbol == nullptr)
 	{
 		throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
 	}
 
-	PrintPDBHeader();
+	const std::vector<const SYMBOL*>* ReferencedSymbols = nullptr;
+
+	if (ShouldPrintReferencedTypes())
+	{
+		Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Sort);
+
+		ReferencedSymbols = &GetReferencedSymbols(Symbol);
+	}
 
 	//
-	// InlineAll supresses PrintReferencedTypes.
+	// Only the unnamed symbols are decoded for the naming,
+	// not the whole PDB.
 	//
 
-	if (m_Settings.PrintReferencedTypes &&
-	    m_Settings.PdbHeaderReconstructorSettings.MemberStructExpansion != PDBHeaderReconstructor::MemberStructExpansionType::InlineAll)
-	{
-		m_SymbolSorter->Visit(Symbol);
+	BuildUnnamedSymbolNames();
 
+	Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Definitions);
+
+	DumpOneSymbol(
+		Symbol,
+		ReferencedSymbols,
+		*m_HeaderReconstructor,
+		*m_SymbolVisitor,
+		nullptr
+		);
+}
+
+void
+PDBExtractor::DumpOneSymbol(
+	const SYMBOL* Symbol,
+	const std::vector<const SYMBOL*>* ReferencedSymbols,
+	PDBHeaderReconstructor& HeaderReconstructor,
+	PDBSymbolVisitor<UdtFieldDefinition>& SymbolVisitor,
+	const RenderedDefinitions* Definitions
+	)
+{
+	PrintPDBHeader(HeaderReconstructor);
+
+	if (ReferencedSymbols != nullptr)
+	{
 		//
 		// Print header only when PrintReferencedTypes == true.
 		//
 
-		PrintPDBDefinitions();
+		PrintPDBDefinitions(*ReferencedSymbols, HeaderReconstructor, SymbolVisitor, false, Definitions);
 	}
 	else
 	{
@@ -629,8 +1079,47 @@ PDBExtractor::DumpOneSymbol()
 		// Print only the specified symbol.
 		//
 
-		m_SymbolVisitor->Run(Symbol);
+		if (Definitions != nullptr)
+		{
+			HeaderReconstructor.WriteFragment(Definitions->Get(Symbol));
+		}
+		else
+		{
+			Trace::Span Span(m_Trace.get(), "Render", Symbol->Name);
+
+			SymbolVisitor.Run(Symbol);
+		}
 	}
+
+	HeaderReconstructor.Flush();
+}
+
+bool
+PDBExtractor::ShouldPrintReferencedTypes() const
+{
+	//
+	// InlineAll supresses PrintReferencedTypes.
+	//
+
+	return m_Settings.PrintReferencedTypes &&
+	       m_Settings.PdbHeaderReconstructorSettings.MemberStructExpansion != PDBHeaderReconstructor::MemberStructExpansionType::InlineAll;
+}
+
+const std::vector<const SYMBOL*>&
+PDBExtractor::GetReferencedSymbols(
+	const SYMBOL* Symbol
+	)
+{
+	Trace::Span Span(m_Trace.get(), "Sort", Symbol->Name);
+
+	if (m_SymbolClosure && m_SymbolClosure->GetClosure(Symbol, m_ClosureSymbols))
+	{
+		return m_ClosureSymbols;
+	}
+
+	m_SymbolSorter->Visit(Symbol);
+
+	return m_SymbolSorter->GetSortedSymbols();
 }
 
 void
@@ -639,52 +1128,310 @@ PDBExtractor::DumpAllSymbolsOneByOne()
 	//
 	// Copy all symbols locally.
 	//
-	for (auto&& e : m_PDB.GetSymbolMap())
+	const SymbolMap& AllSymbols = LoadSymbolMap();
+
+	std::vector<const SYMBOL*> Symbols;
+
 	{
-		m_SymbolSorter->Visit(e.second);
-	}
+		Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Sort);
+		Trace::Span Span(m_Trace.get(), "Sort");
 
-	auto Symbols = m_SymbolSorter->GetSortedSymbols();
+		for (const SYMBOL* Symbol : AllSymbols)
+		{
+			m_SymbolSorter->Visit(Symbol);
+		}
+
+		Symbols = m_SymbolSorter->GetSortedSymbols();
 
-	m_SymbolSorter->Clear();
+		m_SymbolSorter->Clear();
+	}
+
+	BuildUnnamedSymbolNames();
 
 	//
 	// Create output directory.
 	//
-	std::string OutputDirectory = m_Settings.OutputFilename
+	std::filesystem::path OutputDirectory = m_Settings.OutputFilename
 		? m_Settings.OutputFilename
 		: ".";
 
-	if (OutputDirectory[OutputDirectory.length() - 1] != '\\')
+	std::error_code ErrorCode;
+	std::filesystem::create_directories(OutputDirectory, ErrorCode);
+
+	if (!std::filesystem::is_directory(OutputDirectory))
 	{
-		OutputDirectory += '\\';
+		throw PDBDumperException("Cannot create directory");
 	}
 
-	BOOL Result = CreateDirectory(OutputDirectory.c_str(), NULL);
-	if (!Result && GetLastError() != ERROR_ALREADY_EXISTS)
+	//
+	// Closures of the symbols overlap a lot, compute them only once.
+	// Alphabetical order of a closure cannot be derived from the orders
+	// of its parts, it's left on the sorter.
+	//
+	if (!m_Settings.Sort)
 	{
-		throw PDBDumperException("Cannot create directory");
+		m_SymbolClosure = std::make_unique<PDBSymbolClosure>();
+	}
+
+	//
+	// Lookups, sorting and printing of the symbols
+	// are counted in the writing of the files.
+	//
+
+	Statistics::ScopedPhase Phase(m_Statistics.get(), Statistics::Phase::Files);
+
+	if (CanPrintInParallel())
+	{
+		DumpAllSymbolsOneByOneInParallel(Symbols, OutputDirectory);
+	}
+	else
+	{
+		//
+		// Files share the definitions of the referenced symbols.
+		//
+
+		m_HeaderReconstructor->EnableDefinitionCache();
+
+		for (auto&& e : Symbols)
+		{
+			if (!PDB::IsUnnamedSymbol(e))
+			{
+				Trace::Span Span(m_Trace.get(), "WriteFile", e->Name);
+
+				m_Settings.PdbHeaderReconstructorSettings.OutputFile = new std::ofstream(
+					OutputDirectory / (std::string(e->Name) + ".h"),
+					std::ios::out
+				);
+
+				m_Settings.SymbolName = e->Name;
+				DumpOneSymbol();
+
+				delete m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+
+				m_SymbolSorter->Clear();
+			}
+		}
+
+		m_Settings.PdbHeaderReconstructorSettings.OutputFile = nullptr;
 	}
 
+	m_SymbolClosure.reset();
+}
+
+void
+PDBExtractor::DumpAllSymbolsOneByOneInParallel(
+	const std::vector<const SYMBOL*>& Symbols,
+	const std::filesystem::path& OutputDirectory
+	)
+{
+	//
+	// The files can be written independently, but their content
+	// is not independent - padding members and anonymous data types
+	// are numbered continuously across all files.
+	//
+	// Therefore the numbering is determined upfront:
+	// 1. every printed symbol is rendered once into a fragment,
+	//    its holes are the numbers it consumes,
+	// 2. the starting numbering of each file is computed
+	//    in the order in which the files would be written serially,
+	// 3. files are written in parallel, each starting from its numbering,
+	//    the definitions are written from the fragments.
+	//
+
+	bool PrintReferencedTypes = ShouldPrintReferencedTypes();
+
+	std::vector<SymbolFile> Files;
+
+#if defined(_WIN32)
+	//
+	// File names are case-insensitive, only the last of the files
+	// with the same name would survive the serial dump.
+	//
+	std::unordered_map<std::string, size_t> FileIndices;
+#endif
+
 	for (auto&& e : Symbols)
 	{
-		if (!PDB::IsUnnamedSymbol(e))
+		if (PDB::IsUnnamedSymbol(e))
 		{
-			m_Settings.PdbHeaderReconstructorSettings.OutputFile = new std::ofstream(
-				OutputDirectory + std::string(e->Name) + ".h",
-				std::ios::out
-			);
+			continue;
+		}
 
-			m_Settings.SymbolName = e->Name;
-			DumpOneSymbol();
+		SymbolFile File;
+		File.Path = OutputDirectory / (std::string(e->Name) + ".h");
+		File.Symbol = m_PDB.GetSymbolByName(e->Name);
 
-			delete m_Settings.PdbHeaderReconstructorSettings.OutputFile;
+		if (File.Symbol == nullptr)
+		{
+			throw PDBDumperException(MESSAGE_SYMBOL_NOT_FOUND);
+		}
+
+		if (PrintReferencedTypes)
+		{
+			File.ReferencedSymbols = GetReferencedSymbols(File.Symbol);
 
 			m_SymbolSorter->Clear();
 		}
+
+#if defined(_WIN32)
+		std::string LowerCaseName = e->Name;
+		std::transform(LowerCaseName.begin(), LowerCaseName.end(), LowerCaseName.begin(), ::tolower);
+
+		auto Result = FileIndices.try_emplace(LowerCaseName, Files.size());
+
+		if (!Result.second)
+		{
+			Files[Result.first->second].IsOverwritten = true;
+			Result.first->second = Files.size();
+		}
+#endif
+
+		Files.push_back(std::move(File));
 	}
 
-	m_Settings.PdbHeaderReconstructorSettings.OutputFile = nullptr;
+	//
+	// Symbols whose definitions are printed into the file.
+	//
+
+	auto ForEachPrintedSymbol = [this, PrintReferencedTypes](const SymbolFile& File, auto&& Callback) {
+		if (!PrintReferencedTypes)
+		{
+			Callback(File.Symbol);
+		}
+		else if (m_Settings.PrintDefinitions)
+		{
+			for (auto&& e : File.ReferencedSymbols)
+			{
+				if (ShouldPrintDefinition(e))
+				{
+					Callback(e);
+				}
+			}
+		}
+	};
+
+	RenderedDefinitions Definitions;
+
+	for (auto&& File : Files)
+	{
+		ForEachPrintedSymbol(File, [&](const SYMBOL* Symbol) {
+			if (Definitions.Indices.try_emplace(Symbol, Definitions.Symbols.size()).second)
+			{
+				Definitions.Symbols.push_back(Symbol);
+			}
+		});
+	}
+
+	Definitions.Fragments.resize(Definitions.Symbols.size());
+
+	//
+	// Each thread has its own reconstructor and visitor.
+	//
+
+	ThreadPool Pool(m_Settings.ThreadCount);
+
+	std::vector<SymbolPrinter> Printers(Pool.GetThreadCount());
+
+	for (auto&& Printer : Printers)
+	{
+		Printer.Initialize(
+			&m_PDB,
+			m_Settings.PdbHeaderReconstructorSettings,
+			&m_Settings.UdtFieldDefinitionSettings,
+			m_UnnamedSymbolNames.get()
+			);
+	}
+
+	//
+	// 1. Render each printed symbol, count the numbers it consumes.
+	//
+
+	std::vector<PDBHeaderReconstructor::NumberingState> Numberings(Definitions.Symbols.size());
+
+	Pool.ParallelFor(Definitions.Symbols.size(), 16, [&](DWORD WorkerIndex, size_t Begin, size_t End) {
+		SymbolPrinter& Printer = Printers[WorkerIndex];
+
+		for (size_t Index = Begin; Index < End; Index++)
+		{
+			Trace::Span Span(m_Trace.get(), "Render", Definitions.Symbols[Index]->Name);
+
+			PDBHeaderReconstructor::DefinitionFragment& Fragment = Definitions.Fragments[Index];
+
+			Printer.HeaderReconstructor->BeginFragment(Fragment);
+			Printer.SymbolVisitor->Run(Definitions.Symbols[Index]);
+			Printer.HeaderReconstructor->EndFragment();
+
+			for (auto&& Hole : Fragment.Holes)
+			{
+				if (Hole.Kind == PDBHeaderReconstructor::DefinitionFragment::HoleKind::PaddingMemberNumber)
+				{
+					Numberings[Index].PaddingMemberCounter += 1;
+				}
+				else
+				{
+					Numberings[Index].AnonymousDataTypeCounter += 1;
+				}
+			}
+		}
+	});
+
+	//
+	// 2. Numbering at the beginning of each file.
+	//
+
+	PDBHeaderReconstructor::NumberingState State;
+
+	for (auto&& File : Files)
+	{
+		File.State = State;
+
+		ForEachPrintedSymbol(File, [&](const SYMBOL* Symbol) {
+			const PDBHeaderReconstructor::NumberingState& Numbering = Numberings[Definitions.Indices[Symbol]];
+
+			State.PaddingMemberCounter += Numbering.PaddingMemberCounter;
+			State.AnonymousDataTypeCounter += Numbering.AnonymousDataTypeCounter;
+		});
+	}
+
+	//
+	// 3. Write the files.
+	//
+
+	Pool.ParallelFor(Files.size(), 1, [&](DWORD WorkerIndex, size_t Begin, size_t End) {
+		SymbolPrinter& Printer = Printers[WorkerIndex];
+
+		for (size_t Index = Begin; Index < End; Index++)
+		{
+			const SymbolFile& File = Files[Index];
+
+			if (File.IsOverwritten)
+			{
+				continue;
+			}
+
+			Trace::Span Span(m_Trace.get(), "WriteFile", File.Symbol->Name);
+
+			std::ofstream Output(File.Path, std::ios::out);
+
+			Printer.Settings.OutputFile = &Output;
+			Printer.HeaderReconstructor->SetNumberingState(File.State);
+
+			DumpOneSymbol(
+				File.Symbol,
+				PrintReferencedTypes ? &File.ReferencedSymbols : nullptr,
+				*Printer.HeaderReconstructor,
+				*Printer.SymbolVisitor,
+				&Definitions
+				);
+
+			Printer.Settings.OutputFile = &Printer.NullOutput;
+		}
+	});
+
+	for (auto&& Printer : Printers)
+	{
+		AddWriteStatistics(*Printer.HeaderReconstructor);
+	}
 }
 
 void
@@ -705,3 +1452,69 @@ PDBExtractor::CloseOpenFiles()
 		delete m_Settings.PdbHeaderReconstructorSettings.OutputFile;
 	}
 }
+
+void
+PDBExtractor::AddWriteStatistics(
+	const PDBHeaderReconstructor& HeaderReconstructor
+	)
+{
+	if (m_Statistics)
+	{
+		const OutputSink::WriteStatistics& WriteStatistics = HeaderReconstructor.GetWriteStatistics();
+
+		Statistics::Counters& Counters = m_Statistics->GetCounters();
+		Counters.WrittenSize += WriteStatistics.Size;
+		Counters.WriteCount += WriteStatistics.Count;
+		Counters.WriteNanoseconds += WriteStatistics.Nanoseconds;
+	}
+}
+
+void
+PDBExtractor::PrintStatistics()
+{
+	if (!m_Statistics)
+	{
+		return;
+	}
+
+	Statistics::Counters& Counters = m_Statistics->GetCounters();
+
+	//
+	// Only the symbols decoded by the extraction are counted,
+	// GetSymbolMap() would decode all of them.
+	//
+
+	const SymbolMap& DecodedSymbolMap = m_PDB.GetDecodedSymbolMap();
+
+	Counters.SymbolCount = DecodedSymbolMap.GetCount();
+
+	for (const SYMBOL* Symbol : DecodedSymbolMap)
+	{
+		if (Symbol->Tag == SymTagUDT)
+		{
+			Counters.UdtFieldCount += Symbol->u.Udt.FieldCount;
+		}
+		else if (Symbol->Tag == SymTagEnum)
+		{
+			Counters.EnumFieldCount += Symbol->u.Enum.FieldCount;
+		}
+	}
+
+	Counters.ReservedSymbolMemory = m_PDB.GetReservedSymbolMemory();
+	Counters.UsedSymbolMemory = m_PDB.GetUsedSymbolMemory();
+	Counters.UdtLayoutCount = m_PDB.GetUdtLayoutCount();
+	Counters.PaddingMemberCount = m_PDB.GetPaddingMemberCount();
+
+	AddWriteStatistics(*m_HeaderReconstructor);
+
+	m_Statistics->Print(std::cerr, m_Settings.StatisticsFormat);
+}
+
+void
+PDBExtractor::WriteTrace()
+{
+	if (m_Trace && !m_Trace->Write(m_Settings.TraceFilename))
+	{
+		throw PDBDumperException("Cannot write the trace file");
+	}
+}
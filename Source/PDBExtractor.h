@@ -1,11 +1,19 @@
 #pragma once
 #include "PDBSymbolSorterBase.h"
+#include "PDBSymbolClosure.h"
 #include "PDBHeaderReconstructor.h"
 #include "PDBSymbolVisitor.h"
+#include "PDBUnnamedSymbolNames.h"
+#include "Statistics.h"
+#include "Trace.h"
 #include "UdtFieldDefinition.h"
 
+#include <filesystem>
 #include <memory>
+#include <ostream>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 // From ntimage.h
 #ifndef IMAGE_FILE_MACHINE_CHPE_X86
@@ -28,8 +36,13 @@ class PDBExtractor
 			std::string SymbolName;
 			std::string PdbPath;
 
+			PDB::ReaderType Reader = PDB::ReaderType::Default;
+			unsigned ThreadCount = 0;
+			std::string CacheDirectory;
+
 			const char* OutputFilename = nullptr;
 			const char* TestFilename = nullptr;
+			const char* TraceFilename = nullptr;
 
 			bool PrintReferencedTypes = true;
 			bool PrintHeader = true;
@@ -38,6 +51,9 @@ class PDBExtractor
 			bool PrintFunctions = false;
 			bool PrintPragmaPack = true;
 			bool Sort = false;
+
+			bool PrintStatistics = false;
+			Statistics::Format StatisticsFormat = Statistics::Format::Text;
 		};
 
 		int Run(
@@ -45,9 +61,42 @@ class PDBExtractor
 			char** argv
 			);
 
+		//
+		// Same as above, but the output which would go to stdout
+		// is written to the StandardOutput and the error message
+		// (if any) is returned in the ErrorMessage.
+		//
+		int Run(
+			int argc,
+			char** argv,
+			std::ostream& StandardOutput,
+			std::string& ErrorMessage
+			);
+
 	private:
+		//
+		// Definitions rendered before the files of '%' are written
+		// (see DumpAllSymbolsOneByOneInParallel()), each one once.
+		//
+		struct RenderedDefinitions
+		{
+			std::vector<const SYMBOL*> Symbols;
+			std::unordered_map<const SYMBOL*, size_t> Indices;
+			std::vector<PDBHeaderReconstructor::DefinitionFragment> Fragments;
+
+			const PDBHeaderReconstructor::DefinitionFragment&
+			Get(
+				const SYMBOL* Symbol
+				) const
+			{
+				return Fragments[Indices.at(Symbol)];
+			}
+		};
+
 		void
-		PrintUsage();
+		PrintUsage(
+			std::ostream& Output
+			);
 
 		void
 		ParseParameters(
@@ -58,6 +107,13 @@ class PDBExtractor
 		void
 		OpenPDBFile();
 
+		//
+		// Returns all symbols, the native reader decodes them
+		// on the first call.
+		//
+		const SymbolMap&
+		LoadSymbolMap();
+
 		void
 		PrintTestHeader();
 
@@ -65,34 +121,128 @@ class PDBExtractor
 		PrintTestFooter();
 
 		void
-		PrintPDBHeader();
+		PrintPDBHeader(
+			PDBHeaderReconstructor& HeaderReconstructor
+			);
 
 		void
 		PrintPDBDeclarations();
 
+		//
+		// With InParallel, the definitions are rendered by a pool
+		// of threads (see CanPrintInParallel()).  With Definitions,
+		// the already rendered definitions are written instead.
+		//
 		void
-		PrintPDBDefinitions();
+		PrintPDBDefinitions(
+			const std::vector<const SYMBOL*>& Symbols,
+			PDBHeaderReconstructor& HeaderReconstructor,
+			PDBSymbolVisitor<UdtFieldDefinition>& SymbolVisitor,
+			bool InParallel,
+			const RenderedDefinitions* Definitions
+			);
+
+		//
+		// Returns the number of allocations made by the threads
+		// of the pool.
+		//
+		ULONGLONG
+		PrintPDBDefinitionsInParallel(
+			const std::vector<const SYMBOL*>& Symbols,
+			PDBHeaderReconstructor& HeaderReconstructor
+			);
+
+		//
+		// Returns true if the definitions can be rendered
+		// independently of each other, on multiple threads.
+		//
+		bool
+		CanPrintInParallel() const;
+
+		bool
+		ShouldPrintDefinition(
+			const SYMBOL* Symbol
+			) const;
 
 		void
 		PrintPDBFunctions();
 
+		//
+		// Names all unnamed symbols of the PDB,
+		// once per extraction.
+		//
+		void
+		BuildUnnamedSymbolNames();
+
 		void
 		DumpAllSymbols();
 
 		void
 		DumpOneSymbol();
 
+		//
+		// Prints the symbol (and the referenced symbols, if provided)
+		// into the output of the reconstructor used by the visitor.
+		// Definitions (if provided) must contain all printed symbols.
+		//
+		void
+		DumpOneSymbol(
+			const SYMBOL* Symbol,
+			const std::vector<const SYMBOL*>* ReferencedSymbols,
+			PDBHeaderReconstructor& HeaderReconstructor,
+			PDBSymbolVisitor<UdtFieldDefinition>& SymbolVisitor,
+			const RenderedDefinitions* Definitions
+			);
+
+		bool
+		ShouldPrintReferencedTypes() const;
+
+		const std::vector<const SYMBOL*>&
+		GetReferencedSymbols(
+			const SYMBOL* Symbol
+			);
+
 		void
 		DumpAllSymbolsOneByOne();
 
+		void
+		DumpAllSymbolsOneByOneInParallel(
+			const std::vector<const SYMBOL*>& Symbols,
+			const std::filesystem::path& OutputDirectory
+			);
+
 		void
 		CloseOpenFiles();
 
+		void
+		AddWriteStatistics(
+			const PDBHeaderReconstructor& HeaderReconstructor
+			);
+
+		void
+		PrintStatistics();
+
+		void
+		WriteTrace();
+
 	private:
 		PDB m_PDB;
 		Settings m_Settings;
 
 		std::unique_ptr<PDBSymbolSorterBase> m_SymbolSorter;
+		std::unique_ptr<PDBSymbolClosure> m_SymbolClosure;
+		std::vector<const SYMBOL*> m_ClosureSymbols;
+		std::unique_ptr<PDBUnnamedSymbolNames> m_UnnamedSymbolNames;
 		std::unique_ptr<PDBHeaderReconstructor> m_HeaderReconstructor;
 		std::unique_ptr<PDBSymbolVisitor<UdtFieldDefinition>> m_SymbolVisitor;
+
+		//
+		// Only with --stats.
+		//
+		std::unique_ptr<Statistics> m_Statistics;
+
+		//
+		// Only with --trace.
+		//
+		std::unique_ptr<Trace> m_Trace;
 };
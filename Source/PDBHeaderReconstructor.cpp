@@ -13,11 +13,9 @@ PDBHeaderReconstructor::PDBHeaderReconstructor(
 	Settings* VisitorSettings
 	)
 {
-	static Settings DefaultSettings;
-
 	if (VisitorSettings == nullptr)
 	{
-		VisitorSettings = &DefaultSettings;
+		VisitorSettings = &m_DefaultSettings;
 	}
 
 	m_Settings = VisitorSettings;
@@ -31,9 +29,10 @@ PDBHeaderReconstructor::Clear()
 	m_AnonymousDataTypeCounter = 0;
 	m_PaddingMemberCounter = 0;
 
-	m_UnnamedSymbols.clear();
 	m_CorrectedSymbolNames.clear();
 	m_VisitedSymbols.clear();
+
+	m_RecordedFragment = nullptr;
 }
 
 const std::string&
@@ -41,13 +40,15 @@ PDBHeaderReconstructor::GetCorrectedSymbolName(
 	const SYMBOL* Symbol
 	) const
 {
-	if (!m_CorrectedSymbolNames.contains(Symbol))
+	auto It = m_CorrectedSymbolNames.find(Symbol);
+
+	if (It == m_CorrectedSymbolNames.end())
 	{
 		//
 		// Build corrected name:
 		// SymbolPrefix
 		//   + "_" (if Microsoft typedefs are enabled)
-		//   + unnamed tag (if symbol does not have name)
+		//   + unnamed tag and the name from the table (if symbol does not have name)
 		//   + symbol name (if symbol does have name)
 		//
 		// ...and cache the name.
@@ -64,9 +65,11 @@ PDBHeaderReconstructor::GetCorrectedSymbolName(
 				CorrectedName += "_";
 			}
 
-			m_UnnamedSymbols.insert(Symbol);
+			CorrectedName += m_Settings->UnnamedTypePrefix;
 
-			CorrectedName += m_Settings->UnnamedTypePrefix + std::to_string(m_UnnamedSymbols.size());
+			assert(m_UnnamedSymbolNames != nullptr);
+
+			CorrectedName += m_UnnamedSymbolNames->GetName(Symbol);
 		}
 		else
 		{
@@ -75,10 +78,121 @@ PDBHeaderReconstructor::GetCorrectedSymbolName(
 
 		CorrectedName += m_Settings->SymbolSuffix;
 
-		m_CorrectedSymbolNames[Symbol] = CorrectedName;
+		It = m_CorrectedSymbolNames.emplace(Symbol, std::move(CorrectedName)).first;
 	}
 
-	return m_CorrectedSymbolNames[Symbol];
+	return It->second;
+}
+
+void
+PDBHeaderReconstructor::Flush()
+{
+	//
+	// Definition which isn't complete yet can't be recorded anymore.
+	//
+
+	m_RecordedFragment = nullptr;
+
+	m_Output.Flush(*m_Settings->OutputFile);
+}
+
+void
+PDBHeaderReconstructor::WriteText(
+	const CHAR* Text
+	)
+{
+	m_Output.Write(Text);
+}
+
+void
+PDBHeaderReconstructor::WriteText(
+	const std::string& Text
+	)
+{
+	m_Output.Write(Text);
+}
+
+const OutputSink::WriteStatistics&
+PDBHeaderReconstructor::GetWriteStatistics() const
+{
+	return m_Output.GetWriteStatistics();
+}
+
+PDBHeaderReconstructor::NumberingState
+PDBHeaderReconstructor::GetNumberingState() const
+{
+	NumberingState State;
+	State.PaddingMemberCounter = m_PaddingMemberCounter;
+	State.AnonymousDataTypeCounter = m_AnonymousDataTypeCounter;
+
+	return State;
+}
+
+void
+PDBHeaderReconstructor::SetNumberingState(
+	const NumberingState& State
+	)
+{
+	m_PaddingMemberCounter = State.PaddingMemberCounter;
+	m_AnonymousDataTypeCounter = State.AnonymousDataTypeCounter;
+}
+
+void
+PDBHeaderReconstructor::BeginFragment(
+	DefinitionFragment& Fragment
+	)
+{
+	assert(m_Depth == 0 && m_RecordedFragment == nullptr);
+
+	Fragment.IsRecorded = false;
+	Fragment.Text.clear();
+	Fragment.Holes.clear();
+
+	m_RecordedFragment = &Fragment;
+	m_RecordedFragmentBegin = m_Output.GetSize();
+	m_IsRecordingFragment = true;
+}
+
+void
+PDBHeaderReconstructor::EndFragment()
+{
+	assert(m_Depth == 0 && m_IsRecordingFragment);
+
+	m_RecordedFragment->Text = m_Output.GetBuffered(m_RecordedFragmentBegin);
+	m_RecordedFragment->IsRecorded = true;
+
+	m_Output.Truncate(m_RecordedFragmentBegin);
+
+	m_RecordedFragment = nullptr;
+	m_IsRecordingFragment = false;
+}
+
+void
+PDBHeaderReconstructor::WriteFragment(
+	const DefinitionFragment& Fragment
+	)
+{
+	assert(m_Depth == 0 && m_RecordedFragment == nullptr);
+
+	ReplayDefinition(Fragment);
+
+	if (m_Output.GetSize() >= FLUSH_THRESHOLD)
+	{
+		Flush();
+	}
+}
+
+void
+PDBHeaderReconstructor::SetUnnamedSymbolNames(
+	const PDBUnnamedSymbolNames* UnnamedSymbolNames
+	)
+{
+	assert(m_Depth == 0);
+
+	m_UnnamedSymbolNames = UnnamedSymbolNames;
+
+	m_CorrectedSymbolNames.clear();
+	m_DefinitionFragments.clear();
 }
 
 bool
@@ -86,7 +200,13 @@ PDBHeaderReconstructor::OnEnumType(
 	const SYMBOL* Symbol
 	)
 {
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+	if (m_Depth == 0 && WriteCachedDefinition(Symbol))
+	{
+		WriteDefinitionEnd();
+		return false;
+	}
+
+	const std::string& CorrectedName = GetCorrectedSymbolName(Symbol);
 
 	bool Expand = ShouldExpand(Symbol);
 
@@ -94,7 +214,8 @@ PDBHeaderReconstructor::OnEnumType(
 
 	if (!Expand)
 	{
-		Write("enum %s", CorrectedName.c_str());
+		m_Output.Write("enum ");
+		m_Output.Write(CorrectedName);
 	}
 
 	return Expand;
@@ -105,7 +226,7 @@ PDBHeaderReconstructor::OnEnumTypeBegin(
 	const SYMBOL* Symbol
 	)
 {
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+	const std::string& CorrectedName = GetCorrectedSymbolName(Symbol);
 
 	//
 	// Handle begin of the typedef.
@@ -113,14 +234,15 @@ PDBHeaderReconstructor::OnEnumTypeBegin(
 
 	WriteTypedefBegin(Symbol);
 
-	Write("enum");
+	m_Output.Write("enum");
 
-	Write(" %s", CorrectedName.c_str());
+	m_Output.Write(" ");
+	m_Output.Write(CorrectedName);
 
-	Write("\n");
+	m_Output.Write("\n");
 
 	WriteIndent();
-	Write("{\n");
+	m_Output.Write("{\n");
 
 	m_Depth += 1;
 }
@@ -133,7 +255,7 @@ PDBHeaderReconstructor::OnEnumTypeEnd(
 	m_Depth -= 1;
 
 	WriteIndent();
-	Write("}");
+	m_Output.Write("}");
 
 	//
 	// Handle end of the typedef.
@@ -143,7 +265,9 @@ PDBHeaderReconstructor::OnEnumTypeEnd(
 
 	if (m_Depth == 0)
 	{
-		Write(";\n\n");
+		m_Output.Write(";\n\n");
+
+		WriteDefinitionEnd();
 	}
 }
 
@@ -153,10 +277,11 @@ PDBHeaderReconstructor::OnEnumField(
 	)
 {
 	WriteIndent();
-	Write("%s = ", EnumField->Name);
+	m_Output.Write(EnumField->Name);
+	m_Output.Write(" = ");
 
 	WriteVariant(&EnumField->Value);
-	Write(",\n");
+	m_Output.Write(",\n");
 }
 
 bool
@@ -164,17 +289,25 @@ PDBHeaderReconstructor::OnUdt(
 	const SYMBOL* Symbol
 	)
 {
+	if (m_Depth == 0 && WriteCachedDefinition(Symbol))
+	{
+		WriteDefinitionEnd();
+		return false;
+	}
+
 	bool Expand = ShouldExpand(Symbol);
 
 	MarkAsVisited(Symbol);
 
 	if (!Expand)
 	{
-		std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+		const std::string& CorrectedName = GetCorrectedSymbolName(Symbol);
 
 		WriteConstAndVolatile(Symbol);
 
-		Write("%s %s", PDB::GetUdtKindString(Symbol->u.Udt.Kind), CorrectedName.c_str());
+		m_Output.Write(PDB::GetUdtKindString(Symbol->u.Udt.Kind));
+		m_Output.Write(" ");
+		m_Output.Write(CorrectedName);
 
 		//
 		// If we're not expanding the type at the root level,
@@ -183,7 +316,9 @@ PDBHeaderReconstructor::OnUdt(
 
 		if (m_Depth == 0)
 		{
-			Write(";\n\n");
+			m_Output.Write(";\n\n");
+
+			WriteDefinitionEnd();
 		}
 	}
 
@@ -203,18 +338,19 @@ PDBHeaderReconstructor::OnUdtBegin(
 
 	WriteConstAndVolatile(Symbol);
 
-	Write("%s", PDB::GetUdtKindString(Symbol->u.Udt.Kind));
+	m_Output.Write(PDB::GetUdtKindString(Symbol->u.Udt.Kind));
 
 	if (!PDB::IsUnnamedSymbol(Symbol))
 	{
-		std::string CorrectedName = GetCorrectedSymbolName(Symbol);
-		Write(" %s", CorrectedName.c_str());
+		const std::string& CorrectedName = GetCorrectedSymbolName(Symbol);
+		m_Output.Write(" ");
+		m_Output.Write(CorrectedName);
 	}
 
-	Write("\n");
+	m_Output.Write("\n");
 
 	WriteIndent();
-	Write("{\n");
+	m_Output.Write("{\n");
 
 	m_Depth += 1;
 }
@@ -227,7 +363,7 @@ PDBHeaderReconstructor::OnUdtEnd(
 	m_Depth -= 1;
 
 	WriteIndent();
-	Write("}");
+	m_Output.Write("}");
 
 	//
 	// Handle end of the typedef.
@@ -237,14 +373,16 @@ PDBHeaderReconstructor::OnUdtEnd(
 
 	if (m_Depth == 0)
 	{
-		Write(";");
+		m_Output.Write(";");
 	}
 
-	Write(" /* size: 0x%04x */", Symbol->Size);
+	WriteSize(Symbol->Size);
 
 	if (m_Depth == 0)
 	{
-		Write("\n\n");
+		m_Output.Write("\n\n");
+
+		WriteDefinitionEnd();
 	}
 }
 
@@ -293,7 +431,7 @@ PDBHeaderReconstructor::OnUdtField(
 	UdtFieldDefinitionBase* MemberDefinition
 	)
 {
-	Write("%s", MemberDefinition->GetPrintableDefinition().c_str());
+	MemberDefinition->WritePrintableDefinition(m_Output);
 
 	//
 	// BitField handling.
@@ -301,17 +439,20 @@ PDBHeaderReconstructor::OnUdtField(
 
 	if (UdtField->Bits != 0)
 	{
-		Write(" : %i", UdtField->Bits);
+		m_Output.Write(" : ");
+		m_Output.WriteDecimal(static_cast<INT>(UdtField->Bits));
 	}
 
-	Write(";");
+	m_Output.Write(";");
 
 	if (UdtField->Bits != 0)
 	{
-		Write(" /* bit position: %i */", UdtField->BitPosition);
+		m_Output.Write(" /* bit position: ");
+		m_Output.WriteDecimal(static_cast<INT>(UdtField->BitPosition));
+		m_Output.Write(" */");
 	}
 
-	Write("\n");
+	m_Output.Write("\n");
 }
 
 void
@@ -321,10 +462,11 @@ PDBHeaderReconstructor::OnAnonymousUdtBegin(
 	)
 {
 	WriteIndent();
-	Write("%s\n", PDB::GetUdtKindString(Kind));
+	m_Output.Write(PDB::GetUdtKindString(Kind));
+	m_Output.Write("\n");
 
 	WriteIndent();
-	Write("{\n");
+	m_Output.Write("{\n");
 
 	m_Depth += 1;
 }
@@ -339,15 +481,15 @@ PDBHeaderReconstructor::OnAnonymousUdtEnd(
 {
 	m_Depth -= 1;
 	WriteIndent();
-	Write("}");
+	m_Output.Write("}");
 
 	WriteUnnamedDataType(Kind);
 
-	Write(";");
+	m_Output.Write(";");
 
-	Write(" /* size: 0x%04x */", Size);
+	WriteSize(Size);
 
-	Write("\n");
+	m_Output.Write("\n");
 }
 
 void
@@ -364,10 +506,11 @@ PDBHeaderReconstructor::OnUdtFieldBitFieldBegin(
 		if (FirstUdtFieldBitField != LastUdtFieldBitField)
 		{
 			WriteIndent();
-			Write("%s /* bitfield */\n", PDB::GetUdtKindString(UdtStruct));
+			m_Output.Write(PDB::GetUdtKindString(UdtStruct));
+			m_Output.Write(" /* bitfield */\n");
 
 			WriteIndent();
-			Write("{\n");
+			m_Output.Write("{\n");
 
 			m_Depth += 1;
 		}
@@ -387,7 +530,7 @@ PDBHeaderReconstructor::OnUdtFieldBitFieldEnd(
 			m_Depth -= 1;
 
 			WriteIndent();
-			Write("}; /* bitfield */\n");
+			m_Output.Write("}; /* bitfield */\n");
 		}
 	}
 }
@@ -406,19 +549,19 @@ PDBHeaderReconstructor::OnPaddingMember(
 
 		WriteOffset(UdtField, -((int)PaddingSize * (int)PaddingBasicTypeSize));
 
-		Write(
-			"%s %s%u",
-			PDB::GetBasicTypeString(PaddingBasicType, PaddingBasicTypeSize),
-			m_Settings->PaddingMemberPrefix.c_str(),
-			m_PaddingMemberCounter++
-			);
+		m_Output.Write(PDB::GetBasicTypeString(PaddingBasicType, PaddingBasicTypeSize));
+		m_Output.Write(" ");
+		m_Output.Write(m_Settings->PaddingMemberPrefix);
+		WritePaddingMemberNumber();
 
 		if (PaddingSize > 1)
 		{
-			Write("[%u]", PaddingSize);
+			m_Output.Write("[");
+			m_Output.WriteDecimal(PaddingSize);
+			m_Output.Write("]");
 		}
 
-		Write(";\n");
+		m_Output.Write(";\n");
 	}
 }
 
@@ -440,19 +583,14 @@ PDBHeaderReconstructor::OnPaddingBitFieldField(
 
 	if (m_Settings->BitFieldPaddingMemberPrefix.empty())
 	{
-		Write(
-			"%s",
-			PDB::GetBasicTypeString(UdtField->Type) // TODO: UseStdInt
-		);
+		m_Output.Write(PDB::GetBasicTypeString(UdtField->Type)); // TODO: UseStdInt
 	}
 	else
 	{
-		Write(
-			"%s %s%u",
-			PDB::GetBasicTypeString(UdtField->Type), // TODO: UseStdInt
-			m_Settings->PaddingMemberPrefix.c_str(),
-			m_PaddingMemberCounter++
-		);
+		m_Output.Write(PDB::GetBasicTypeString(UdtField->Type)); // TODO: UseStdInt
+		m_Output.Write(" ");
+		m_Output.Write(m_Settings->PaddingMemberPrefix);
+		WritePaddingMemberNumber();
 	}
 
 	//
@@ -469,37 +607,59 @@ PDBHeaderReconstructor::OnPaddingBitFieldField(
 
 	assert(Bits != 0);
 
-	Write(" : %i", Bits);
+	m_Output.Write(" : ");
+	m_Output.WriteDecimal(static_cast<INT>(Bits));
 
-	Write(";");
+	m_Output.Write(";");
 
-	Write(" /* bit position: %i */", BitPosition);
+	m_Output.Write(" /* bit position: ");
+	m_Output.WriteDecimal(static_cast<INT>(BitPosition));
+	m_Output.Write(" */");
 
-	Write("\n");
+	m_Output.Write("\n");
 }
 
 void
-PDBHeaderReconstructor::Write(
-	const char* Format,
-	...
-	)
+PDBHeaderReconstructor::WriteIndent()
 {
-	char TempBuffer[8 * 1024];
-
-	va_list ArgPtr;
-	va_start(ArgPtr, Format);
-	vsprintf_s(TempBuffer, Format, ArgPtr);
-	va_end(ArgPtr);
+	m_Output.WriteSpaces(2 * m_Depth);
+}
 
-	m_Settings->OutputFile->write(TempBuffer, strlen(TempBuffer));
+void
+PDBHeaderReconstructor::WriteSize(
+	DWORD Size
+	)
+{
+	m_Output.Write(" /* size: 0x");
+	m_Output.WriteHex(Size, 4);
+	m_Output.Write(" */");
 }
 
 void
-PDBHeaderReconstructor::WriteIndent()
+PDBHeaderReconstructor::WriteDefinitionEnd()
 {
-	for (DWORD i = 0; i < m_Depth; i++)
+	//
+	// The definition at the root level is complete,
+	// pass the output on once enough of it is collected.
+	// Fragment recorded by BeginFragment() is complete
+	// only at EndFragment().
+	//
+
+	if (m_IsRecordingFragment)
+	{
+		return;
+	}
+
+	if (m_RecordedFragment != nullptr)
 	{
-		Write("  ");
+		m_RecordedFragment->Text = m_Output.GetBuffered(m_RecordedFragmentBegin);
+		m_RecordedFragment->IsRecorded = true;
+		m_RecordedFragment = nullptr;
+	}
+
+	if (m_Output.GetSize() >= FLUSH_THRESHOLD)
+	{
+		Flush();
 	}
 }
 
@@ -511,29 +671,32 @@ PDBHeaderReconstructor::WriteVariant(
 	switch (v->vt)
 	{
 		case VT_I1:
-			Write("%d", (INT)v->cVal);
+			m_Output.WriteDecimal((INT)v->cVal);
 			break;
 
 		case VT_UI1:
-			Write("0x%x", (UINT)v->bVal);
+			m_Output.Write("0x");
+			m_Output.WriteHex((UINT)v->bVal);
 			break;
 
 		case VT_I2:
-			Write("%d", (INT)v->iVal);
+			m_Output.WriteDecimal((INT)v->iVal);
 			break;
 
 		case VT_UI2:
-			Write("0x%x", (UINT)v->uiVal);
+			m_Output.Write("0x");
+			m_Output.WriteHex((UINT)v->uiVal);
 			break;
 
 		case VT_INT:
 		case VT_I4:
-			Write("%d", (INT)v->lVal);
+			m_Output.WriteDecimal((INT)v->lVal);
 			break;
 
 		case VT_UINT:
 		case VT_UI4:
-			Write("0x%x", (UINT)v->ulVal);
+			m_Output.Write("0x");
+			m_Output.WriteHex((UINT)v->ulVal);
 			break;
 	}
 }
@@ -549,11 +712,13 @@ PDBHeaderReconstructor::WriteUnnamedDataType(
 		{
 			case UdtStruct:
 			case UdtClass:
-				Write(" %s", m_Settings->AnonymousStructPrefix.c_str());
+				m_Output.Write(" ");
+				m_Output.Write(m_Settings->AnonymousStructPrefix);
 				break;
 
 			case UdtUnion:
-				Write(" %s", m_Settings->AnonymousUnionPrefix.c_str());
+				m_Output.Write(" ");
+				m_Output.Write(m_Settings->AnonymousUnionPrefix);
 				break;
 
 			default:
@@ -561,10 +726,169 @@ PDBHeaderReconstructor::WriteUnnamedDataType(
 				break;
 		}
 
-		if (m_AnonymousDataTypeCounter++ > 0)
+		WriteAnonymousDataTypeNumber();
+	}
+}
+
+bool
+PDBHeaderReconstructor::WriteCachedDefinition(
+	const SYMBOL* Symbol
+	)
+{
+	//
+	// With InlineAll the text depends on what has been visited before,
+	// and the tests are produced only while the definition is rendered.
+	// Definition recorded by BeginFragment() is always rendered.
+	//
+
+	if (!m_IsDefinitionCacheEnabled ||
+	    m_Settings->MemberStructExpansion == MemberStructExpansionType::InlineAll ||
+	    m_Settings->TestFile != nullptr ||
+	    m_IsRecordingFragment)
+	{
+		return false;
+	}
+
+	auto [It, Inserted] = m_DefinitionFragments.try_emplace(Symbol);
+	DefinitionFragment& Fragment = It->second;
+
+	if (Inserted)
+	{
+		//
+		// Rendered for the first time.
+		//
+
+		return false;
+	}
+
+	if (Fragment.IsRecorded)
+	{
+		ReplayDefinition(Fragment);
+		return true;
+	}
+
+	//
+	// Record the definition while it's rendered.
+	//
+
+	Fragment = DefinitionFragment();
+
+	m_RecordedFragment = &Fragment;
+	m_RecordedFragmentBegin = m_Output.GetSize();
+
+	return false;
+}
+
+void
+PDBHeaderReconstructor::EnableDefinitionCache()
+{
+	std::string SettingsKey = GetDefinitionSettingsKey();
+
+	if (SettingsKey != m_DefinitionFragmentsSettingsKey)
+	{
+		m_DefinitionFragments.clear();
+		m_DefinitionFragmentsSettingsKey = std::move(SettingsKey);
+	}
+
+	m_IsDefinitionCacheEnabled = true;
+}
+
+void
+PDBHeaderReconstructor::ReplayDefinition(
+	const DefinitionFragment& Fragment
+	)
+{
+	size_t Position = 0;
+
+	for (auto& Hole : Fragment.Holes)
+	{
+		m_Output.Write(&Fragment.Text[Position], Hole.Begin - Position);
+
+		switch (Hole.Kind)
 		{
-			Write("%u", m_AnonymousDataTypeCounter);
+			case DefinitionFragment::HoleKind::PaddingMemberNumber:
+				WritePaddingMemberNumber();
+				break;
+
+			case DefinitionFragment::HoleKind::AnonymousDataTypeNumber:
+				WriteAnonymousDataTypeNumber();
+				break;
 		}
+
+		Position = Hole.End;
+	}
+
+	m_Output.Write(&Fragment.Text[Position], Fragment.Text.size() - Position);
+}
+
+std::string
+PDBHeaderReconstructor::GetDefinitionSettingsKey() const
+{
+	//
+	// Everything from the Settings which affects the text.
+	// Settings of the member definitions are fixed for the lifetime
+	// of the visitor which drives this reconstructor.
+	//
+
+	std::string Key;
+
+	Key += static_cast<char>('0' + static_cast<int>(m_Settings->MemberStructExpansion));
+	Key += m_Settings->CreatePaddingMembers    ? '1' : '0';
+	Key += m_Settings->ShowOffsets             ? '1' : '0';
+	Key += m_Settings->MicrosoftTypedefs       ? '1' : '0';
+	Key += m_Settings->AllowBitFieldsInUnion   ? '1' : '0';
+	Key += m_Settings->AllowAnonymousDataTypes ? '1' : '0';
+
+	for (const std::string* Prefix : {
+		&m_Settings->PaddingMemberPrefix,
+		&m_Settings->BitFieldPaddingMemberPrefix,
+		&m_Settings->UnnamedTypePrefix,
+		&m_Settings->SymbolPrefix,
+		&m_Settings->SymbolSuffix,
+		&m_Settings->AnonymousStructPrefix,
+		&m_Settings->AnonymousUnionPrefix })
+	{
+		Key += '\0';
+		Key += *Prefix;
+	}
+
+	return Key;
+}
+
+void
+PDBHeaderReconstructor::WritePaddingMemberNumber()
+{
+	size_t Begin = m_Output.GetSize();
+
+	m_Output.WriteDecimal(m_PaddingMemberCounter++);
+
+	if (m_RecordedFragment != nullptr)
+	{
+		m_RecordedFragment->Holes.push_back({
+			DefinitionFragment::HoleKind::PaddingMemberNumber,
+			Begin - m_RecordedFragmentBegin,
+			m_Output.GetSize() - m_RecordedFragmentBegin
+		});
+	}
+}
+
+void
+PDBHeaderReconstructor::WriteAnonymousDataTypeNumber()
+{
+	size_t Begin = m_Output.GetSize();
+
+	if (m_AnonymousDataTypeCounter++ > 0)
+	{
+		m_Output.WriteDecimal(m_AnonymousDataTypeCounter);
+	}
+
+	if (m_RecordedFragment != nullptr)
+	{
+		m_RecordedFragment->Holes.push_back({
+			DefinitionFragment::HoleKind::AnonymousDataTypeNumber,
+			Begin - m_RecordedFragmentBegin,
+			m_Output.GetSize() - m_RecordedFragmentBegin
+		});
 	}
 }
 
@@ -573,12 +897,12 @@ PDBHeaderReconstructor::WriteTypedefBegin(
 	const SYMBOL* Symbol
 	)
 {
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+	const std::string& CorrectedName = GetCorrectedSymbolName(Symbol);
 	bool UseTypedef = m_Settings->MicrosoftTypedefs && CorrectedName[0] == '_';
 
 	if (UseTypedef && m_Depth == 0)
 	{
-		Write("typedef ");
+		m_Output.Write("typedef ");
 	}
 }
 
@@ -587,12 +911,15 @@ PDBHeaderReconstructor::WriteTypedefEnd(
 	const SYMBOL* Symbol
 	)
 {
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+	const std::string& CorrectedName = GetCorrectedSymbolName(Symbol);
 	bool UseTypedef = m_Settings->MicrosoftTypedefs && CorrectedName[0] == '_';
 
 	if (UseTypedef && m_Depth == 0)
 	{
-		Write(" %s, *P%s", &CorrectedName[1], &CorrectedName[1]);
+		m_Output.Write(" ");
+		m_Output.Write(&CorrectedName[1], CorrectedName.size() - 1);
+		m_Output.Write(", *P");
+		m_Output.Write(&CorrectedName[1], CorrectedName.size() - 1);
 	}
 }
 
@@ -609,12 +936,12 @@ PDBHeaderReconstructor::WriteConstAndVolatile(
 
 		if (Symbol->IsConst)
 		{
-			Write("const ");
+			m_Output.Write("const ");
 		}
 
 		if (Symbol->IsVolatile)
 		{
-			Write("volatile ");
+			m_Output.Write("volatile ");
 		}
 	}
 }
@@ -627,7 +954,9 @@ PDBHeaderReconstructor::WriteOffset(
 {
 	if (m_Settings->ShowOffsets)
 	{
-		Write("/* 0x%04x */ ", UdtField->Offset + PaddingOffset);
+		m_Output.Write("/* 0x");
+		m_Output.WriteHex(static_cast<DWORD>(UdtField->Offset + PaddingOffset), 4);
+		m_Output.Write(" */ ");
 	}
 }
 
@@ -636,7 +965,7 @@ PDBHeaderReconstructor::HasBeenVisited(
 	const SYMBOL* Symbol
 	) const
 {
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+	const std::string& CorrectedName = GetCorrectedSymbolName(Symbol);
 	return m_VisitedSymbols.find(CorrectedName) != m_VisitedSymbols.end();
 }
 
@@ -645,7 +974,7 @@ PDBHeaderReconstructor::MarkAsVisited(
 	const SYMBOL* Symbol
 	)
 {
-	std::string CorrectedName = GetCorrectedSymbolName(Symbol);
+	const std::string& CorrectedName = GetCorrectedSymbolName(Symbol);
 	m_VisitedSymbols.insert(CorrectedName);
 }
 
@@ -708,14 +1037,6 @@ PDBHeaderReconstructor::AppendToTest(
 			"\"\\n\""
 			");";
 
-		//
-		// Holds corrected name of a last symbol
-		// which test was produced for.
-		// This is used for delimiting tests
-		// with extra new line.
-		//
-		static std::string LastTestedUdt;
-
 		std::string CorrectedSymbolName = GetCorrectedSymbolName(UdtField->Parent);
 
 		//
@@ -723,17 +1044,17 @@ PDBHeaderReconstructor::AppendToTest(
 		// than the previous one, delimit the output of the test
 		// by extra new line.
 		//
-		if (CorrectedSymbolName != LastTestedUdt)
+		if (CorrectedSymbolName != m_LastTestedUdt)
 		{
 			(*m_Settings->TestFile) << TestDelimiterString << std::endl;
 		}
 
-		LastTestedUdt = CorrectedSymbolName;
+		m_LastTestedUdt = CorrectedSymbolName;
 
 		//
 		// Build the line for the test.
 		//
-		static char FormattedStringBuffer[4096];
+		char FormattedStringBuffer[4096];
 		sprintf_s(
 			FormattedStringBuffer,
 			TestFormatString,
@@ -1,11 +1,15 @@
 #pragma once
+#include "OutputSink.h"
 #include "PDBReconstructorBase.h"
+#include "PDBUnnamedSymbolNames.h"
 
 #include <iostream>
 #include <numeric> // std::accumulate
 #include <string>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include <cassert>
 
@@ -67,6 +71,47 @@ class PDBHeaderReconstructor
 			bool                      AllowAnonymousDataTypes : 1;
 		};
 
+		//
+		// Counters which are carried over from one symbol
+		// to the next one (until the reconstructor is cleared).
+		//
+		struct NumberingState
+		{
+			DWORD PaddingMemberCounter     = 0;
+			DWORD AnonymousDataTypeCounter = 0;
+		};
+
+		//
+		// Rendered text of a root level definition.
+		//
+		// Numbers of the padding members and anonymous data types
+		// depend on what has been printed before, therefore the text
+		// has holes for them, filled from the current counters
+		// every time the text is written.
+		//
+		// Names of the unnamed symbols are fixed by the table
+		// of their names, the fragments are dropped when it changes.
+		//
+		struct DefinitionFragment
+		{
+			enum class HoleKind
+			{
+				PaddingMemberNumber,
+				AnonymousDataTypeNumber,
+			};
+
+			struct Hole
+			{
+				HoleKind Kind;
+				size_t   Begin;
+				size_t   End;
+			};
+
+			bool              IsRecorded = false;
+			std::string       Text;
+			std::vector<Hole> Holes;
+		};
+
 		PDBHeaderReconstructor(
 			Settings* VisitorSettings = nullptr
 			);
@@ -79,6 +124,85 @@ class PDBHeaderReconstructor
 			const SYMBOL* Symbol
 			) const;
 
+		//
+		// The output is buffered, it's written into the OutputFile
+		// only once enough of it is collected.  Flush() must be called
+		// before anything else is written into the OutputFile and before
+		// the OutputFile is changed or closed.
+		//
+		void
+		Flush();
+
+		//
+		// Writes the Text (the header, declarations, ...) as is,
+		// buffered together with the definitions.
+		//
+		void
+		WriteText(
+			const CHAR* Text
+			);
+
+		void
+		WriteText(
+			const std::string& Text
+			);
+
+		//
+		// Writes into the OutputFile(s) made so far.
+		//
+		const OutputSink::WriteStatistics&
+		GetWriteStatistics() const;
+
+		NumberingState
+		GetNumberingState() const;
+
+		void
+		SetNumberingState(
+			const NumberingState& State
+			);
+
+		//
+		// Names of the unnamed symbols are taken from the provided table.
+		// Without the table, they're computed for each symbol separately
+		// (structurally identical symbols are then named the same).
+		//
+		void
+		SetUnnamedSymbolNames(
+			const PDBUnnamedSymbolNames* UnnamedSymbolNames
+			);
+
+		//
+		// Definitions rendered between BeginFragment() and EndFragment()
+		// are recorded into the Fragment instead of the output.
+		// WriteFragment() writes the recorded text later (possibly
+		// into another reconstructor), numbered from the current counters.
+		//
+		// The text of a definition doesn't depend on what has been printed
+		// before it (except for the holes), unless the InlineAll expansion
+		// is used.
+		//
+		void
+		BeginFragment(
+			DefinitionFragment& Fragment
+			);
+
+		void
+		EndFragment();
+
+		//
+		// Root level definitions rendered more than once are cached
+		// (see DefinitionFragment) - only worth it when the output
+		// of the next symbols can reuse them, like the files of '%'.
+		// Must be called again whenever the Settings change.
+		//
+		void
+		EnableDefinitionCache();
+
+		void
+		WriteFragment(
+			const DefinitionFragment& Fragment
+			);
+
 	protected:
 		bool
 		OnEnumType(
@@ -172,15 +296,42 @@ class PDBHeaderReconstructor
 			) override;
 
 	private:
+		//
+		// Collected output is flushed (at the end of a root level
+		// definition) once it exceeds this size.
+		//
+		static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+		bool
+		WriteCachedDefinition(
+			const SYMBOL* Symbol
+			);
+
 		void
-		Write(
-			const char* Format,
-			...
+		ReplayDefinition(
+			const DefinitionFragment& Fragment
 			);
 
+		std::string
+		GetDefinitionSettingsKey() const;
+
+		void
+		WritePaddingMemberNumber();
+
+		void
+		WriteAnonymousDataTypeNumber();
+
 		void
 		WriteIndent();
 
+		void
+		WriteSize(
+			DWORD Size
+			);
+
+		void
+		WriteDefinitionEnd();
+
 		void
 		WriteVariant(
 			const VARIANT* v
@@ -238,8 +389,16 @@ class PDBHeaderReconstructor
 	private:
 		//
 		// Settings for this visitor.
+		// Without the provided settings, the default ones
+		// (owned by the visitor) are used.
 		//
 		Settings* m_Settings;
+		Settings  m_DefaultSettings;
+
+		//
+		// Output collected since the last flush.
+		//
+		OutputSink m_Output;
 
 		//
 		// Everytime visitor enters a new member (UDT field),
@@ -266,12 +425,12 @@ class PDBHeaderReconstructor
 		DWORD m_PaddingMemberCounter = 0;
 
 		//
-		// Collection of unnamed symbols.
+		// Names of the unnamed symbols, if they're provided.
 		//
 		// Unnamed symbols actually have a special name.
 		// See PDB::IsUnnamedSymbol() for more information.
 		//
-		mutable std::set<const SYMBOL*> m_UnnamedSymbols;
+		const PDBUnnamedSymbolNames* m_UnnamedSymbolNames = nullptr;
 
 		//
 		// Mapping of symbols to their "corrected" names.
@@ -283,7 +442,41 @@ class PDBHeaderReconstructor
 		// We save names of the symbols here, because some PDBs
 		// has multiple definition of the same symbol.
 		//
-		// See PDBVisitorSorter::HasBeenVisited() for more information.
+		// See PDBSymbolSorter::VisitNode() for more information.
 		//
 		std::set<std::string> m_VisitedSymbols;
+
+		//
+		// Holds corrected name of a last symbol
+		// which test was produced for.
+		// This is used for delimiting tests
+		// with extra new line.
+		//
+		std::string m_LastTestedUdt;
+
+		//
+		// Rendered root level definitions, see DefinitionFragment.
+		// Used only after EnableDefinitionCache().
+		//
+		// A definition is recorded only when it's rendered for the second
+		// time - definitions printed just once don't keep a copy of their text.
+		//
+		// The fragments survive Clear(), they're dropped by
+		// EnableDefinitionCache() when the settings which affect
+		// the text have changed.
+		//
+		std::unordered_map<const SYMBOL*, DefinitionFragment> m_DefinitionFragments;
+		std::string m_DefinitionFragmentsSettingsKey;
+		bool m_IsDefinitionCacheEnabled = false;
+
+		//
+		// Fragment of the definition being recorded (nullptr if none)
+		// and the position of its beginning in the m_Output.
+		//
+		// Fragment recorded by BeginFragment() is not a part
+		// of the output, it's removed from it by EndFragment().
+		//
+		DefinitionFragment* m_RecordedFragment = nullptr;
+		size_t m_RecordedFragmentBegin = 0;
+		bool m_IsRecordingFragment = false;
 };
@@ -0,0 +1,463 @@
+#pragma once
+#include "PDBSymbolVisitorBase.h"
+
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//
+// Memoized dependency closures of the UDTs and enums.
+//
+// When all symbols are dumped separately ('%'), every file
+// contains the symbol together with all types it embeds by value,
+// in the order produced by PDBSymbolSorter.  Many symbols share
+// big parts of their closures (common base structures, lists,
+// unicode strings, ...), therefore the closures are computed
+// only once and shared:
+//
+// - the graph of the types (edges are types embedded by value)
+//   is condensed into the strongly connected components,
+// - the ordered closure of each component is derived from the closures
+//   of its dependencies - it starts with the whole closure of the first
+//   dependency, which is not copied, but referenced.
+//
+// PDBSymbolSorter deduplicates the types by their names, which makes
+// the order depend on the symbol the sorting started from, if the closure
+// contains different types with the same name.  Such closures (and closures
+// containing cycles) are not shareable and GetClosure() refuses them - the
+// caller is expected to use the PDBSymbolSorter instead.
+//
+class PDBSymbolClosure
+	: public PDBSymbolVisitorBase
+{
+	public:
+		//
+		// Fills the Symbols with the closure of the symbol,
+		// in the same order as PDBSymbolSorter (with the default
+		// tie break) would sort them.
+		//
+		// Returns false if the closure cannot be shared.
+		//
+		bool
+		GetClosure(
+			const SYMBOL* Symbol,
+			std::vector<const SYMBOL*>& Symbols
+			)
+		{
+			Symbols.clear();
+
+			if (Symbol->Tag != SymTagUDT &&
+			    Symbol->Tag != SymTagEnum)
+			{
+				return false;
+			}
+
+			DWORD NodeIndex = GetNode(Symbol);
+
+			if (m_Nodes[NodeIndex].Component == INVALID_INDEX)
+			{
+				FindComponents(NodeIndex);
+			}
+
+			const COMPONENT& Component = m_Components[m_Nodes[NodeIndex].Component];
+
+			if (!Component.IsShareable)
+			{
+				return false;
+			}
+
+			Symbols.reserve(Component.Size);
+
+			ForEachNode(m_Nodes[NodeIndex].Component, [this, &Symbols](DWORD Node) {
+				Symbols.push_back(m_Nodes[Node].Symbol);
+			});
+
+			return true;
+		}
+
+		void
+		Clear()
+		{
+			m_Nodes.clear();
+			m_NodeMap.clear();
+			m_NodeStack.clear();
+			m_Names.clear();
+			m_NameOwners.clear();
+			m_Components.clear();
+			m_NextVisitIndex = 0;
+			m_NodeStamps.clear();
+			m_Stamp = 0;
+		}
+
+	protected:
+		void
+		VisitEnumType(
+			const SYMBOL* Symbol
+			) override
+		{
+			AddDependency(GetNode(Symbol));
+		}
+
+		void
+		VisitPointerType(
+			const SYMBOL* Symbol
+			) override
+		{
+			//
+			// Pointed types are not needed by value.
+			//
+		}
+
+		void
+		VisitUdt(
+			const SYMBOL* Symbol
+			) override
+		{
+			AddDependency(GetNode(Symbol));
+		}
+
+		void
+		VisitUdtField(
+			const SYMBOL_UDT_FIELD* UdtField
+			) override
+		{
+			Visit(UdtField->Type);
+		}
+
+	private:
+		static constexpr DWORD INVALID_INDEX = static_cast<DWORD>(-1);
+
+		struct NODE
+		{
+			const SYMBOL*      Symbol;
+
+			//
+			// Nodes embedded by value, in the order of the fields.
+			//
+			std::vector<DWORD> Dependencies;
+
+			//
+			// Index of the name, INVALID_INDEX for unnamed symbols.
+			//
+			DWORD              Name;
+
+			DWORD              Component;
+
+			//
+			// Tarjan's algorithm state.
+			//
+			DWORD              Index;
+			DWORD              LowLink;
+			bool               IsOnStack;
+		};
+
+		struct COMPONENT
+		{
+			//
+			// Closure of the component is the closure of the Base
+			// component followed by the Nodes.
+			//
+			DWORD              Base;
+			std::vector<DWORD> Nodes;
+
+			//
+			// Number of nodes in the whole closure.
+			//
+			DWORD              Size;
+
+			bool               IsShareable;
+		};
+
+		//
+		// Returns the node of the UDT/enum, creates it
+		// (together with its dependencies) on the first visit.
+		//
+		DWORD
+		GetNode(
+			const SYMBOL* Symbol
+			)
+		{
+			DWORD NodeIndex = static_cast<DWORD>(m_Nodes.size());
+
+			auto Result = m_NodeMap.try_emplace(Symbol, NodeIndex);
+
+			if (!Result.second)
+			{
+				return Result.first->second;
+			}
+
+			DWORD Name = INVALID_INDEX;
+
+			if (!PDB::IsUnnamedSymbol(Symbol))
+			{
+				Name = m_Names.try_emplace(std::string_view(Symbol->Name), static_cast<DWORD>(m_Names.size())).first->second;
+			}
+
+			m_Nodes.push_back(NODE{ Symbol, {}, Name, INVALID_INDEX, INVALID_INDEX, 0, false });
+
+			if (Symbol->Tag == SymTagUDT)
+			{
+				m_NodeStack.push_back(NodeIndex);
+
+				PDBSymbolVisitorBase::VisitUdt(Symbol);
+
+				m_NodeStack.pop_back();
+			}
+
+			return NodeIndex;
+		}
+
+		void
+		AddDependency(
+			DWORD NodeIndex
+			)
+		{
+			//
+			// Unlike in PDBSymbolSorter, edges to the nodes being built
+			// are kept - they close a cycle, which must be detected.
+			//
+
+			if (!m_NodeStack.empty())
+			{
+				m_Nodes[m_NodeStack.back()].Dependencies.push_back(NodeIndex);
+			}
+		}
+
+		//
+		// Tarjan's algorithm, finds the components reachable from the node.
+		// Components are found in the reverse topological order,
+		// so the closures of the dependencies are always known.
+		//
+		void
+		FindComponents(
+			DWORD RootIndex
+			)
+		{
+			struct FRAME
+			{
+				DWORD NodeIndex;
+				DWORD DependencyIndex;
+			};
+
+			std::vector<FRAME> CallStack;
+			std::vector<DWORD> ComponentStack;
+
+			auto Enter = [&](DWORD NodeIndex) {
+				m_Nodes[NodeIndex].Index = m_NextVisitIndex;
+				m_Nodes[NodeIndex].LowLink = m_NextVisitIndex;
+				m_Nodes[NodeIndex].IsOnStack = true;
+				m_NextVisitIndex++;
+
+				ComponentStack.push_back(NodeIndex);
+				CallStack.push_back(FRAME{ NodeIndex, 0 });
+			};
+
+			Enter(RootIndex);
+
+			while (!CallStack.empty())
+			{
+				FRAME& Frame = CallStack.back();
+				NODE& Node = m_Nodes[Frame.NodeIndex];
+
+				if (Frame.DependencyIndex < Node.Dependencies.size())
+				{
+					DWORD DependencyIndex = Node.Dependencies[Frame.DependencyIndex++];
+					NODE& Dependency = m_Nodes[DependencyIndex];
+
+					if (Dependency.Index == INVALID_INDEX)
+					{
+						Enter(DependencyIndex);
+					}
+					else if (Dependency.IsOnStack)
+					{
+						Node.LowLink = std::min(Node.LowLink, Dependency.Index);
+					}
+
+					continue;
+				}
+
+				DWORD NodeIndex = Frame.NodeIndex;
+				CallStack.pop_back();
+
+				if (!CallStack.empty())
+				{
+					NODE& Parent = m_Nodes[CallStack.back().NodeIndex];
+					Parent.LowLink = std::min(Parent.LowLink, Node.LowLink);
+				}
+
+				if (Node.LowLink == Node.Index)
+				{
+					std::vector<DWORD> Members;
+					DWORD MemberIndex;
+
+					do
+					{
+						MemberIndex = ComponentStack.back();
+						ComponentStack.pop_back();
+
+						m_Nodes[MemberIndex].IsOnStack = false;
+						Members.push_back(MemberIndex);
+					} while (MemberIndex != NodeIndex);
+
+					BuildComponent(Members);
+				}
+			}
+		}
+
+		//
+		// Computes the closure of the new component.
+		//
+		void
+		BuildComponent(
+			const std::vector<DWORD>& Members
+			)
+		{
+			DWORD ComponentIndex = static_cast<DWORD>(m_Components.size());
+
+			for (DWORD NodeIndex : Members)
+			{
+				m_Nodes[NodeIndex].Component = ComponentIndex;
+			}
+
+			m_Components.push_back(COMPONENT{ INVALID_INDEX, {}, 0, true });
+
+			const NODE& Node = m_Nodes[Members.front()];
+
+			//
+			// Cycles are possible only between different definitions
+			// of the same name, the sorter breaks them depending
+			// on where it started.
+			//
+
+			if (Members.size() > 1)
+			{
+				m_Components[ComponentIndex].IsShareable = false;
+				return;
+			}
+
+			for (DWORD Dependency : Node.Dependencies)
+			{
+				if (Dependency == Members.front() ||
+				    !m_Components[m_Nodes[Dependency].Component].IsShareable)
+				{
+					m_Components[ComponentIndex].IsShareable = false;
+					return;
+				}
+			}
+
+			//
+			// Nodes already present in the closure are marked by the current
+			// stamp, names are marked the same way (together with
+			// the node which owns them).
+			//
+
+			m_Stamp++;
+
+			m_NodeStamps.resize(m_Nodes.size(), 0);
+			m_NameOwners.resize(m_Names.size(), NAME_OWNER{ 0, INVALID_INDEX });
+
+			bool IsShareable = true;
+			std::vector<DWORD> Nodes;
+
+			auto Mark = [this, &IsShareable](DWORD NodeIndex) {
+				m_NodeStamps[NodeIndex] = m_Stamp;
+
+				DWORD Name = m_Nodes[NodeIndex].Name;
+
+				if (Name != INVALID_INDEX)
+				{
+					NAME_OWNER& Owner = m_NameOwners[Name];
+
+					if (Owner.Stamp == m_Stamp && Owner.NodeIndex != NodeIndex)
+					{
+						IsShareable = false;
+					}
+
+					Owner = NAME_OWNER{ m_Stamp, NodeIndex };
+				}
+			};
+
+			//
+			// The whole closure of the first dependency
+			// is the beginning of this closure.
+			//
+
+			DWORD Base = INVALID_INDEX;
+
+			if (!Node.Dependencies.empty())
+			{
+				Base = m_Nodes[Node.Dependencies.front()].Component;
+
+				ForEachNode(Base, Mark);
+			}
+
+			for (size_t Index = 1; Index < Node.Dependencies.size(); Index++)
+			{
+				ForEachNode(m_Nodes[Node.Dependencies[Index]].Component, [this, &Mark, &Nodes](DWORD NodeIndex) {
+					if (m_NodeStamps[NodeIndex] != m_Stamp)
+					{
+						Mark(NodeIndex);
+						Nodes.push_back(NodeIndex);
+					}
+				});
+			}
+
+			Mark(Members.front());
+			Nodes.push_back(Members.front());
+
+			COMPONENT& Component = m_Components[ComponentIndex];
+			Component.Base = Base;
+			Component.Size = (Base != INVALID_INDEX ? m_Components[Base].Size : 0) + static_cast<DWORD>(Nodes.size());
+			Component.Nodes = std::move(Nodes);
+			Component.IsShareable = IsShareable;
+		}
+
+		//
+		// Calls the Callback for each node of the closure, in order.
+		//
+		template <typename CALLBACK_TYPE>
+		void
+		ForEachNode(
+			DWORD ComponentIndex,
+			CALLBACK_TYPE&& Callback
+			)
+		{
+			std::vector<DWORD> Chain;
+
+			for (; ComponentIndex != INVALID_INDEX; ComponentIndex = m_Components[ComponentIndex].Base)
+			{
+				Chain.push_back(ComponentIndex);
+			}
+
+			for (auto It = Chain.rbegin(); It != Chain.rend(); ++It)
+			{
+				for (DWORD NodeIndex : m_Components[*It].Nodes)
+				{
+					Callback(NodeIndex);
+				}
+			}
+		}
+
+		struct NAME_OWNER
+		{
+			DWORD Stamp;
+			DWORD NodeIndex;
+		};
+
+		std::vector<NODE> m_Nodes;
+		std::unordered_map<const SYMBOL*, DWORD> m_NodeMap;
+		std::unordered_map<std::string_view, DWORD> m_Names;
+
+		//
+		// Nodes being built, the innermost one is on the top.
+		//
+		std::vector<DWORD> m_NodeStack;
+
+		std::vector<COMPONENT> m_Components;
+		DWORD m_NextVisitIndex = 0;
+
+		std::vector<DWORD> m_NodeStamps;
+		std::vector<NAME_OWNER> m_NameOwners;
+		DWORD m_Stamp = 0;
+};
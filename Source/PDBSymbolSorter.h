@@ -1,21 +1,85 @@
 #pragma once
 #include "PDBSymbolSorterBase.h"
 
+#include <algorithm>
 #include <cassert>
-#include <string>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
-#include <map>
 
+//
+// Orders the UDTs and enums so that every type is defined
+// before it is used by value.
+//
+// Visit() builds the dependency graph of the visited types:
+// a node for every UDT/enum and an edge for every type embedded
+// by value (through fields, arrays and typedefs).  Pointers don't
+// require the definition of the pointed type, therefore they don't
+// introduce any edges (and they're not followed at all).
+//
+// GetSortedSymbols() returns a topological order of the graph.
+// Among the types which can go next, the tie is broken either by
+// the order in which they were visited (which results in the
+// depth-first post-order of the visits) or alphabetically.
+//
+// GetDeclaredSymbols() returns the same types for the declarations,
+// which need no ordering - with the alphabetical tie-break they're
+// simply sorted by their names.
+//
 class PDBSymbolSorter
 	: public PDBSymbolSorterBase
 {
 	public:
+		enum class TieBreak
+		{
+			//
+			// Types are ordered as they were visited.
+			//
+			VisitOrder,
+
+			//
+			// Types are ordered by their names.
+			//
+			Alphabetical,
+		};
+
+		PDBSymbolSorter(
+			TieBreak Order = TieBreak::VisitOrder
+			)
+			: m_TieBreak(Order)
+		{
+
+		}
+
 		std::vector<const SYMBOL*>&
 		GetSortedSymbols() override
 		{
+			if (m_Dirty)
+			{
+				Sort();
+
+				m_Dirty = false;
+			}
+
 			return m_SortedSymbols;
 		}
 
+		std::vector<const SYMBOL*>&
+		GetDeclaredSymbols() override
+		{
+			if (m_TieBreak == TieBreak::VisitOrder)
+			{
+				return GetSortedSymbols();
+			}
+
+			GetSortedSymbols();
+
+			return m_DeclaredSymbols;
+		}
+
 		ImageArchitecture
 		GetImageArchitecture() const override
 		{
@@ -25,27 +89,121 @@ class PDBSymbolSorter
 		void
 		Clear() override
 		{
-			ImageArchitecture m_Architecture = ImageArchitecture::None;
+			m_Architecture = ImageArchitecture::None;
 
-			m_VisitedUdts.clear();
+			m_Nodes.clear();
+			m_NamedNodes.clear();
+			m_UnnamedNodes.clear();
+			m_NodeStack.clear();
+			m_WalkStack.clear();
+			m_VisitOrder.clear();
 			m_SortedSymbols.clear();
+			m_DeclaredSymbols.clear();
+			m_Dirty = false;
 		}
 
-	protected:
+		//
+		// The walk uses an explicit stack instead of the recursion,
+		// so that deeply nested types don't exhaust the stack.
+		// Symbols are visited in the same order as the recursive walk
+		// of the PDBSymbolVisitorBase would visit them.
+		//
 		void
-		VisitEnumType(
+		Visit(
 			const SYMBOL* Symbol
 			) override
 		{
-			if (HasBeenVisited(Symbol)) return;
+			m_WalkStack.push_back(WALK_ITEM{ Symbol, 0 });
+
+			while (!m_WalkStack.empty())
+			{
+				WALK_ITEM Item = m_WalkStack.back();
+				m_WalkStack.pop_back();
 
-			AddSymbol(Symbol);
+				if (Item.Symbol == nullptr)
+				{
+					CompleteNode(Item.NodeIndex);
+				}
+				else
+				{
+					VisitSymbol(Item.Symbol);
+				}
+			}
 		}
 
+	private:
+		struct NODE
+		{
+			const SYMBOL*      Symbol;
+
+			//
+			// Nodes which must precede this one.
+			//
+			std::vector<DWORD> Dependencies;
+
+			//
+			// Set when all dependencies of the node are known.
+			//
+			bool               IsComplete;
+		};
+
+		//
+		// Item of the walk - either a symbol to visit or (when the Symbol
+		// is nullptr) a node whose dependencies have all been visited.
+		//
+		struct WALK_ITEM
+		{
+			const SYMBOL*      Symbol;
+			DWORD              NodeIndex;
+		};
+
 		void
-		VisitPointerType(
+		VisitSymbol(
 			const SYMBOL* Symbol
-			) override
+			)
+		{
+			switch (Symbol->Tag)
+			{
+				case SymTagEnum:
+				case SymTagUDT:
+					VisitNode(Symbol);
+					break;
+
+				case SymTagTypedef:
+					m_WalkStack.push_back(WALK_ITEM{ Symbol->u.Typedef.Type, 0 });
+					break;
+
+				case SymTagPointerType:
+					//
+					// Pointers are not followed.
+					//
+					GuessImageArchitecture(Symbol);
+					break;
+
+				case SymTagArrayType:
+					m_WalkStack.push_back(WALK_ITEM{ Symbol->u.Array.ElementType, 0 });
+					break;
+
+				case SymTagFunctionType:
+					for (DWORD Index = Symbol->u.Function.ArgumentCount; Index > 0; Index--)
+					{
+						m_WalkStack.push_back(WALK_ITEM{ Symbol->u.Function.Arguments[Index - 1], 0 });
+					}
+					break;
+
+				case SymTagFunctionArgType:
+					m_WalkStack.push_back(WALK_ITEM{ Symbol->u.FunctionArg.Type, 0 });
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		void
+		GuessImageArchitecture(
+			const SYMBOL* Symbol
+			)
 		{
 			if (m_Architecture == ImageArchitecture::None)
 			{
@@ -66,34 +224,16 @@ class PDBSymbolSorter
 			}
 		}
 
+		//
+		// Finds the node of the UDT/enum or creates it on the first
+		// visit.  Types of the members of a new UDT are scheduled
+		// for the visit, followed by the completion of its node.
+		//
 		void
-		VisitUdt(
-			const SYMBOL* Symbol
-			) override
-		{
-			if (HasBeenVisited(Symbol)) return;
-
-			PDBSymbolVisitorBase::VisitUdt(Symbol);
-
-			AddSymbol(Symbol);
-		}
-
-		void
-		VisitUdtField(
-			const SYMBOL_UDT_FIELD* UdtField
-			) override
-		{
-			Visit(UdtField->Type);
-		}
-
-	private:
-		bool
-		HasBeenVisited(
+		VisitNode(
 			const SYMBOL* Symbol
 			)
 		{
-			static DWORD UnnamedCounter = 0;
-
 			//
 			// In one PDB there can be more than one symbol
 			// with same name (and different definitions),
@@ -108,39 +248,233 @@ class PDBSymbolSorter
 			// So let's just assume all definitions are same
 			// and/or the first one is the most correct one.
 			//
-			// Also, unnamed symbols must be handled as a special case.
+			// Also, unnamed symbols must be handled as a special case,
+			// since they all share the same few names.
 			//
 
-			std::string Key = Symbol->Name;
-			if (m_VisitedUdts.find(Key) != m_VisitedUdts.end())
+			DWORD NodeIndex = static_cast<DWORD>(m_Nodes.size());
+
+			if (PDB::IsUnnamedSymbol(Symbol))
 			{
-				return true;
+				auto Result = m_UnnamedNodes.try_emplace(Symbol, NodeIndex);
+
+				if (!Result.second)
+				{
+					AddDependency(Result.first->second);
+					return;
+				}
 			}
 			else
 			{
-				if (PDB::IsUnnamedSymbol(Symbol))
+				auto Result = m_NamedNodes.try_emplace(std::string_view(Symbol->Name), NodeIndex);
+
+				if (!Result.second)
 				{
-					Key += std::to_string(++UnnamedCounter);
+					AddDependency(Result.first->second);
+					return;
 				}
+			}
+
+			m_Nodes.push_back(NODE{ Symbol, {}, false });
+
+			if (Symbol->Tag != SymTagUDT)
+			{
+				CompleteNode(NodeIndex);
+				return;
+			}
+
+			m_NodeStack.push_back(NodeIndex);
+			m_WalkStack.push_back(WALK_ITEM{ nullptr, NodeIndex });
 
-				m_VisitedUdts[Key] = Symbol;
-				return false;
+			for (DWORD Index = Symbol->u.Udt.FieldCount; Index > 0; Index--)
+			{
+				m_WalkStack.push_back(WALK_ITEM{ Symbol->u.Udt.Fields[Index - 1].Type, 0 });
 			}
 		}
 
+		//
+		// Called when all dependencies of the node are known.
+		//
 		void
-		AddSymbol(
-			const SYMBOL* Symbol
+		CompleteNode(
+			DWORD NodeIndex
 			)
 		{
-			if (std::find(m_SortedSymbols.begin(), m_SortedSymbols.end(), Symbol) == m_SortedSymbols.end())
+			if (!m_NodeStack.empty() && m_NodeStack.back() == NodeIndex)
 			{
-				m_SortedSymbols.push_back(Symbol);
+				m_NodeStack.pop_back();
 			}
+
+			m_Nodes[NodeIndex].IsComplete = true;
+			m_VisitOrder.push_back(NodeIndex);
+			m_Dirty = true;
+
+			AddDependency(NodeIndex);
 		}
 
+		//
+		// Records that the node being built contains
+		// the provided node by value.
+		//
+		void
+		AddDependency(
+			DWORD NodeIndex
+			)
+		{
+			//
+			// Nodes which are still being built are part of a cycle
+			// (possible only between different definitions of the same
+			// name) - such edges are ignored to keep the graph acyclic.
+			//
+
+			if (!m_NodeStack.empty() && m_Nodes[NodeIndex].IsComplete)
+			{
+				m_Nodes[m_NodeStack.back()].Dependencies.push_back(NodeIndex);
+			}
+		}
+
+		void
+		Sort()
+		{
+			m_SortedSymbols.clear();
+			m_SortedSymbols.reserve(m_Nodes.size());
+			m_DeclaredSymbols.clear();
+
+			if (m_TieBreak == TieBreak::VisitOrder)
+			{
+				//
+				// Nodes are completed only after all their dependencies,
+				// so the order of completion is already topological.
+				//
+
+				for (DWORD NodeIndex : m_VisitOrder)
+				{
+					m_SortedSymbols.push_back(m_Nodes[NodeIndex].Symbol);
+				}
+
+				return;
+			}
+
+			//
+			// Kahn's algorithm, the ready nodes are taken
+			// in the order of their names (and of their creation
+			// for equal names).
+			//
+
+			std::vector<DWORD> NodesByName(m_Nodes.size());
+
+			for (DWORD NodeIndex = 0; NodeIndex < m_Nodes.size(); NodeIndex++)
+			{
+				NodesByName[NodeIndex] = NodeIndex;
+			}
+
+			std::sort(NodesByName.begin(), NodesByName.end(), [this](DWORD Lhs, DWORD Rhs) {
+				int Result = strcmp(m_Nodes[Lhs].Symbol->Name, m_Nodes[Rhs].Symbol->Name);
+				return Result != 0 ? Result < 0 : Lhs < Rhs;
+			});
+
+			m_DeclaredSymbols.reserve(m_Nodes.size());
+
+			for (DWORD NodeIndex : NodesByName)
+			{
+				m_DeclaredSymbols.push_back(m_Nodes[NodeIndex].Symbol);
+			}
+
+			std::vector<DWORD> Rank(m_Nodes.size());
+			std::vector<DWORD> PendingCount(m_Nodes.size());
+			std::vector<DWORD> DependentsBegin(m_Nodes.size() + 1, 0);
+
+			for (DWORD NodeIndex = 0; NodeIndex < m_Nodes.size(); NodeIndex++)
+			{
+				Rank[NodesByName[NodeIndex]] = NodeIndex;
+				PendingCount[NodeIndex] = static_cast<DWORD>(m_Nodes[NodeIndex].Dependencies.size());
+
+				for (DWORD Dependency : m_Nodes[NodeIndex].Dependencies)
+				{
+					DependentsBegin[Dependency + 1]++;
+				}
+			}
+
+			for (DWORD NodeIndex = 0; NodeIndex < m_Nodes.size(); NodeIndex++)
+			{
+				DependentsBegin[NodeIndex + 1] += DependentsBegin[NodeIndex];
+			}
+
+			std::vector<DWORD> Dependents(DependentsBegin.back());
+			std::vector<DWORD> DependentsEnd(DependentsBegin.begin(), DependentsBegin.end() - 1);
+
+			for (DWORD NodeIndex = 0; NodeIndex < m_Nodes.size(); NodeIndex++)
+			{
+				for (DWORD Dependency : m_Nodes[NodeIndex].Dependencies)
+				{
+					Dependents[DependentsEnd[Dependency]++] = NodeIndex;
+				}
+			}
+
+			//
+			// Ready nodes, identified by their rank.
+			//
+
+			std::priority_queue<DWORD, std::vector<DWORD>, std::greater<DWORD>> ReadyNodes;
+
+			for (DWORD NodeIndex = 0; NodeIndex < m_Nodes.size(); NodeIndex++)
+			{
+				if (PendingCount[NodeIndex] == 0)
+				{
+					ReadyNodes.push(Rank[NodeIndex]);
+				}
+			}
+
+			while (!ReadyNodes.empty())
+			{
+				DWORD NodeIndex = NodesByName[ReadyNodes.top()];
+				ReadyNodes.pop();
+
+				m_SortedSymbols.push_back(m_Nodes[NodeIndex].Symbol);
+
+				for (DWORD DependentIndex = DependentsBegin[NodeIndex]; DependentIndex < DependentsBegin[NodeIndex + 1]; DependentIndex++)
+				{
+					DWORD Dependent = Dependents[DependentIndex];
+
+					if (--PendingCount[Dependent] == 0)
+					{
+						ReadyNodes.push(Rank[Dependent]);
+					}
+				}
+			}
+
+			assert(m_SortedSymbols.size() == m_Nodes.size());
+		}
+
+		TieBreak m_TieBreak;
+
 		ImageArchitecture m_Architecture = ImageArchitecture::None;
 
-		std::map<std::string, const SYMBOL*> m_VisitedUdts;
+		std::vector<NODE> m_Nodes;
+		std::unordered_map<std::string_view, DWORD> m_NamedNodes;
+		std::unordered_map<const SYMBOL*, DWORD> m_UnnamedNodes;
+
+		//
+		// Nodes being built, the innermost one is on the top.
+		//
+		std::vector<DWORD> m_NodeStack;
+
+		//
+		// Pending items of the walk, the next one is on the top.
+		//
+		std::vector<WALK_ITEM> m_WalkStack;
+
+		//
+		// Nodes in the order of their completion.
+		//
+		std::vector<DWORD> m_VisitOrder;
+
 		std::vector<const SYMBOL*> m_SortedSymbols;
+
+		//
+		// Nodes by their names (alphabetical tie-break only).
+		//
+		std::vector<const SYMBOL*> m_DeclaredSymbols;
+
+		bool m_Dirty = false;
 };
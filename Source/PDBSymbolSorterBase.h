@@ -19,6 +19,14 @@ class PDBSymbolSorterBase
 		std::vector<const SYMBOL*>&
 		GetSortedSymbols() = 0;
 
+		//
+		// Symbols in the order of their declarations (these
+		// don't depend on each other).
+		//
+		virtual
+		std::vector<const SYMBOL*>&
+		GetDeclaredSymbols() = 0;
+
 		virtual
 		ImageArchitecture
 		GetImageArchitecture() const = 0;
@@ -0,0 +1,305 @@
+#pragma once
+#include "PDB.h"
+
+#include <algorithm>
+#include <vector>
+
+//
+// Offset index of the fields of one UDT.
+//
+// The recovery of the anonymous unions and structs (see PDBSymbolVisitor)
+// repeatedly asks which of the following members of the UDT starts
+// at some offset, or below it.  Answering these questions by scanning
+// the rest of the fields makes the recovery quadratic, which hurts
+// on big unions of structs (_KTHREAD, _KPRCB, ...).
+//
+// The index is built once per UDT:
+//
+// - bitfield runs are grouped, so the next member (with respect
+//   to the bitfields) of each field is known directly,
+// - fields are sorted by their offsets, which links each field
+//   with the next member starting at the same offset,
+// - minimal offsets of the members are kept in a sparse table,
+//   the first following member below some offset is then found
+//   in the logarithmic time.
+//
+// Member is a field which doesn't continue a bitfield run
+// (its BitPosition is 0).
+//
+class PDBUdtFieldIndex
+{
+	public:
+		PDBUdtFieldIndex(
+			const SYMBOL* Symbol
+			)
+		{
+			m_Fields     = Symbol->u.Udt.Fields;
+			m_FieldCount = Symbol->u.Udt.FieldCount;
+
+			BuildMembers();
+			BuildSameOffsetLinks();
+			BuildMinimumOffsets();
+		}
+
+		const SYMBOL_UDT_FIELD*
+		GetEndOfUdtField() const
+		{
+			return &m_Fields[m_FieldCount];
+		}
+
+		//
+		// Returns the member following the field (the field after
+		// the whole bitfield run, if the field is a part of one).
+		//
+		const SYMBOL_UDT_FIELD*
+		GetNextMember(
+			const SYMBOL_UDT_FIELD* UdtField
+			) const
+		{
+			return &m_Fields[m_NextMember[GetIndex(UdtField)]];
+		}
+
+		//
+		// Returns the last member preceding the provided field
+		// (which might be also the end of the UDT), nullptr if there's none.
+		//
+		const SYMBOL_UDT_FIELD*
+		GetPreviousMember(
+			const SYMBOL_UDT_FIELD* UdtField
+			) const
+		{
+			DWORD Index = m_PreviousMember[GetIndex(UdtField)];
+
+			return Index != INVALID_INDEX ? &m_Fields[Index] : nullptr;
+		}
+
+		//
+		// Returns the first member following the field
+		// which starts at the same offset as the field.
+		//
+		const SYMBOL_UDT_FIELD*
+		FindNextMemberAtSameOffset(
+			const SYMBOL_UDT_FIELD* UdtField
+			) const
+		{
+			return &m_Fields[m_NextMemberAtSameOffset[GetIndex(UdtField)]];
+		}
+
+		//
+		// Returns the first member (starting with the provided one)
+		// which starts below the Offset.
+		//
+		const SYMBOL_UDT_FIELD*
+		FindMemberBelow(
+			const SYMBOL_UDT_FIELD* UdtField,
+			ULONGLONG Offset
+			) const
+		{
+			DWORD Index = GetIndex(UdtField);
+
+			if (Index == m_FieldCount)
+			{
+				return GetEndOfUdtField();
+			}
+
+			//
+			// Skip the blocks of members which all start
+			// at or above the offset, from the biggest one.
+			//
+
+			DWORD Position = m_MemberPosition[Index];
+			DWORD MemberCount = static_cast<DWORD>(m_Members.size());
+
+			for (size_t Level = m_MinimumOffsets.size(); Level-- > 0; )
+			{
+				DWORD BlockSize = 1 << Level;
+
+				if (Position + BlockSize <= MemberCount &&
+				    m_MinimumOffsets[Level][Position] >= Offset)
+				{
+					Position += BlockSize;
+				}
+			}
+
+			return Position < MemberCount
+				? &m_Fields[m_Members[Position]]
+				: GetEndOfUdtField();
+		}
+
+	private:
+		static constexpr DWORD INVALID_INDEX = static_cast<DWORD>(-1);
+
+		DWORD
+		GetIndex(
+			const SYMBOL_UDT_FIELD* UdtField
+			) const
+		{
+			return static_cast<DWORD>(UdtField - m_Fields);
+		}
+
+		void
+		BuildMembers()
+		{
+			//
+			// Both arrays have one more item for the end of the UDT,
+			// so the searches can start there.
+			//
+
+			m_NextMember.resize(m_FieldCount + 1);
+			m_PreviousMember.resize(m_FieldCount + 1);
+			m_MemberPosition.resize(m_FieldCount + 1);
+
+			DWORD NextMember = m_FieldCount;
+
+			for (DWORD Index = m_FieldCount; Index-- > 0; )
+			{
+				m_NextMember[Index] = NextMember;
+
+				if (m_Fields[Index].BitPosition == 0)
+				{
+					NextMember = Index;
+				}
+			}
+
+			m_NextMember[m_FieldCount] = m_FieldCount;
+
+			DWORD PreviousMember = INVALID_INDEX;
+
+			for (DWORD Index = 0; Index <= m_FieldCount; Index++)
+			{
+				m_PreviousMember[Index] = PreviousMember;
+
+				if (Index < m_FieldCount && m_Fields[Index].BitPosition == 0)
+				{
+					PreviousMember = Index;
+
+					m_MemberPosition[Index] = static_cast<DWORD>(m_Members.size());
+					m_Members.push_back(Index);
+				}
+			}
+
+			//
+			// Searches starting at a field which is not a member
+			// start at the next member.
+			//
+
+			for (DWORD Index = 0; Index < m_FieldCount; Index++)
+			{
+				if (m_Fields[Index].BitPosition != 0)
+				{
+					DWORD NextMemberIndex = m_NextMember[Index];
+
+					m_MemberPosition[Index] = NextMemberIndex < m_FieldCount
+						? m_MemberPosition[NextMemberIndex]
+						: static_cast<DWORD>(m_Members.size());
+				}
+			}
+
+			m_MemberPosition[m_FieldCount] = static_cast<DWORD>(m_Members.size());
+		}
+
+		void
+		BuildSameOffsetLinks()
+		{
+			//
+			// Fields sorted by (offset, index).  Fields starting at the same
+			// offset are adjacent, walking each such run backwards gives
+			// the nearest following member for every field of the run.
+			//
+
+			std::vector<DWORD> FieldsByOffset(m_FieldCount);
+
+			for (DWORD Index = 0; Index < m_FieldCount; Index++)
+			{
+				FieldsByOffset[Index] = Index;
+			}
+
+			std::sort(FieldsByOffset.begin(), FieldsByOffset.end(), [this](DWORD Lhs, DWORD Rhs) {
+				return m_Fields[Lhs].Offset != m_Fields[Rhs].Offset
+					? m_Fields[Lhs].Offset < m_Fields[Rhs].Offset
+					: Lhs < Rhs;
+			});
+
+			m_NextMemberAtSameOffset.resize(m_FieldCount);
+
+			DWORD NextMember = m_FieldCount;
+
+			for (DWORD SortedIndex = m_FieldCount; SortedIndex-- > 0; )
+			{
+				DWORD Index = FieldsByOffset[SortedIndex];
+
+				if (SortedIndex + 1 == m_FieldCount ||
+				    m_Fields[FieldsByOffset[SortedIndex + 1]].Offset != m_Fields[Index].Offset)
+				{
+					NextMember = m_FieldCount;
+				}
+
+				m_NextMemberAtSameOffset[Index] = NextMember;
+
+				if (m_Fields[Index].BitPosition == 0)
+				{
+					NextMember = Index;
+				}
+			}
+		}
+
+		void
+		BuildMinimumOffsets()
+		{
+			//
+			// m_MinimumOffsets[Level][Position] holds the minimal offset
+			// of 2^Level members starting at the Position.
+			//
+
+			size_t MemberCount = m_Members.size();
+
+			if (MemberCount == 0)
+			{
+				return;
+			}
+
+			m_MinimumOffsets.emplace_back(MemberCount);
+
+			for (size_t Position = 0; Position < MemberCount; Position++)
+			{
+				m_MinimumOffsets[0][Position] = m_Fields[m_Members[Position]].Offset;
+			}
+
+			for (size_t Level = 1; (size_t(1) << Level) <= MemberCount; Level++)
+			{
+				size_t HalfSize = size_t(1) << (Level - 1);
+				size_t Count = MemberCount - (size_t(1) << Level) + 1;
+
+				std::vector<DWORD> MinimumOffsets(Count);
+
+				for (size_t Position = 0; Position < Count; Position++)
+				{
+					MinimumOffsets[Position] = (std::min)(
+						m_MinimumOffsets[Level - 1][Position],
+						m_MinimumOffsets[Level - 1][Position + HalfSize]
+						);
+				}
+
+				m_MinimumOffsets.push_back(std::move(MinimumOffsets));
+			}
+		}
+
+		const SYMBOL_UDT_FIELD* m_Fields;
+		DWORD m_FieldCount;
+
+		//
+		// Indices of the members, in the order of the fields.
+		//
+		std::vector<DWORD> m_Members;
+
+		//
+		// Per field: the next/previous member, position of the member
+		// the searches start at and the next member at the same offset.
+		//
+		std::vector<DWORD> m_NextMember;
+		std::vector<DWORD> m_PreviousMember;
+		std::vector<DWORD> m_MemberPosition;
+		std::vector<DWORD> m_NextMemberAtSameOffset;
+
+		std::vector<std::vector<DWORD>> m_MinimumOffsets;
+};
@@ -0,0 +1,1014 @@
+#include "PDBUdtLayout.h"
+#include "PDBUdtFieldIndex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <stack>
+
+namespace
+{
+	//
+	// Recovers the layout of one UDT.
+	//
+	// Fields are walked in the same way as PDBSymbolVisitorBase walks them
+	// (bitfield runs are walked as a whole), anonymous UDTs are tracked
+	// in the stacks and the nodes are appended in the pre-order.
+	//
+	class UdtLayoutBuilder
+	{
+		public:
+			UdtLayoutBuilder(
+				const SYMBOL* Symbol,
+				std::vector<PDBUdtLayout::Node>& Nodes
+				)
+				: m_Symbol(Symbol)
+				, m_UdtFieldIndex(Symbol)
+				, m_Nodes(Nodes)
+			{
+
+			}
+
+			void
+			Build();
+
+		private:
+			struct AnonymousUdt
+			{
+				//
+				// This structure holds information about
+				// nested anonymous UDTs.
+				// Anonymous UDT (ie. anonymous struct)
+				// is a type which members are in fact members
+				// of the parent UDT.
+				//
+				// struct Foo
+				// {
+				//   struct
+				//   {
+				//     int hi;
+				//     int bye;
+				//   }; // <--- no member name!
+				// };
+				//
+				// Visit http://stackoverflow.com/a/14248127 for more information about differences
+				// between unnamed and anonymous data types.
+				//
+
+				AnonymousUdt(
+					UdtKind Kind,
+					const SYMBOL_UDT_FIELD* FirstUdtField,
+					const SYMBOL_UDT_FIELD* LastUdtField,
+					DWORD Size = 0,
+					DWORD MemberCount = 0
+					)
+				{
+					this->Kind          = Kind;
+					this->FirstUdtField = FirstUdtField;
+					this->LastUdtField  = LastUdtField;
+					this->Size          = Size;
+					this->MemberCount   = MemberCount;
+				}
+
+				//
+				// First member of the anonymous UDT.
+				//
+				const SYMBOL_UDT_FIELD* FirstUdtField;
+
+				//
+				// Last member of the anonymous UDT.
+				//
+				const SYMBOL_UDT_FIELD* LastUdtField;
+
+				//
+				// Size of the anonymous UDT.
+				//
+				DWORD Size;
+
+				//
+				// Current count of members in this anonymous UDT.
+				//
+				DWORD MemberCount;
+
+				//
+				// UDT kind.
+				//
+				UdtKind Kind;
+
+				//
+				// Index of the node of this anonymous UDT.
+				//
+				DWORD NodeIndex = 0;
+			};
+
+			struct UdtFieldContext
+			{
+				UdtFieldContext(
+					const SYMBOL_UDT_FIELD* UdtField
+					)
+				{
+					SYMBOL_UDT* ParentUdt = &UdtField->Parent->u.Udt;
+					DWORD UdtFieldCount = ParentUdt->FieldCount;
+
+					FirstUdtField    = &ParentUdt->Fields[0];
+					EndOfUdtField    = &ParentUdt->Fields[UdtFieldCount];
+
+					PreviousUdtField = &UdtField[-1];
+					CurrentUdtField  = &UdtField[ 0];
+					NextUdtField     = &UdtField[ 1];
+				}
+
+				bool
+				IsFirst() const
+				{
+					return PreviousUdtField < FirstUdtField;
+				}
+
+				bool
+				IsLast() const
+				{
+					return NextUdtField == EndOfUdtField;
+				}
+
+				const SYMBOL_UDT_FIELD* FirstUdtField;
+				const SYMBOL_UDT_FIELD* EndOfUdtField;
+
+				const SYMBOL_UDT_FIELD* PreviousUdtField;
+				const SYMBOL_UDT_FIELD* CurrentUdtField;
+				const SYMBOL_UDT_FIELD* NextUdtField;
+			};
+
+			using AnonymousUdtStack = std::stack<std::shared_ptr<AnonymousUdt>>;
+
+			void
+			VisitUdtField(
+				const SYMBOL_UDT_FIELD* UdtField
+				);
+
+			void
+			VisitUdtFieldEnd(
+				const SYMBOL_UDT_FIELD* UdtField
+				);
+
+			void
+			VisitUdtFieldBitFieldEnd(
+				const SYMBOL_UDT_FIELD* UdtField
+				);
+
+			void
+			CheckForDataFieldPadding(
+				const SYMBOL_UDT_FIELD* UdtField
+				);
+
+			void
+			CheckForBitFieldFieldPadding(
+				const SYMBOL_UDT_FIELD* UdtField
+				);
+
+			void
+			CheckForAnonymousUnion(
+				const SYMBOL_UDT_FIELD* UdtField
+				);
+
+			void
+			CheckForAnonymousStruct(
+				const SYMBOL_UDT_FIELD* UdtField
+				);
+
+			void
+			CheckForEndOfAnonymousUdt(
+				const SYMBOL_UDT_FIELD* UdtField
+				);
+
+			void
+			PushAnonymousUdt(
+				std::shared_ptr<AnonymousUdt> Item
+				);
+
+			void
+			PopAnonymousUdt();
+
+			//
+			// Appends a new node, the inner nodes are closed
+			// by setting their End.
+			//
+			PDBUdtLayout::Node&
+			AddNode(
+				PDBUdtLayout::NodeKind Kind,
+				const SYMBOL_UDT_FIELD* UdtField
+				);
+
+			void
+			CloseNode(
+				DWORD NodeIndex
+				);
+
+			void
+			AddPaddingMember(
+				const SYMBOL_UDT_FIELD* UdtField,
+				BasicType PaddingBasicType,
+				DWORD PaddingBasicTypeSize,
+				DWORD PaddingSize
+				);
+
+			void
+			AddPaddingBitFieldField(
+				const SYMBOL_UDT_FIELD* UdtField,
+				const SYMBOL_UDT_FIELD* PreviousUdtField
+				);
+
+			static
+			bool
+			Is64BitBasicType(
+				const SYMBOL* Symbol
+				);
+
+			const SYMBOL* m_Symbol;
+
+			PDBUdtFieldIndex m_UdtFieldIndex;
+
+			std::vector<PDBUdtLayout::Node>& m_Nodes;
+
+			//
+			// These three properties are used for padding.
+			// m_SizeOfPreviousUdtField holds the size of the previous
+			// UDT field with respect to nested unnamed and anonymous UDTs.
+			//
+			// m_PreviousUdtField just holds pointer to the previous UDT field.
+			//
+			// m_PreviousBitFieldField holds pointer to the previous bitfield field.
+			//
+			DWORD m_SizeOfPreviousUdtField = 0;
+			const SYMBOL_UDT_FIELD* m_PreviousUdtField = nullptr;
+			const SYMBOL_UDT_FIELD* m_PreviousBitFieldField = nullptr;
+
+			//
+			// This stack holds information about anonymous UDTs.
+			// More information about anonymous UDTs are in documentation
+			// of the AnonymousUdt struct.
+			//
+			AnonymousUdtStack m_AnonymousUdtStack;
+
+			AnonymousUdtStack m_AnonymousUnionStack;
+			AnonymousUdtStack m_AnonymousStructStack;
+
+			//
+			// Node of the current bitfield.
+			//
+			DWORD m_BitFieldNodeIndex = 0;
+	};
+
+	void
+	UdtLayoutBuilder::Build()
+	{
+		const SYMBOL_UDT_FIELD* UdtField;
+		const SYMBOL_UDT_FIELD* EndOfUdtField;
+
+		if (m_Symbol->u.Udt.FieldCount == 0)
+		{
+			return;
+		}
+
+		UdtField = m_Symbol->u.Udt.Fields;
+		EndOfUdtField = &m_Symbol->u.Udt.Fields[m_Symbol->u.Udt.FieldCount];
+
+		do
+		{
+			if (UdtField->Bits == 0)
+			{
+				//
+				// Non-bitfield member.
+				//
+				VisitUdtField(UdtField);
+				VisitUdtFieldEnd(UdtField);
+			}
+			else
+			{
+				//
+				// UdtField now points to the first member of the bitfield.
+				//
+				do
+				{
+					VisitUdtField(UdtField);
+				} while (++UdtField < EndOfUdtField &&
+				           UdtField->BitPosition != 0);
+
+				VisitUdtFieldBitFieldEnd(--UdtField);
+			}
+		} while (++UdtField < EndOfUdtField);
+
+		assert(m_AnonymousUdtStack.empty());
+	}
+
+	void
+	UdtLayoutBuilder::VisitUdtField(
+		const SYMBOL_UDT_FIELD* UdtField
+		)
+	{
+		BOOL IsBitFieldMember = UdtField->Bits != 0;
+		BOOL IsFirstBitFieldMember = IsBitFieldMember && !m_PreviousBitFieldField;
+
+		if (!IsBitFieldMember || IsFirstBitFieldMember)
+		{
+			//
+			// Handling of inlined user defined types.
+			//
+			// These checks are performed when the current member
+			// is not a bitfield member (except the first one).
+			//
+			// Note that calling these inside of the bitfield
+			// would not make sense.
+			//
+
+			CheckForDataFieldPadding(UdtField);
+			CheckForAnonymousUnion(UdtField);
+			CheckForAnonymousStruct(UdtField);
+		}
+
+		//
+		// Is this the first bitfield member?
+		//
+
+		if (IsFirstBitFieldMember)
+		{
+			BOOL IsFirstBitFieldMemberPadding = UdtField->BitPosition != 0;
+
+			//
+			// If first bitfield field is padding, set the first field as nullptr.
+			// This forces creation of the "wrapping" struct even if this bitfield
+			// has only one NAMED member.
+			//
+
+			m_BitFieldNodeIndex = static_cast<DWORD>(m_Nodes.size());
+
+			PDBUdtLayout::Node& Node = AddNode(
+				PDBUdtLayout::NodeKind::BitField,
+				IsFirstBitFieldMemberPadding ? nullptr : UdtField
+				);
+
+			Node.u.BitField.LastUdtField = m_UdtFieldIndex.GetNextMember(UdtField) - 1;
+		}
+
+		if (IsBitFieldMember)
+		{
+			//
+			// Handling of unnamed bitfield fields.
+			//
+
+			CheckForBitFieldFieldPadding(UdtField);
+		}
+
+		AddNode(PDBUdtLayout::NodeKind::Member, UdtField);
+
+		//
+		// Remember this UdtField as a last bitfield field.
+		//
+
+		if (IsBitFieldMember)
+		{
+			m_PreviousBitFieldField = UdtField;
+		}
+	}
+
+	void
+	UdtLayoutBuilder::VisitUdtFieldEnd(
+		const SYMBOL_UDT_FIELD* UdtField
+		)
+	{
+		CheckForEndOfAnonymousUdt(UdtField);
+	}
+
+	void
+	UdtLayoutBuilder::VisitUdtFieldBitFieldEnd(
+		const SYMBOL_UDT_FIELD* UdtField
+		)
+	{
+		assert(m_Nodes[m_BitFieldNodeIndex].u.BitField.LastUdtField == UdtField);
+
+		CloseNode(m_BitFieldNodeIndex);
+
+		VisitUdtFieldEnd(UdtField);
+
+		m_PreviousBitFieldField = nullptr;
+	}
+
+	void
+	UdtLayoutBuilder::CheckForDataFieldPadding(
+		const SYMBOL_UDT_FIELD* UdtField
+		)
+	{
+		//
+		// Members are sometimes not properly aligned.
+		// Example (original definition):
+		//   struct XYZ
+		//   {
+		//     char XYZ_1;
+		//     int  XYZ_2;  // This member actually begins at offset 4 (if packing was not applied),
+		//                  // resulting in 3 spare bytes before this field.
+		//   };
+		//
+		// This routine creates a "padding" member to fill the empty space, so the final reconstructed
+		// structure would look like following:
+		//   struct XYZ
+		//   {
+		//     char XYZ_1;
+		//     char Padding_0[3]; // Padding member.
+		//     int  XYZ_2;
+		//   };
+		//
+
+		//
+		// Take previous member, sum the size of the field and its offset
+		// and compare it to the current member offset.
+		// If the sum is less than the current member offset, there is a spare space
+		// which will be filled by padding member.
+		//
+
+		UdtFieldContext UdtFieldCtx(UdtField);
+		DWORD PreviousUdtFieldOffset = 0;
+		DWORD SizeOfPreviousUdtField = 0;
+
+		if (UdtFieldCtx.IsFirst() == false)
+		{
+			PreviousUdtFieldOffset = m_PreviousUdtField->Offset;
+			SizeOfPreviousUdtField = m_SizeOfPreviousUdtField;
+		}
+
+		if (PreviousUdtFieldOffset + SizeOfPreviousUdtField < UdtField->Offset)
+		{
+			DWORD Difference = UdtField->Offset - (PreviousUdtFieldOffset + SizeOfPreviousUdtField);
+
+			//
+			// We can use !(Difference & 3) if we want to be clever.
+			//
+
+			BOOL DifferenceIsDivisibleBy4 = !(Difference % 4);
+
+			AddPaddingMember(
+				UdtField,
+				DifferenceIsDivisibleBy4 ?     btLong     :   btChar  ,
+				DifferenceIsDivisibleBy4 ?       4        :     1     ,
+				DifferenceIsDivisibleBy4 ? Difference / 4 : Difference
+				);
+		}
+	}
+
+	void
+	UdtLayoutBuilder::CheckForBitFieldFieldPadding(
+		const SYMBOL_UDT_FIELD* UdtField
+		)
+	{
+		BOOL WasPreviousBitFieldMember = m_PreviousBitFieldField
+		  ? m_PreviousBitFieldField->Bits != 0
+		  : FALSE;
+
+		if (
+		  //
+		  // Checks if the first bitfield field is unnamed:
+		  //   struct XYZ
+		  //   {
+		  //     unsigned     : 16;  // Unnamed bitfield field!
+		  //     unsigned var : 16;
+		  //   };
+		  //
+
+		  (UdtField->BitPosition != 0 && !WasPreviousBitFieldMember) ||
+
+		  //
+		  // Checks if some middle bitfield field is unnamed:
+		  //   struct XYZ
+		  //   {
+		  //     unsigned var1 : 12;
+		  //     unsigned      : 10;  // Unnamed bitfield field!
+		  //     unsigned var2 : 12;
+		  //   };
+		  //
+
+		  (WasPreviousBitFieldMember &&
+		   UdtField->BitPosition != m_PreviousBitFieldField->BitPosition + m_PreviousBitFieldField->Bits)
+		  )
+		{
+			//
+			// Create padding bitfield field.
+			//
+
+			AddPaddingBitFieldField(UdtField, m_PreviousBitFieldField);
+		}
+	}
+
+	void
+	UdtLayoutBuilder::CheckForAnonymousUnion(
+		const SYMBOL_UDT_FIELD* UdtField
+		)
+	{
+		//
+		// When some UDT contains anonymous unions, they are not projected
+		// into the PDB file - they are part of the UDT (ie. struct).
+		// Anonymous unions can be detected through checking of starting offsets
+		// of members in the structure - if there exist more than 1 member (DataField)
+		// which start at the same offset, they are placed inside of the union.
+		//
+
+		if (m_UdtFieldIndex.GetNextMember(UdtField) == m_UdtFieldIndex.GetEndOfUdtField())
+		{
+			//
+			// If current member is the last member of the current UDT,
+			// there won't be any anonymous unions.
+			//
+
+			return;
+		}
+
+		if (!m_AnonymousUdtStack.empty() &&
+		     m_AnonymousUdtStack.top()->Kind == UdtUnion)
+		{
+			//
+			// Don't start an anonymous union while we're still inside of one.
+			//
+
+			return;
+		}
+
+		//
+		// If any following member which starts at the same offset
+		// as the current member does exist, then they must be wrapped
+		// inside of the union.
+		//
+
+		const SYMBOL_UDT_FIELD* NextUdtField = m_UdtFieldIndex.FindNextMemberAtSameOffset(UdtField);
+
+		if (NextUdtField == m_UdtFieldIndex.GetEndOfUdtField())
+		{
+			return;
+		}
+
+		//
+		// Do not try to wrap in the union
+		// those members, which are out of bounds
+		// of the anonymous struct we're currently in.
+		//
+		// In other words, this prevents creating meaningless unions
+		// which have only one member - because it detected
+		// that there exist member, which has the same offset -
+		// - but the member is already in another struct.
+		//
+		// Members at the same offset which follow the nearest one
+		// are even further, so only the nearest one is checked.
+		//
+
+		if (m_AnonymousStructStack.empty() ||
+		    NextUdtField <= m_AnonymousStructStack.top()->LastUdtField)
+		{
+			PushAnonymousUdt(std::make_shared<AnonymousUdt>(UdtUnion, UdtField, nullptr, UdtField->Type->Size));
+		}
+	}
+
+	void
+	UdtLayoutBuilder::CheckForAnonymousStruct(
+		const SYMBOL_UDT_FIELD* UdtField
+		)
+	{
+
+		//
+		// When some UDT contains anonymous structs, they are not projected
+		// into the PDB file - they are part of the structure (Udt, respectively).
+		// This dumper creates anonymous structs where it's obvious
+		// that an anonmous structure is present in the union.
+		// Consider following snippet:
+		//
+		// 0: kd> dt ntdll!_KTHREAD
+		// ...
+		//   +0x190 StackBase        : Ptr32 Void
+		//   +0x194 SuspendApc       : _KAPC
+		//   +0x194 SuspendApcFill0  : [1] UChar
+		//   +0x195 ResourceIndex    : UChar
+		//   +0x194 SuspendApcFill1  : [3] UChar
+		//   +0x197 QuantumReset     : UChar
+		//   +0x194 SuspendApcFill2  : [4] UChar
+		//   +0x198 KernelTime       : Uint4B
+		//   +0x194 SuspendApcFill3  : [36] UChar
+		//   +0x1b8 WaitPrcb         : Ptr32 _KPRCB
+		// ...
+		//
+		// Note that offset 0x194 is shared among many members, even though after those members
+		// is placed another member which starts at another offset than 0x194.
+		// This is effectively done by structs placed inside unions. The above snipped could be represented
+		// as:
+		//
+		// struct _KTHREAD {
+		// ...
+		//   /* 0x0190 */ void* StackBase;
+		//   union {
+		//     /* 0x0194 */ struct _KAPC SuspendApc;
+		//     struct {
+		//       /* 0x0194 */ unsigned char SuspendApcFill0[1];
+		//       /* 0x0195 */ unsigned char ResourceIndex;
+		//     };
+		//     struct {
+		//       /* 0x0194 */ unsigned char SuspendApcFill1[3];
+		//       /* 0x0197 */ unsigned char QuantumReset;
+		//     };
+		//     struct {
+		//       /* 0x0194 */ unsigned char SuspendApcFill2[4];
+		//       /* 0x0198 */ unsigned long KernelTime;
+		//     };
+		//     struct {
+		//       /* 0x0194 */ unsigned char SuspendApcFill3[36];
+		//       /* 0x01b8 */ KPRCB* WaitPrcb;
+		//     };
+		// ...
+		// };
+		//
+
+		const SYMBOL_UDT_FIELD* EndOfUdtField = m_UdtFieldIndex.GetEndOfUdtField();
+		const SYMBOL_UDT_FIELD* NextUdtField = m_UdtFieldIndex.GetNextMember(UdtField);
+
+		if (NextUdtField == EndOfUdtField)
+		{
+			//
+			// If current member is the last member of the current UDT,
+			// there won't be any anonymous structs.
+			//
+
+			return;
+		}
+
+		if (!m_AnonymousUdtStack.empty() &&
+		     m_AnonymousUdtStack.top()->Kind != UdtUnion)
+		{
+			//
+			// Don't start an anonymous struct while we're still inside of one.
+			//
+
+			return;
+		}
+
+		if (NextUdtField->Offset <= UdtField->Offset)
+		{
+			//
+			// If the offset of the next member is less than or equals to the offset
+			// of the actual member, we cannot create a struct here.
+			//
+
+			return;
+		}
+
+		//
+		// If some following member starts at the same offset
+		// as the current member or below the offset of the end
+		// of the last anonymous UDT, we will create an anonymous struct.
+		//
+
+		const SYMBOL_UDT_FIELD* StructBreakUdtField = m_UdtFieldIndex.FindNextMemberAtSameOffset(UdtField);
+
+		if (!m_AnonymousUdtStack.empty())
+		{
+			ULONGLONG EndOfAnonymousUdt = static_cast<DWORD>(m_AnonymousUdtStack.top()->FirstUdtField->Offset + m_AnonymousUdtStack.top()->Size);
+
+			StructBreakUdtField = (std::min)(
+				StructBreakUdtField,
+				m_UdtFieldIndex.FindMemberBelow(NextUdtField, EndOfAnonymousUdt)
+				);
+		}
+
+		if (StructBreakUdtField == EndOfUdtField)
+		{
+			return;
+		}
+
+		//
+		// Guess the last member of this anonymous struct - it's the member
+		// preceding the first member (from the one found above) which doesn't
+		// start after the current member, or the last member of the UDT.
+		// Note that this guess is not required to be correct.
+		// It only serves as a break for creation of anonymous unions.
+		//
+
+		StructBreakUdtField = m_UdtFieldIndex.FindMemberBelow(StructBreakUdtField, ULONGLONG(UdtField->Offset) + 1);
+
+		const SYMBOL_UDT_FIELD* LastUdtField = m_UdtFieldIndex.GetPreviousMember(StructBreakUdtField);
+
+		if (LastUdtField == nullptr || LastUdtField < UdtField)
+		{
+			LastUdtField = UdtField;
+		}
+
+		PushAnonymousUdt(std::make_shared<AnonymousUdt>(UdtStruct, UdtField, LastUdtField));
+	}
+
+	void
+	UdtLayoutBuilder::CheckForEndOfAnonymousUdt(
+		const SYMBOL_UDT_FIELD* UdtField
+		)
+	{
+		//
+		// This method is called after each UDT field
+		// and after the last member of the bitfield,
+		// so this is the best place to refresh
+		// these two properties.
+		//
+
+		m_PreviousUdtField       = UdtField;
+		m_SizeOfPreviousUdtField = UdtField->Type->Size;
+
+		if (m_AnonymousUdtStack.empty())
+		{
+			//
+			// No UDT to check.
+			//
+
+			return;
+		}
+
+		UdtFieldContext UdtFieldCtx(UdtField);
+
+		//
+		// The current member could be nested more than once
+		// and at this point more anonymous UDTs could be closed,
+		// so the code is wrapped inside of the loop.
+		//
+
+		AnonymousUdt* LastAnonymousUdt;
+
+		do
+		{
+			LastAnonymousUdt = m_AnonymousUdtStack.top().get();
+			LastAnonymousUdt->MemberCount += 1;
+
+			bool IsEndOfAnonymousUdt = false;
+
+			if (LastAnonymousUdt->Kind == UdtUnion)
+			{
+				//
+				// Update the size of the current nested union.
+				// The size of the union is as big as its biggest member.
+				//
+
+				LastAnonymousUdt->Size = (std::max)(LastAnonymousUdt->Size, m_SizeOfPreviousUdtField);
+
+				//
+				// Determination if this is the end of the anonymous union.
+				//
+				//   - UdtFieldCtx.IsLast()
+				//     - If the current member is last in the root structure.
+				//
+				//       This check covers all opened anonymous UDTs before
+				//       top root structure ends.
+				//
+				//   - UdtFieldCtx.NextUdtField->Offset < UdtField->Offset
+				//     - If the offset of the next member is less than to the offset of the current member.
+				//
+				//   - (UdtFieldCtx.NextUdtField->Offset == UdtField->Offset + LastAnonymousUdt->Size)
+				//     - If the offset of the next member equals to the sum of
+				//       * the offset of the current member and
+				//       * the computed size of the current nested union.
+				//
+				//   - (UdtFieldCtx.NextUdtField->Offset == UdtField->Offset + 8 && Is64BitBasicType(UdtFieldCtx.NextUdtField->Type))
+				//     - If the offset of the next member equals to the offset of current member + 8 and
+				//       the next member is of type [u]int64_t.
+				//       This is the cause of the alignment.
+				//
+				//   - (UdtFieldCtx.NextUdtField->Offset >  UdtField->Offset && UdtField->Bits != 0)
+				//     - If the offset of the next member is bigger than the offset of the current member and
+				//       current member is not a part of the bitfield.
+				//
+				//   - (UdtFieldCtx.NextUdtField->Offset >  UdtField->Offset && UdtField->Offset + UdtField->Type->Size != UdtFieldCtx.NextUdtField->Offset)
+				//     - If the offset of the next member is bigger than the offset of the current member and
+				//       the offset of the end of the current member is not equal to the offset of the next member.
+				//
+
+				IsEndOfAnonymousUdt =
+				   UdtFieldCtx.IsLast() ||
+				   UdtFieldCtx.NextUdtField->Offset <  UdtField->Offset ||
+				  (UdtFieldCtx.NextUdtField->Offset == UdtField->Offset + LastAnonymousUdt->Size) ||
+				  (UdtFieldCtx.NextUdtField->Offset == UdtField->Offset + 8 && Is64BitBasicType(UdtFieldCtx.NextUdtField->Type)) ||
+				  (UdtFieldCtx.NextUdtField->Offset >  UdtField->Offset && UdtField->Bits != 0) ||
+				  (UdtFieldCtx.NextUdtField->Offset >  UdtField->Offset && UdtField->Offset + UdtField->Type->Size != UdtFieldCtx.NextUdtField->Offset);
+			}
+			else
+			{
+				//
+				// Update the size of the current nested structure/class.
+				// The total size increases by the size of previous member.
+				// Because the previous member could be non-trivial member (ie. union),
+				// we will use the variable m_SizeOfPreviousUdtField.
+				//
+				LastAnonymousUdt->Size += m_SizeOfPreviousUdtField;
+
+				//
+				// Determination if this is the end of the anonymous struct.
+				//
+				//   - UdtFieldCtx.IsLast()
+				//     - If the current member is last in the root structure.
+				//
+				//       This check covers all opened anonymous UDTs before
+				//       top root structure ends.
+				//
+				//   - UdtFieldCtx.NextUdtField->Offset <= UdtField->Offset
+				//     - If the offset of the next member is less than or equal to the offset of the current member.
+				//
+
+				IsEndOfAnonymousUdt =
+					UdtFieldCtx.IsLast() ||
+					UdtFieldCtx.NextUdtField->Offset <= UdtField->Offset;
+
+
+				//
+				// Special condition for closing anonymous structs
+				// which are placed inside of the anonymous unions.
+				//
+				// This prevents structs to be longer than it's actually needed.
+				//
+				// If the offset of the first member after the parent union
+				// would be equal to the actual offset of the next member,
+				// we can close this struct.
+				// Also, in this struct must be at least 2 members.
+				//
+
+				AnonymousUdt* LastAnonymousUnion =
+					m_AnonymousUnionStack.empty()
+					? nullptr
+					: m_AnonymousUnionStack.top().get();
+
+				IsEndOfAnonymousUdt = IsEndOfAnonymousUdt || (
+				    LastAnonymousUnion != nullptr &&
+				   (LastAnonymousUnion->FirstUdtField->Offset + LastAnonymousUnion->Size == UdtField->Offset + UdtField->Type->Size ||
+				    LastAnonymousUnion->FirstUdtField->Offset + LastAnonymousUnion->Size == UdtFieldCtx.NextUdtField->Offset) &&
+				    LastAnonymousUdt->MemberCount >= 2
+				);
+			}
+
+			if (IsEndOfAnonymousUdt)
+			{
+				//
+				// Close the anonymous UDT.
+				//
+
+				m_SizeOfPreviousUdtField = LastAnonymousUdt->Size;
+				LastAnonymousUdt->LastUdtField = UdtField;
+
+				PopAnonymousUdt();
+
+				LastAnonymousUdt = nullptr;
+			}
+
+			if (!m_AnonymousUdtStack.empty())
+			{
+				if (m_AnonymousUdtStack.top()->Kind == UdtUnion)
+				{
+					//
+					// If the AnonymousUdtStack is still not empty
+					// and an anonymous union is at the top of it,
+					// we must set the first member of the anonymous union
+					// as the current member.
+					//
+					// The reason behind is that the first member of the union
+					// is guaranteed to be at the starting offset of the union.
+					// This not might be true for another members, as they
+					// can be part of another anonymous struct.
+					//
+					// Example:
+					//
+					// union {
+					//   int a;    /* 0x10 */
+					//   int b;    /* 0x10 */
+					//   struct {
+					//     int c;  /* 0x10 */
+					//     int d;  /* 0x14 */
+					//             /*
+					//              * This is where we are now. We end the struct here,
+					//              * and the current offset is 0x14,
+					//              * but the union starts at the offset 0x10, so we set
+					//              * the current member to the first member of the unnamed union
+					//              * which is "int a".
+					//              */
+					//   };
+					// };
+
+					UdtField = m_AnonymousUdtStack.top()->FirstUdtField;
+					m_PreviousUdtField = UdtField;
+				}
+				else
+				{
+					//
+					// If at the top of the AnonymousUdtStack is the struct or class,
+					// set the current member back to the actual current member
+					// which has been provided.
+					//
+
+					UdtField = UdtFieldCtx.CurrentUdtField;
+					m_PreviousUdtField = UdtField;
+				}
+			}
+		} while (LastAnonymousUdt == nullptr && !m_AnonymousUdtStack.empty());
+	}
+
+	void
+	UdtLayoutBuilder::PushAnonymousUdt(
+		std::shared_ptr<AnonymousUdt> Item
+		)
+	{
+		Item->NodeIndex = static_cast<DWORD>(m_Nodes.size());
+
+		AddNode(PDBUdtLayout::NodeKind::AnonymousUdt, Item->FirstUdtField).u.AnonymousUdt.Kind = Item->Kind;
+
+		m_AnonymousUdtStack.push(Item);
+
+		if (Item->Kind == UdtUnion)
+		{
+			m_AnonymousUnionStack.push(Item);
+		}
+		else
+		{
+			m_AnonymousStructStack.push(Item);
+		}
+	}
+
+	void
+	UdtLayoutBuilder::PopAnonymousUdt()
+	{
+		const AnonymousUdt* LastAnonymousUdt = m_AnonymousUdtStack.top().get();
+		PDBUdtLayout::Node& Node = m_Nodes[LastAnonymousUdt->NodeIndex];
+
+		Node.u.AnonymousUdt.LastUdtField = LastAnonymousUdt->LastUdtField;
+		Node.u.AnonymousUdt.Size = LastAnonymousUdt->Size;
+
+		CloseNode(LastAnonymousUdt->NodeIndex);
+
+		if (m_AnonymousUdtStack.top()->Kind == UdtUnion)
+		{
+			m_AnonymousUnionStack.pop();
+		}
+		else
+		{
+			m_AnonymousStructStack.pop();
+		}
+
+		m_AnonymousUdtStack.pop();
+	}
+
+	bool
+	UdtLayoutBuilder::Is64BitBasicType(
+		const SYMBOL* Symbol
+		)
+	{
+		return (Symbol->Tag == SymTagBaseType && Symbol->Size == 8);
+	}
+
+	PDBUdtLayout::Node&
+	UdtLayoutBuilder::AddNode(
+		PDBUdtLayout::NodeKind Kind,
+		const SYMBOL_UDT_FIELD* UdtField
+		)
+	{
+		PDBUdtLayout::Node Node = {};
+		Node.Kind = Kind;
+		Node.End = static_cast<DWORD>(m_Nodes.size()) + 1;
+		Node.UdtField = UdtField;
+
+		m_Nodes.push_back(Node);
+
+		return m_Nodes.back();
+	}
+
+	void
+	UdtLayoutBuilder::CloseNode(
+		DWORD NodeIndex
+		)
+	{
+		m_Nodes[NodeIndex].End = static_cast<DWORD>(m_Nodes.size());
+	}
+
+	void
+	UdtLayoutBuilder::AddPaddingMember(
+		const SYMBOL_UDT_FIELD* UdtField,
+		BasicType PaddingBasicType,
+		DWORD PaddingBasicTypeSize,
+		DWORD PaddingSize
+		)
+	{
+		PDBUdtLayout::Node& Node = AddNode(PDBUdtLayout::NodeKind::PaddingMember, UdtField);
+
+		Node.u.PaddingMember.PaddingBasicType = PaddingBasicType;
+		Node.u.PaddingMember.PaddingBasicTypeSize = PaddingBasicTypeSize;
+		Node.u.PaddingMember.PaddingSize = PaddingSize;
+	}
+
+	void
+	UdtLayoutBuilder::AddPaddingBitFieldField(
+		const SYMBOL_UDT_FIELD* UdtField,
+		const SYMBOL_UDT_FIELD* PreviousUdtField
+		)
+	{
+		PDBUdtLayout::Node& Node = AddNode(PDBUdtLayout::NodeKind::PaddingBitFieldField, UdtField);
+
+		Node.u.PaddingBitFieldField.PreviousUdtField = PreviousUdtField;
+	}
+}
+
+PDBUdtLayout::PDBUdtLayout(
+	const SYMBOL* Symbol
+	)
+{
+	UdtLayoutBuilder(Symbol, m_Nodes).Build();
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "PDB.h"
+
+#include <vector>
+
+//
+// Layout of the members of one UDT, as it should be printed.
+//
+// PDB files don't contain the anonymous unions and structs, nor the
+// padding between the members - they're recovered from the offsets
+// of the fields.  The recovery doesn't depend on any settings, therefore
+// it's done only once per UDT and the result is immutable.
+//
+// The layout is a tree stored in a flat array in the pre-order.
+// Anonymous UDTs and bitfields are the inner nodes, members
+// and paddings are the leaves:
+//
+// struct _KTHREAD
+// {
+//   ...
+//   union                                  AnonymousUdt (union)
+//   {
+//     struct _KAPC SuspendApc;               Member
+//     struct                                 AnonymousUdt (struct)
+//     {
+//       unsigned char SuspendApcFill0[1];      Member
+//       unsigned char ResourceIndex;           Member
+//     };
+//     ...
+//   };
+//   char Padding_0[3];                     PaddingMember
+//   struct /* bitfield */                  BitField
+//   {
+//     unsigned long Alertable : 1;           Member
+//     unsigned long : 2;                     PaddingBitFieldField
+//     unsigned long Timer : 1;               Member
+//   };
+//   ...
+// };
+//
+class PDBUdtLayout
+{
+	public:
+		enum class NodeKind
+		{
+			Member,
+			PaddingMember,
+			PaddingBitFieldField,
+			AnonymousUdt,
+			BitField,
+		};
+
+		struct Node
+		{
+			NodeKind Kind;
+
+			//
+			// Index of the first node behind the subtree of this node.
+			//
+			DWORD End;
+
+			//
+			// Member & PaddingBitFieldField - the field itself.
+			// PaddingMember - the field which follows the padding.
+			// AnonymousUdt - the first field of the anonymous UDT.
+			// BitField - the first field of the bitfield, nullptr
+			//            if the bitfield starts with a padding.
+			//
+			const SYMBOL_UDT_FIELD* UdtField;
+
+			union
+			{
+				struct
+				{
+					UdtKind                 Kind;
+					const SYMBOL_UDT_FIELD* LastUdtField;
+					DWORD                   Size;
+				} AnonymousUdt;
+
+				struct
+				{
+					const SYMBOL_UDT_FIELD* LastUdtField;
+				} BitField;
+
+				struct
+				{
+					BasicType               PaddingBasicType;
+					DWORD                   PaddingBasicTypeSize;
+					DWORD                   PaddingSize;
+				} PaddingMember;
+
+				struct
+				{
+					//
+					// Previous field of the bitfield, nullptr if there's none.
+					//
+					const SYMBOL_UDT_FIELD* PreviousUdtField;
+				} PaddingBitFieldField;
+			} u;
+		};
+
+		PDBUdtLayout(
+			const SYMBOL* Symbol
+			);
+
+		const std::vector<Node>&
+		GetNodes() const
+		{
+			return m_Nodes;
+		}
+
+	private:
+		std::vector<Node> m_Nodes;
+};
@@ -0,0 +1,338 @@
+#pragma once
+#include "PDB.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cassert>
+#include <cstdio>
+
+//
+// Names of the unnamed UDTs and enums (see PDB::IsUnnamedSymbol()).
+//
+// An unnamed symbol is named after the hash of its structure - its kind,
+// size, qualifiers, fields and types of the fields.  Named types
+// contribute only by their names, other types (pointers, arrays,
+// nested unnamed types, ...) are hashed by their structure as well.
+//
+// The name therefore doesn't depend on the order in which the symbols
+// are printed (by any number of threads), nor on the unrelated types
+// in the PDB - it's kept when the PDB is rebuilt with other types added
+// or removed.
+//
+// Names are assigned by Build() for all unnamed symbols of the PDB
+// (see PDB::GetUnnamedSymbols()), before anything is printed -
+// the reconstructors only read them.  Structurally identical symbols
+// are told apart by a suffix, in the order of their Type IDs, so that
+// a symbol is named alike no matter which symbols are printed.
+//
+class PDBUnnamedSymbolNames
+{
+	public:
+		//
+		// Symbols must contain all unnamed symbols of the PDB,
+		// other symbols and duplicates are ignored.
+		//
+		template <
+			typename SYMBOL_RANGE
+		>
+		void
+		Build(
+			const SYMBOL_RANGE& Symbols
+			)
+		{
+			m_Names.clear();
+
+			std::vector<std::pair<DWORD, const SYMBOL*>> Hashes;
+
+			for (const SYMBOL* Symbol : Symbols)
+			{
+				if (IsNamedHere(Symbol))
+				{
+					Hashes.emplace_back(GetHash(Symbol), Symbol);
+				}
+			}
+
+			std::sort(Hashes.begin(), Hashes.end(), [](const auto& Left, const auto& Right) {
+				return Left.first != Right.first
+					? Left.first < Right.first
+					: Left.second->TypeId < Right.second->TypeId;
+			});
+
+			Hashes.erase(std::unique(Hashes.begin(), Hashes.end()), Hashes.end());
+
+			for (size_t Begin = 0, End; Begin < Hashes.size(); Begin = End)
+			{
+				End = Begin + 1;
+
+				while (End < Hashes.size() && Hashes[End].first == Hashes[Begin].first)
+				{
+					End++;
+				}
+
+				for (size_t Index = Begin; Index < End; Index++)
+				{
+					m_Names.emplace(Hashes[Index].second, FormatName(Hashes[Index].first, static_cast<DWORD>(Index - Begin + 1)));
+				}
+			}
+		}
+
+		//
+		// Returns the name of the unnamed symbol, without any prefix.
+		//
+		// The symbol must have been present in the Build(),
+		// any other one is an internal error.
+		//
+		const std::string&
+		GetName(
+			const SYMBOL* Symbol
+			) const
+		{
+			auto It = m_Names.find(Symbol);
+
+			assert(It != m_Names.end());
+
+			if (It == m_Names.end())
+			{
+				throw std::logic_error("unnamed symbol was not named");
+			}
+
+			return It->second;
+		}
+
+		void
+		Clear()
+		{
+			m_Names.clear();
+		}
+
+	private:
+		//
+		// Bounds of the types which contribute to the hash - their depth
+		// (relative to the named symbol) and their count.  Deeper types
+		// contribute only by their tag, size and qualifiers.
+		//
+		static constexpr DWORD MAX_DEPTH   = 16;
+		static constexpr DWORD MAX_SYMBOLS = 4096;
+
+		//
+		// FNV-1a.
+		//
+		struct Hasher
+		{
+			ULONGLONG Value = 0xcbf29ce484222325ULL;
+			DWORD     SymbolCount = 0;
+
+			void
+			Add(
+				ULONGLONG Number
+				)
+			{
+				for (int Index = 0; Index < 8; Index++)
+				{
+					Value ^= (Number >> (Index * 8)) & 0xff;
+					Value *= 0x100000001b3ULL;
+				}
+			}
+
+			void
+			AddString(
+				const CHAR* String
+				)
+			{
+				for (; String != nullptr && *String != '\0'; String++)
+				{
+					Value ^= static_cast<BYTE>(*String);
+					Value *= 0x100000001b3ULL;
+				}
+
+				Add(0);
+			}
+		};
+
+		static
+		bool
+		IsNamedHere(
+			const SYMBOL* Symbol
+			)
+		{
+			return (Symbol->Tag == SymTagUDT || Symbol->Tag == SymTagEnum) &&
+			       PDB::IsUnnamedSymbol(Symbol);
+		}
+
+		static
+		DWORD
+		GetHash(
+			const SYMBOL* Symbol
+			)
+		{
+			Hasher Hash;
+			AddSymbol(Hash, Symbol, 0);
+
+			return static_cast<DWORD>(Hash.Value ^ (Hash.Value >> 32));
+		}
+
+		static
+		std::string
+		FormatName(
+			DWORD Hash,
+			DWORD Occurrence
+			)
+		{
+			CHAR Name[32];
+
+			if (Occurrence == 1)
+			{
+				snprintf(Name, sizeof(Name), "%08X", Hash);
+			}
+			else
+			{
+				snprintf(Name, sizeof(Name), "%08X_%u", Hash, Occurrence);
+			}
+
+			return Name;
+		}
+
+		static
+		ULONGLONG
+		GetVariantValue(
+			const VARIANT& Value
+			)
+		{
+			switch (Value.vt)
+			{
+				case VT_I1:  return static_cast<ULONGLONG>(Value.cVal);
+				case VT_UI1: return Value.bVal;
+				case VT_I2:  return static_cast<ULONGLONG>(Value.iVal);
+				case VT_UI2: return Value.uiVal;
+				case VT_INT:
+				case VT_I4:  return static_cast<ULONGLONG>(Value.lVal);
+				case VT_UINT:
+				case VT_UI4: return Value.ulVal;
+				default:     return Value.ullVal;
+			}
+		}
+
+		static
+		void
+		AddSymbol(
+			Hasher& Hash,
+			const SYMBOL* Symbol,
+			DWORD Depth
+			)
+		{
+			if (Symbol == nullptr)
+			{
+				Hash.Add(0);
+				return;
+			}
+
+			Hash.Add(Symbol->Tag);
+			Hash.Add(Symbol->Size);
+			Hash.Add(Symbol->IsConst ? 1 : 0);
+			Hash.Add(Symbol->IsVolatile ? 1 : 0);
+
+			if (Depth == MAX_DEPTH || ++Hash.SymbolCount > MAX_SYMBOLS)
+			{
+				return;
+			}
+
+			switch (Symbol->Tag)
+			{
+				case SymTagBaseType:
+					Hash.Add(Symbol->BaseType);
+					break;
+
+				case SymTagUDT:
+					Hash.Add(Symbol->u.Udt.Kind);
+
+					if (!PDB::IsUnnamedSymbol(Symbol))
+					{
+						Hash.AddString(Symbol->Name);
+						break;
+					}
+
+					Hash.Add(Symbol->u.Udt.FieldCount);
+
+					for (DWORD Index = 0; Index < Symbol->u.Udt.FieldCount; Index++)
+					{
+						const SYMBOL_UDT_FIELD& UdtField = Symbol->u.Udt.Fields[Index];
+
+						Hash.AddString(UdtField.Name);
+						Hash.Add(UdtField.Offset);
+						Hash.Add(UdtField.Bits);
+						Hash.Add(UdtField.BitPosition);
+
+						AddSymbol(Hash, UdtField.Type, Depth + 1);
+					}
+					break;
+
+				case SymTagEnum:
+					if (!PDB::IsUnnamedSymbol(Symbol))
+					{
+						Hash.AddString(Symbol->Name);
+						break;
+					}
+
+					Hash.Add(Symbol->u.Enum.FieldCount);
+
+					for (DWORD Index = 0; Index < Symbol->u.Enum.FieldCount; Index++)
+					{
+						const SYMBOL_ENUM_FIELD& EnumField = Symbol->u.Enum.Fields[Index];
+
+						Hash.AddString(EnumField.Name);
+						Hash.Add(GetVariantValue(EnumField.Value));
+					}
+					break;
+
+				case SymTagTypedef:
+					Hash.AddString(Symbol->Name);
+					break;
+
+				case SymTagPointerType:
+					Hash.Add(Symbol->u.Pointer.IsReference ? 1 : 0);
+
+					//
+					// Pointed unnamed types (often the symbol itself)
+					// are not expanded.
+					//
+
+					AddSymbol(
+						Hash,
+						Symbol->u.Pointer.Type,
+						Symbol->u.Pointer.Type != nullptr && IsNamedHere(Symbol->u.Pointer.Type) ? MAX_DEPTH : Depth + 1
+						);
+					break;
+
+				case SymTagArrayType:
+					Hash.Add(Symbol->u.Array.ElementCount);
+					AddSymbol(Hash, Symbol->u.Array.ElementType, Depth + 1);
+					break;
+
+				case SymTagFunctionType:
+					Hash.Add(Symbol->u.Function.CallingConvention);
+					Hash.Add(Symbol->u.Function.ArgumentCount);
+					AddSymbol(Hash, Symbol->u.Function.ReturnType, Depth + 1);
+
+					for (DWORD Index = 0; Index < Symbol->u.Function.ArgumentCount; Index++)
+					{
+						AddSymbol(Hash, Symbol->u.Function.Arguments[Index], Depth + 1);
+					}
+					break;
+
+				case SymTagFunctionArgType:
+					AddSymbol(Hash, Symbol->u.FunctionArg.Type, Depth + 1);
+					break;
+
+				default:
+					break;
+			}
+		}
+
+	private:
+		std::unordered_map<const SYMBOL*, std::string> m_Names;
+};
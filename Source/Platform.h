@@ -0,0 +1,289 @@
+#pragma once
+
+//
+// Platform abstraction.
+//
+// On Windows, all Win32 types and CodeView enumerations
+// come from the Windows SDK and the DIA SDK.
+//
+// Everywhere else only the native PDB reader is available,
+// so the subset of these definitions used by pdbex is provided here.
+// Values of the enumerations match cvconst.h.
+//
+
+#if defined(_WIN32)
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+
+#include <dia2.h>
+
+#else
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#define IN
+#define OUT
+#define VOID void
+
+#define TRUE  1
+#define FALSE 0
+
+typedef int                BOOL;
+typedef char               CHAR;
+typedef unsigned char      BYTE;
+typedef short              SHORT;
+typedef unsigned short     USHORT;
+typedef unsigned short     WORD;
+typedef int                INT;
+typedef unsigned int       UINT;
+typedef int32_t            LONG;
+typedef uint32_t           ULONG;
+typedef uint32_t           DWORD;
+typedef int64_t            LONGLONG;
+typedef uint64_t           ULONGLONG;
+
+//
+// From winnt.h
+//
+
+#define IMAGE_FILE_MACHINE_I386  0x014c
+#define IMAGE_FILE_MACHINE_IA64  0x0200
+#define IMAGE_FILE_MACHINE_ARMNT 0x01c4
+#define IMAGE_FILE_MACHINE_AMD64 0x8664
+#define IMAGE_FILE_MACHINE_ARM64 0xAA64
+
+//
+// From wtypes.h & oaidl.h
+//
+// Only integral values are ever stored in the VARIANT by pdbex.
+//
+
+typedef unsigned short VARTYPE;
+
+enum VARENUM
+{
+	VT_EMPTY    = 0,
+	VT_NULL     = 1,
+	VT_I2       = 2,
+	VT_I4       = 3,
+	VT_I1       = 16,
+	VT_UI1      = 17,
+	VT_UI2      = 18,
+	VT_UI4      = 19,
+	VT_I8       = 20,
+	VT_UI8      = 21,
+	VT_INT      = 22,
+	VT_UINT     = 23,
+};
+
+typedef struct tagVARIANT
+{
+	VARTYPE              vt;
+
+	union
+	{
+		LONGLONG           llVal;
+		LONG               lVal;
+		BYTE               bVal;
+		SHORT              iVal;
+		CHAR               cVal;
+		USHORT             uiVal;
+		ULONG              ulVal;
+		ULONGLONG          ullVal;
+		INT                intVal;
+		UINT               uintVal;
+	};
+} VARIANT;
+
+inline
+void
+VariantInit(
+	VARIANT* Variant
+	)
+{
+	memset(Variant, 0, sizeof(*Variant));
+	Variant->vt = VT_EMPTY;
+}
+
+//
+// From cvconst.h
+//
+
+enum SymTagEnum
+{
+	SymTagNull,
+	SymTagExe,
+	SymTagCompiland,
+	SymTagCompilandDetails,
+	SymTagCompilandEnv,
+	SymTagFunction,
+	SymTagBlock,
+	SymTagData,
+	SymTagAnnotation,
+	SymTagLabel,
+	SymTagPublicSymbol,
+	SymTagUDT,
+	SymTagEnum,
+	SymTagFunctionType,
+	SymTagPointerType,
+	SymTagArrayType,
+	SymTagBaseType,
+	SymTagTypedef,
+	SymTagBaseClass,
+	SymTagFriend,
+	SymTagFunctionArgType,
+	SymTagFuncDebugStart,
+	SymTagFuncDebugEnd,
+	SymTagUsingNamespace,
+	SymTagVTableShape,
+	SymTagVTable,
+	SymTagCustom,
+	SymTagThunk,
+	SymTagCustomType,
+	SymTagManagedType,
+	SymTagDimension,
+	SymTagMax
+};
+
+enum DataKind
+{
+	DataIsUnknown,
+	DataIsLocal,
+	DataIsStaticLocal,
+	DataIsParam,
+	DataIsObjectPtr,
+	DataIsFileStatic,
+	DataIsGlobal,
+	DataIsMember,
+	DataIsStaticMember,
+	DataIsConstant
+};
+
+enum UdtKind
+{
+	UdtStruct,
+	UdtClass,
+	UdtUnion,
+	UdtInterface
+};
+
+enum BasicType
+{
+	btNoType   = 0,
+	btVoid     = 1,
+	btChar     = 2,
+	btWChar    = 3,
+	btInt      = 6,
+	btUInt     = 7,
+	btFloat    = 8,
+	btBCD      = 9,
+	btBool     = 10,
+	btLong     = 13,
+	btULong    = 14,
+	btCurrency = 25,
+	btDate     = 26,
+	btVariant  = 27,
+	btComplex  = 28,
+	btBit      = 29,
+	btBSTR     = 30,
+	btHresult  = 31,
+	btChar16   = 32,
+	btChar32   = 33,
+	btChar8    = 34,
+};
+
+typedef enum CV_call_e
+{
+	CV_CALL_NEAR_C      = 0x00,
+	CV_CALL_FAR_C       = 0x01,
+	CV_CALL_NEAR_PASCAL = 0x02,
+	CV_CALL_FAR_PASCAL  = 0x03,
+	CV_CALL_NEAR_FAST   = 0x04,
+	CV_CALL_FAR_FAST    = 0x05,
+	CV_CALL_SKIPPED     = 0x06,
+	CV_CALL_NEAR_STD    = 0x07,
+	CV_CALL_FAR_STD     = 0x08,
+	CV_CALL_NEAR_SYS    = 0x09,
+	CV_CALL_FAR_SYS     = 0x0a,
+	CV_CALL_THISCALL    = 0x0b,
+	CV_CALL_MIPSCALL    = 0x0c,
+	CV_CALL_GENERIC     = 0x0d,
+	CV_CALL_ALPHACALL   = 0x0e,
+	CV_CALL_PPCCALL     = 0x0f,
+	CV_CALL_SHCALL      = 0x10,
+	CV_CALL_ARMCALL     = 0x11,
+	CV_CALL_AM33CALL    = 0x12,
+	CV_CALL_TRICALL     = 0x13,
+	CV_CALL_SH5CALL     = 0x14,
+	CV_CALL_M32RCALL    = 0x15,
+	CV_CALL_CLRCALL     = 0x16,
+	CV_CALL_INLINE      = 0x17,
+	CV_CALL_NEAR_VECTOR = 0x18,
+	CV_CALL_RESERVED    = 0x19
+} CV_call_e;
+
+typedef enum CV_CFL_LANG
+{
+	CV_CFL_C       = 0x00,
+	CV_CFL_CXX     = 0x01,
+	CV_CFL_FORTRAN = 0x02,
+	CV_CFL_MASM    = 0x03,
+	CV_CFL_PASCAL  = 0x04,
+	CV_CFL_BASIC   = 0x05,
+	CV_CFL_COBOL   = 0x06,
+	CV_CFL_LINK    = 0x07,
+	CV_CFL_CVTRES  = 0x08,
+	CV_CFL_CVTPGD  = 0x09,
+	CV_CFL_CSHARP  = 0x0a,
+	CV_CFL_VB      = 0x0b,
+	CV_CFL_ILASM   = 0x0c,
+	CV_CFL_JAVA    = 0x0d,
+	CV_CFL_JSCRIPT = 0x0e,
+	CV_CFL_MSIL    = 0x0f,
+	CV_CFL_HLSL    = 0x10,
+} CV_CFL_LANG;
+
+//
+// Secure CRT functions used throughout pdbex.
+// Only the overloads taking fixed-size arrays are provided.
+//
+
+template <
+	size_t BUFFER_SIZE
+>
+inline
+int
+vsprintf_s(
+	char (&Buffer)[BUFFER_SIZE],
+	const char* Format,
+	va_list ArgList
+	)
+{
+	return vsnprintf(Buffer, BUFFER_SIZE, Format, ArgList);
+}
+
+template <
+	size_t BUFFER_SIZE
+>
+inline
+int
+sprintf_s(
+	char (&Buffer)[BUFFER_SIZE],
+	const char* Format,
+	...
+	)
+{
+	va_list ArgList;
+	va_start(ArgList, Format);
+	int Result = vsnprintf(Buffer, BUFFER_SIZE, Format, ArgList);
+	va_end(ArgList);
+
+	return Result;
+}
+
+#endif
@@ -0,0 +1,295 @@
+#include "Statistics.h"
+
+#include <iterator>
+#include <sstream>
+
+#include <cstdio>
+
+#if !defined(_WIN32)
+#  include <sys/resource.h>
+#  include <sys/time.h>
+#else
+#  include <psapi.h>
+#endif
+
+Statistics::ScopedPhase::ScopedPhase(
+	IN Statistics* Stats,
+	IN Phase MeasuredPhase
+	)
+	: m_Stats(Stats)
+	, m_Phase(MeasuredPhase)
+	, m_CpuStart(0)
+{
+	if (m_Stats != nullptr && m_Stats->m_IsPhaseRunning)
+	{
+		//
+		// Nested phase is counted in the running one.
+		//
+
+		m_Stats = nullptr;
+	}
+
+	if (m_Stats != nullptr)
+	{
+		m_Stats->m_IsPhaseRunning = true;
+
+		m_WallStart = std::chrono::steady_clock::now();
+		m_CpuStart = GetProcessCpuTime();
+	}
+}
+
+Statistics::ScopedPhase::~ScopedPhase()
+{
+	if (m_Stats != nullptr)
+	{
+		size_t Index = static_cast<size_t>(m_Phase);
+
+		m_Stats->m_WallSeconds[Index] += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_WallStart).count();
+		m_Stats->m_CpuSeconds[Index] += GetProcessCpuTime() - m_CpuStart;
+
+		m_Stats->m_IsPhaseRunning = false;
+	}
+}
+
+Statistics::Statistics()
+	: m_WallStart(std::chrono::steady_clock::now())
+	, m_CpuStart(GetProcessCpuTime())
+{
+
+}
+
+Statistics::Counters&
+Statistics::GetCounters()
+{
+	return m_Counters;
+}
+
+VOID
+Statistics::Print(
+	IN std::ostream& Output,
+	IN Format OutputFormat
+	) const
+{
+	double TotalWallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_WallStart).count();
+	double TotalCpuSeconds = GetProcessCpuTime() - m_CpuStart;
+
+	struct
+	{
+		const CHAR* Name;
+		ULONGLONG   Value;
+	} const CounterValues[] = {
+		{ "symbols",                m_Counters.SymbolCount          },
+		{ "udt_fields",             m_Counters.UdtFieldCount        },
+		{ "enum_fields",            m_Counters.EnumFieldCount       },
+		{ "reserved_symbol_memory", m_Counters.ReservedSymbolMemory },
+		{ "used_symbol_memory",     m_Counters.UsedSymbolMemory     },
+		{ "udt_layouts",            m_Counters.UdtLayoutCount       },
+		{ "padding_members",        m_Counters.PaddingMemberCount   },
+		{ "written_bytes",          m_Counters.WrittenSize          },
+		{ "writes",                 m_Counters.WriteCount           },
+		{ "peak_rss",               GetPeakResidentSetSize()        },
+	};
+
+	//
+	// Report is written in one piece, jobs of the batch
+	// may print theirs at the same time.
+	//
+
+	std::ostringstream Report;
+	Report.setf(std::ios::fixed);
+	Report.precision(6);
+
+	if (OutputFormat == Format::Json)
+	{
+		Report << "{\n";
+		Report << "  \"phases\": {\n";
+
+		for (size_t Index = 0; Index < PHASE_COUNT; Index++)
+		{
+			Report
+				<< "    \"" << GetPhaseName(static_cast<Phase>(Index)) << "\": "
+				<< "{ \"wall_seconds\": " << m_WallSeconds[Index]
+				<< ", \"cpu_seconds\": " << m_CpuSeconds[Index] << " },\n";
+		}
+
+		Report
+			<< "    \"write\": "
+			<< "{ \"wall_seconds\": " << m_Counters.WriteNanoseconds / 1e9 << " },\n";
+
+		Report
+			<< "    \"total\": "
+			<< "{ \"wall_seconds\": " << TotalWallSeconds
+			<< ", \"cpu_seconds\": " << TotalCpuSeconds << " }\n";
+
+		Report << "  },\n";
+		Report << "  \"counters\": {\n";
+
+		for (size_t Index = 0; Index < std::size(CounterValues); Index++)
+		{
+			Report
+				<< "    \"" << CounterValues[Index].Name << "\": " << CounterValues[Index].Value
+				<< (Index + 1 < std::size(CounterValues) ? ",\n" : "\n");
+		}
+
+		Report << "  }\n";
+		Report << "}\n";
+	}
+	else
+	{
+		auto PrintHeader = [&Report](const CHAR* Name, const CHAR* Wall, const CHAR* Cpu) {
+			Report.width(24);
+			Report << std::left << Name;
+			Report.width(12);
+			Report << std::right << Wall;
+			Report.width(12);
+			Report << Cpu << "\n";
+		};
+
+		auto PrintRow = [&Report](const CHAR* Name, double WallSeconds, double CpuSeconds) {
+			Report.width(24);
+			Report << std::left << Name;
+			Report.width(12);
+			Report << std::right << WallSeconds;
+
+			if (CpuSeconds >= 0)
+			{
+				Report.width(12);
+				Report << CpuSeconds;
+			}
+
+			Report << "\n";
+		};
+
+		PrintHeader("Phase", "wall [s]", "cpu [s]");
+
+		for (size_t Index = 0; Index < PHASE_COUNT; Index++)
+		{
+			PrintRow(GetPhaseName(static_cast<Phase>(Index)), m_WallSeconds[Index], m_CpuSeconds[Index]);
+		}
+
+		PrintRow("(write)", m_Counters.WriteNanoseconds / 1e9, -1);
+		PrintRow("total", TotalWallSeconds, TotalCpuSeconds);
+
+		Report << "\n";
+
+		for (auto&& Counter : CounterValues)
+		{
+			Report.width(24);
+			Report << std::left << Counter.Name;
+			Report.width(12);
+			Report << std::right << Counter.Value << "\n";
+		}
+	}
+
+	Output << Report.str() << std::flush;
+}
+
+const CHAR*
+Statistics::GetPhaseName(
+	IN Phase MeasuredPhase
+	)
+{
+	switch (MeasuredPhase)
+	{
+		case Phase::Load:         return "load";
+		case Phase::Naming:       return "naming";
+		case Phase::Sort:         return "sort";
+		case Phase::Declarations: return "declarations";
+		case Phase::Definitions:  return "definitions";
+		case Phase::Functions:    return "functions";
+		case Phase::Files:        return "files";
+		default:                  return "unknown";
+	}
+}
+
+double
+Statistics::GetProcessCpuTime()
+{
+#if defined(_WIN32)
+	FILETIME CreationTime;
+	FILETIME ExitTime;
+	FILETIME KernelTime;
+	FILETIME UserTime;
+
+	if (!GetProcessTimes(GetCurrentProcess(), &CreationTime, &ExitTime, &KernelTime, &UserTime))
+	{
+		return 0;
+	}
+
+	auto ToSeconds = [](const FILETIME& Time) {
+		return ((static_cast<ULONGLONG>(Time.dwHighDateTime) << 32) | Time.dwLowDateTime) / 1e7;
+	};
+
+	return ToSeconds(KernelTime) + ToSeconds(UserTime);
+#else
+	struct rusage Usage;
+
+	if (getrusage(RUSAGE_SELF, &Usage) != 0)
+	{
+		return 0;
+	}
+
+	return Usage.ru_utime.tv_sec + Usage.ru_utime.tv_usec / 1e6 +
+	       Usage.ru_stime.tv_sec + Usage.ru_stime.tv_usec / 1e6;
+#endif
+}
+
+ULONGLONG
+Statistics::GetPeakResidentSetSize()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS Counters;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters)))
+	{
+		return 0;
+	}
+
+	return Counters.PeakWorkingSetSize;
+#else
+#  if defined(__linux__)
+	//
+	// ru_maxrss of Linux survives the exec(), it would report
+	// the peak of the parent process if it was bigger.
+	//
+
+	if (FILE* Status = fopen("/proc/self/status", "r"))
+	{
+		CHAR Line[256];
+		unsigned long long Kilobytes = 0;
+
+		while (fgets(Line, sizeof(Line), Status) != nullptr)
+		{
+			if (sscanf(Line, "VmHWM: %llu kB", &Kilobytes) == 1)
+			{
+				break;
+			}
+		}
+
+		fclose(Status);
+
+		if (Kilobytes != 0)
+		{
+			return static_cast<ULONGLONG>(Kilobytes) * 1024;
+		}
+	}
+#  endif
+
+	struct rusage Usage;
+
+	if (getrusage(RUSAGE_SELF, &Usage) != 0)
+	{
+		return 0;
+	}
+
+	//
+	// In bytes on macOS, in kilobytes elsewhere.
+	//
+
+#  if defined(__APPLE__)
+	return static_cast<ULONGLONG>(Usage.ru_maxrss);
+#  else
+	return static_cast<ULONGLONG>(Usage.ru_maxrss) * 1024;
+#  endif
+#endif
+}
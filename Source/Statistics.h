@@ -0,0 +1,161 @@
+#pragma once
+#include "Platform.h"
+
+#include <chrono>
+#include <ostream>
+
+//
+// Statistics of one extraction (--stats).
+//
+// Wall and CPU time is measured for each phase of the extraction.
+// Phases don't overlap - a phase started while another one is running
+// is counted in the running one.  CPU time, as well as the peak RSS,
+// is taken for the whole process (including the threads of the pools,
+// and other jobs in the batch mode).
+//
+// Counters are filled by the extractor once the extraction is done.
+//
+class Statistics
+{
+	public:
+		enum class Phase
+		{
+			//
+			// Opening of the PDB and decoding of the symbols.
+			//
+			Load,
+
+			//
+			// Naming of the unnamed symbols.
+			//
+			Naming,
+
+			//
+			// Ordering of the symbols (and their dependencies).
+			//
+			Sort,
+
+			Declarations,
+			Definitions,
+			Functions,
+
+			//
+			// Writing of the files of '%'.
+			//
+			Files,
+
+			Count,
+		};
+
+		enum class Format
+		{
+			Text,
+			Json,
+		};
+
+		struct Counters
+		{
+			//
+			// Decoded symbols and their fields.
+			//
+			ULONGLONG SymbolCount         = 0;
+			ULONGLONG UdtFieldCount       = 0;
+			ULONGLONG EnumFieldCount      = 0;
+
+			//
+			// Memory reserved for the symbols and the part
+			// of it actually occupied by them.
+			//
+			ULONGLONG ReservedSymbolMemory = 0;
+			ULONGLONG UsedSymbolMemory     = 0;
+
+			//
+			// Computed UDT layouts and padding members
+			// synthesized in them.
+			//
+			ULONGLONG UdtLayoutCount      = 0;
+			ULONGLONG PaddingMemberCount  = 0;
+
+			//
+			// Output (the header, declarations, definitions, ...) written
+			// by the OutputSink - count of its Write*() calls, bytes passed
+			// to the output files and the time of passing them.
+			//
+			ULONGLONG WrittenSize         = 0;
+			ULONGLONG WriteCount          = 0;
+			ULONGLONG WriteNanoseconds    = 0;
+		};
+
+		//
+		// Measures the phase for the lifetime of the object.
+		// Does nothing if Stats is nullptr.
+		//
+		class ScopedPhase
+		{
+			public:
+				ScopedPhase(
+					IN Statistics* Stats,
+					IN Phase MeasuredPhase
+					);
+
+				~ScopedPhase();
+
+				ScopedPhase(const ScopedPhase&) = delete;
+				ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+			private:
+				Statistics*                           m_Stats;
+				Phase                                 m_Phase;
+				std::chrono::steady_clock::time_point m_WallStart;
+				double                                m_CpuStart;
+		};
+
+		Statistics();
+
+		Counters&
+		GetCounters();
+
+		//
+		// Prints the statistics, the total time is measured
+		// from the construction up to now.
+		//
+		VOID
+		Print(
+			IN std::ostream& Output,
+			IN Format OutputFormat
+			) const;
+
+	private:
+		static
+		const CHAR*
+		GetPhaseName(
+			IN Phase MeasuredPhase
+			);
+
+		//
+		// CPU time (user + kernel) of the whole process, in seconds.
+		//
+		static
+		double
+		GetProcessCpuTime();
+
+		//
+		// Peak resident set size of the process, in bytes.
+		//
+		static
+		ULONGLONG
+		GetPeakResidentSetSize();
+
+	private:
+		static constexpr size_t PHASE_COUNT = static_cast<size_t>(Phase::Count);
+
+		double m_WallSeconds[PHASE_COUNT] = {};
+		double m_CpuSeconds[PHASE_COUNT] = {};
+
+		bool m_IsPhaseRunning = false;
+
+		std::chrono::steady_clock::time_point m_WallStart;
+		double m_CpuStart;
+
+		Counters m_Counters;
+};
@@ -0,0 +1,48 @@
+#include "StringPool.h"
+
+#include <cstring>
+
+StringPool::StringPool(
+	IN Arena& Allocator
+	)
+	: m_Arena(Allocator)
+{
+
+}
+
+const CHAR*
+StringPool::Intern(
+	IN const CHAR* String
+	)
+{
+	return String != nullptr
+		? Intern(std::string_view(String))
+		: nullptr;
+}
+
+const CHAR*
+StringPool::Intern(
+	IN std::string_view String
+	)
+{
+	auto it = m_Strings.find(String);
+
+	if (it != m_Strings.end())
+	{
+		return it->data();
+	}
+
+	CHAR* StringCopy = static_cast<CHAR*>(m_Arena.Allocate(String.size() + 1, 1));
+	memcpy(StringCopy, String.data(), String.size());
+	StringCopy[String.size()] = '\0';
+
+	m_Strings.insert(std::string_view(StringCopy, String.size()));
+
+	return StringCopy;
+}
+
+VOID
+StringPool::Clear()
+{
+	m_Strings.clear();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "Platform.h"
+#include "Arena.h"
+
+#include <string_view>
+#include <unordered_set>
+
+//
+// Deduplicating storage of null-terminated strings.
+//
+// Each distinct string is copied into the arena only once,
+// repeated names (ie. "Reserved", "Flags", ...) share the same copy.
+// Returned strings live as long as the arena.
+//
+class StringPool
+{
+	public:
+		StringPool(
+			IN Arena& Allocator
+			);
+
+		//
+		// Returns the pooled copy of the String.
+		// Returns nullptr if the String is nullptr.
+		//
+		const CHAR*
+		Intern(
+			IN const CHAR* String
+			);
+
+		const CHAR*
+		Intern(
+			IN std::string_view String
+			);
+
+		//
+		// Forgets all strings.  Memory is held by the arena,
+		// so it has to be reset separately.
+		//
+		VOID
+		Clear();
+
+	private:
+		Arena&                               m_Arena;
+		std::unordered_set<std::string_view> m_Strings;
+};
@@ -0,0 +1,211 @@
+#pragma once
+#include "Platform.h"
+
+#include <bit>
+#include <vector>
+
+typedef struct _SYMBOL SYMBOL, *PSYMBOL;
+
+//
+// Symbols addressed by their Type ID.
+//
+// Type IDs are dense (TPI type indices start at 0x1000, simple types
+// live below it), so the symbols are stored in a flat array indexed
+// by the Type ID itself.  Presence of each entry is tracked
+// in a bitmap, which makes the iteration cheap even for sparsely
+// populated maps.
+//
+// Iteration goes in the ascending order of Type IDs - for TPI it is
+// the order of the type records in the PDB.
+//
+class SymbolMap
+{
+	public:
+		class Iterator
+		{
+			public:
+				Iterator(
+					IN const SymbolMap* Map,
+					IN size_t Index
+					)
+					: m_Map(Map)
+					, m_Index(Index)
+				{
+					m_Index = m_Map->FindNext(m_Index);
+				}
+
+				SYMBOL*
+				operator*() const
+				{
+					return m_Map->m_Symbols[m_Index];
+				}
+
+				Iterator&
+				operator++()
+				{
+					m_Index = m_Map->FindNext(m_Index + 1);
+					return *this;
+				}
+
+				bool
+				operator!=(
+					IN const Iterator& Other
+					) const
+				{
+					return m_Index != Other.m_Index;
+				}
+
+			private:
+				const SymbolMap* m_Map;
+				size_t           m_Index;
+		};
+
+		//
+		// Returns nullptr if there is no symbol with such Type ID.
+		//
+		SYMBOL*
+		Get(
+			IN DWORD TypeId
+			) const
+		{
+			return TypeId < m_Symbols.size()
+				? m_Symbols[TypeId]
+				: nullptr;
+		}
+
+		//
+		// Map with a reserved range (see Reserve()) never grows
+		// past it - a Type ID outside of it is not stored and FALSE
+		// is returned.  Map without the reservation (DIA) grows
+		// as needed.
+		//
+		BOOL
+		Set(
+			IN DWORD TypeId,
+			IN SYMBOL* Symbol
+			)
+		{
+			if (TypeId >= m_Symbols.size())
+			{
+				if (m_IsReserved)
+				{
+					return FALSE;
+				}
+
+				Grow(TypeId + 1);
+			}
+
+			ULONGLONG& Word = m_Presence[TypeId / 64];
+			ULONGLONG Bit = 1ull << (TypeId % 64);
+
+			m_Count += !(Word & Bit);
+			Word |= Bit;
+
+			m_Symbols[TypeId] = Symbol;
+			return TRUE;
+		}
+
+		BOOL
+		Contains(
+			IN DWORD TypeId
+			) const
+		{
+			return TypeId < m_Symbols.size() &&
+			       (m_Presence[TypeId / 64] & (1ull << (TypeId % 64))) != 0;
+		}
+
+		//
+		// Makes room for Type IDs below TypeIdEnd, the map
+		// is then limited to them.
+		//
+		VOID
+		Reserve(
+			IN DWORD TypeIdEnd
+			)
+		{
+			Grow(TypeIdEnd);
+			m_IsReserved = TRUE;
+		}
+
+		size_t
+		GetCount() const
+		{
+			return m_Count;
+		}
+
+		BOOL
+		IsEmpty() const
+		{
+			return m_Count == 0;
+		}
+
+		VOID
+		Clear()
+		{
+			m_Symbols.clear();
+			m_Presence.clear();
+			m_Count = 0;
+			m_IsReserved = FALSE;
+		}
+
+		Iterator
+		begin() const
+		{
+			return Iterator(this, 0);
+		}
+
+		Iterator
+		end() const
+		{
+			return Iterator(this, m_Symbols.size());
+		}
+
+	private:
+		VOID
+		Grow(
+			IN DWORD TypeIdEnd
+			)
+		{
+			if (TypeIdEnd > m_Symbols.size())
+			{
+				m_Symbols.resize(TypeIdEnd, nullptr);
+				m_Presence.resize((static_cast<size_t>(TypeIdEnd) + 63) / 64, 0);
+			}
+		}
+
+		//
+		// Returns index of the first present entry at or after Index,
+		// or size of the map if there is none.
+		//
+		size_t
+		FindNext(
+			IN size_t Index
+			) const
+		{
+			size_t WordIndex = Index / 64;
+
+			if (WordIndex >= m_Presence.size())
+			{
+				return m_Symbols.size();
+			}
+
+			ULONGLONG Word = m_Presence[WordIndex] & (~0ull << (Index % 64));
+
+			while (Word == 0)
+			{
+				if (++WordIndex == m_Presence.size())
+				{
+					return m_Symbols.size();
+				}
+
+				Word = m_Presence[WordIndex];
+			}
+
+			return WordIndex * 64 + std::countr_zero(Word);
+		}
+
+		std::vector<SYMBOL*>   m_Symbols;
+		std::vector<ULONGLONG> m_Presence;
+		size_t                 m_Count = 0;
+		BOOL                   m_IsReserved = FALSE;
+};
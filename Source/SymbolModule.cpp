@@ -0,0 +1,272 @@
+#include "SymbolModule.h"
+
+#include <cstring>
+#include <mutex>
+
+SymbolModule::SymbolModule()
+{
+
+}
+
+SymbolModule::~SymbolModule()
+{
+	SymbolModule::Close();
+}
+
+VOID
+SymbolModule::Close()
+{
+	m_Path.clear();
+	m_SymbolMap.Clear();
+	m_SymbolNameMap.clear();
+	m_FunctionSet.clear();
+	m_UdtLayouts.clear();
+
+	m_StringPool.Clear();
+	m_Arena.Reset();
+}
+
+const CHAR*
+SymbolModule::GetPath() const
+{
+	return m_Path.c_str();
+}
+
+DWORD
+SymbolModule::GetMachineType() const
+{
+	return m_MachineType;
+}
+
+CV_CFL_LANG
+SymbolModule::GetLanguage() const
+{
+	return m_Language;
+}
+
+size_t
+SymbolModule::GetReservedSymbolMemory() const
+{
+	return m_Arena.GetReservedSize();
+}
+
+size_t
+SymbolModule::GetUsedSymbolMemory() const
+{
+	return m_Arena.GetUsedSize();
+}
+
+VOID
+SymbolModule::SetThreadCount(
+	IN DWORD ThreadCount
+	)
+{
+	m_ThreadCount = ThreadCount;
+}
+
+VOID
+SymbolModule::SetTrace(
+	IN Trace* Tracer
+	)
+{
+	m_Trace = Tracer;
+}
+
+SYMBOL*
+SymbolModule::GetSymbolByName(
+	IN const CHAR* SymbolName
+	)
+{
+	auto it = m_SymbolNameMap.find(SymbolName);
+	return it == m_SymbolNameMap.end() ? nullptr : it->second;
+}
+
+SYMBOL*
+SymbolModule::GetSymbolByTypeId(
+	IN DWORD TypeId
+	)
+{
+	return m_SymbolMap.Get(TypeId);
+}
+
+const SymbolMap&
+SymbolModule::GetSymbolMap()
+{
+	return m_SymbolMap;
+}
+
+const SymbolMap&
+SymbolModule::GetDecodedSymbolMap() const
+{
+	return m_SymbolMap;
+}
+
+const SymbolNameMap&
+SymbolModule::GetSymbolNameMap()
+{
+	return m_SymbolNameMap;
+}
+
+VOID
+SymbolModule::GetUnnamedSymbols(
+	OUT std::vector<const SYMBOL*>& Symbols
+	)
+{
+	for (const SYMBOL* Symbol : GetSymbolMap())
+	{
+		if ((Symbol->Tag == SymTagUDT || Symbol->Tag == SymTagEnum) &&
+		    PDB::IsUnnamedSymbol(Symbol))
+		{
+			Symbols.push_back(Symbol);
+		}
+	}
+}
+
+const FunctionSet&
+SymbolModule::GetFunctionSet() const
+{
+	return m_FunctionSet;
+}
+
+const PDBUdtLayout&
+SymbolModule::GetUdtLayout(
+	IN const SYMBOL* Symbol
+	)
+{
+	{
+		std::shared_lock<std::shared_mutex> Lock(m_UdtLayoutLock);
+
+		auto It = m_UdtLayouts.find(Symbol);
+
+		if (It != m_UdtLayouts.end())
+		{
+			return *It->second;
+		}
+	}
+
+	//
+	// The layout is computed outside of the lock.  If another thread
+	// was faster, its layout is kept and this one is thrown away.
+	//
+
+	auto UdtLayout = std::make_unique<PDBUdtLayout>(Symbol);
+
+	std::unique_lock<std::shared_mutex> Lock(m_UdtLayoutLock);
+
+	return *m_UdtLayouts.try_emplace(Symbol, std::move(UdtLayout)).first->second;
+}
+
+size_t
+SymbolModule::GetUdtLayoutCount()
+{
+	std::shared_lock<std::shared_mutex> Lock(m_UdtLayoutLock);
+
+	return m_UdtLayouts.size();
+}
+
+size_t
+SymbolModule::GetPaddingMemberCount()
+{
+	std::shared_lock<std::shared_mutex> Lock(m_UdtLayoutLock);
+
+	size_t Count = 0;
+
+	for (auto&& UdtLayout : m_UdtLayouts)
+	{
+		for (auto&& Node : UdtLayout.second->GetNodes())
+		{
+			if (Node.Kind == PDBUdtLayout::NodeKind::PaddingMember ||
+			    Node.Kind == PDBUdtLayout::NodeKind::PaddingBitFieldField)
+			{
+				Count += 1;
+			}
+		}
+	}
+
+	return Count;
+}
+
+SYMBOL*
+SymbolModule::CreateSymbol(
+	IN DWORD TypeId
+	)
+{
+	SYMBOL* Symbol;
+	Symbol = m_Arena.Allocate<SYMBOL>();
+	m_SymbolMap.Set(TypeId, Symbol);
+
+	return Symbol;
+}
+
+VOID
+SymbolModule::RegisterSymbolName(
+	IN SYMBOL* Symbol
+	)
+{
+	if (Symbol->Name)
+	{
+		m_SymbolNameMap[Symbol->Name] = Symbol;
+	}
+}
+
+VOID
+SymbolModule::CreatePaddingMember(
+	IN SYMBOL* Symbol
+	)
+{
+	if (Symbol->u.Udt.Kind == UdtStruct && Symbol->u.Udt.FieldCount > 0 && Symbol->u.Udt.Fields[Symbol->u.Udt.FieldCount - 1].Type != nullptr)
+	{
+		SYMBOL_UDT_FIELD* LastUdtField = &Symbol->u.Udt.Fields[Symbol->u.Udt.FieldCount - 1];
+		SYMBOL_UDT_FIELD* PaddingUdtField = &Symbol->u.Udt.Fields[Symbol->u.Udt.FieldCount];
+		DWORD PaddingSize = Symbol->Size - (LastUdtField->Offset + LastUdtField->Type->Size);
+
+		if (PaddingSize > 0)
+		{
+			SYMBOL* PaddingSymbolArrayElement = m_Arena.Allocate<SYMBOL>();
+			PaddingSymbolArrayElement->Tag = SymTagBaseType;
+			PaddingSymbolArrayElement->BaseType = !(PaddingSize % 4) ? btLong : btChar;
+			PaddingSymbolArrayElement->TypeId = 0;
+			PaddingSymbolArrayElement->Size = PaddingSymbolArrayElement->BaseType == btLong ? 4 : 1;
+			PaddingSymbolArrayElement->IsConst = FALSE;
+			PaddingSymbolArrayElement->IsVolatile = FALSE;
+			PaddingSymbolArrayElement->Name = nullptr;
+
+			SYMBOL* PaddingSymbolArray = m_Arena.Allocate<SYMBOL>();
+			PaddingSymbolArray->Tag = SymTagArrayType;
+			PaddingSymbolArray->BaseType = btNoType;
+			PaddingSymbolArray->TypeId = 0;
+			PaddingSymbolArray->Size = PaddingSize;
+			PaddingSymbolArray->IsConst = FALSE;
+			PaddingSymbolArray->IsVolatile = FALSE;
+			PaddingSymbolArray->Name = nullptr;
+			PaddingSymbolArray->u.Array.ElementType = PaddingSymbolArrayElement;
+			PaddingSymbolArray->u.Array.ElementCount = PaddingSymbolArrayElement->BaseType == btLong ? PaddingSize / 4 : PaddingSize;
+
+			PaddingUdtField->Name = "__PADDING__";
+			PaddingUdtField->Type = PaddingSymbolArray;
+			PaddingUdtField->Offset = LastUdtField->Offset + LastUdtField->Type->Size;
+
+			PaddingUdtField->Bits = 0;
+			PaddingUdtField->BitPosition = 0;
+			PaddingUdtField->Parent = Symbol;
+
+			Symbol->u.Udt.FieldCount++;
+		}
+	}
+}
+
+VOID
+SymbolModule::GuessMachineType(
+	IN const SYMBOL* PointerSymbol
+	)
+{
+	if (m_MachineType == 0)
+	{
+		switch (PointerSymbol->Size)
+		{
+			case 4:  m_MachineType = IMAGE_FILE_MACHINE_I386;  break;
+			case 8:  m_MachineType = IMAGE_FILE_MACHINE_AMD64; break;
+			default: m_MachineType = 0; break;
+		}
+	}
+}
@@ -0,0 +1,200 @@
+#pragma once
+#include "PDB.h"
+#include "PDBUdtLayout.h"
+#include "Arena.h"
+#include "StringPool.h"
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// Base class of the PDB readers.
+//
+// Owns all SYMBOL structures created by the reader and provides
+// lookups over them.  The symbols (together with their names, fields
+// and arguments) are allocated from the arena, so they're all released
+// at once when the module is closed.  Particular readers (DIA, native) are responsible
+// only for filling the collections during Open().
+//
+class SymbolModule
+{
+	public:
+		SymbolModule();
+
+		virtual
+		~SymbolModule();
+
+		virtual
+		BOOL
+		Open(
+			IN const CHAR* Path
+			) = 0;
+
+		virtual
+		BOOL
+		IsOpen() const = 0;
+
+		virtual
+		VOID
+		Close();
+
+		const CHAR*
+		GetPath() const;
+
+		DWORD
+		GetMachineType() const;
+
+		CV_CFL_LANG
+		GetLanguage() const;
+
+		//
+		// Memory reserved for the symbols and the part of it
+		// actually occupied by them.
+		//
+		size_t
+		GetReservedSymbolMemory() const;
+
+		size_t
+		GetUsedSymbolMemory() const;
+
+		//
+		// Number of threads the reader may use for decoding
+		// the symbols (0 = one thread per CPU).
+		//
+		VOID
+		SetThreadCount(
+			IN DWORD ThreadCount
+			);
+
+		//
+		// Trace the reader records the decoding into (may be nullptr).
+		//
+		VOID
+		SetTrace(
+			IN Trace* Tracer
+			);
+
+		//
+		// Lookups are virtual, so that the readers
+		// can decode the symbols on demand.
+		//
+
+		virtual
+		SYMBOL*
+		GetSymbolByName(
+			IN const CHAR* SymbolName
+			);
+
+		virtual
+		SYMBOL*
+		GetSymbolByTypeId(
+			IN DWORD TypeId
+			);
+
+		virtual
+		const SymbolMap&
+		GetSymbolMap();
+
+		//
+		// Symbols decoded so far, without decoding the rest.
+		//
+		const SymbolMap&
+		GetDecodedSymbolMap() const;
+
+		virtual
+		const SymbolNameMap&
+		GetSymbolNameMap();
+
+		//
+		// All unnamed UDTs and enums of the PDB (see PDB::IsUnnamedSymbol()),
+		// in any order.  The readers may decode just these instead
+		// of the whole symbol map.
+		//
+		virtual
+		VOID
+		GetUnnamedSymbols(
+			OUT std::vector<const SYMBOL*>& Symbols
+			);
+
+		const FunctionSet&
+		GetFunctionSet() const;
+
+		//
+		// Layout of the UDT is computed on the first request
+		// and kept until the module is closed.  Safe to be called
+		// from multiple threads.
+		//
+		const PDBUdtLayout&
+		GetUdtLayout(
+			IN const SYMBOL* Symbol
+			);
+
+		//
+		// Number of the layouts computed so far and number
+		// of the padding members synthesized in them.
+		//
+		size_t
+		GetUdtLayoutCount();
+
+		size_t
+		GetPaddingMemberCount();
+
+	protected:
+		//
+		// Allocates new symbol and registers it under the provided Type ID.
+		//
+		SYMBOL*
+		CreateSymbol(
+			IN DWORD TypeId
+			);
+
+		//
+		// Makes the initialized symbol reachable by its name.
+		//
+		VOID
+		RegisterSymbolName(
+			IN SYMBOL* Symbol
+			);
+
+		//
+		// Appends the "__PADDING__" member to the struct, if its last
+		// member does not span up to the end of the struct.
+		//
+		// The Fields array must have room for one extra member.
+		//
+		VOID
+		CreatePaddingMember(
+			IN SYMBOL* Symbol
+			);
+
+		//
+		// Sometimes the machine type is not stored in the PDB.
+		// If this is our case, guess the machine type by pointer size.
+		//
+		VOID
+		GuessMachineType(
+			IN const SYMBOL* PointerSymbol
+			);
+
+	protected:
+		std::string   m_Path;
+		SymbolMap     m_SymbolMap;
+		SymbolNameMap m_SymbolNameMap;
+		FunctionSet   m_FunctionSet;
+
+		Arena         m_Arena;
+		StringPool    m_StringPool{ m_Arena };
+
+		DWORD         m_MachineType = 0;
+		CV_CFL_LANG   m_Language = CV_CFL_C;
+
+		DWORD         m_ThreadCount = 0;
+		Trace*        m_Trace = nullptr;
+
+	private:
+		std::shared_mutex m_UdtLayoutLock;
+		std::unordered_map<const SYMBOL*, std::unique_ptr<PDBUdtLayout>> m_UdtLayouts;
+};
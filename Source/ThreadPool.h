@@ -0,0 +1,97 @@
+#pragma once
+#include "Platform.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+//
+// Fork-join helper for running independent work items
+// on multiple threads.
+//
+class ThreadPool
+{
+	public:
+		//
+		// ThreadCount == 0 means "one thread per CPU".
+		//
+		ThreadPool(
+			IN DWORD ThreadCount = 0
+			)
+		{
+			m_ThreadCount = ThreadCount != 0
+				? ThreadCount
+				: static_cast<DWORD>(std::thread::hardware_concurrency());
+
+			m_ThreadCount = (std::max)(m_ThreadCount, 1u);
+		}
+
+		DWORD
+		GetThreadCount() const
+		{
+			return m_ThreadCount;
+		}
+
+		//
+		// Splits [0, Count) into chunks of ChunkSize items and calls
+		// Function(WorkerIndex, Begin, End) for each of them.
+		//
+		// Workers take the chunks from a shared cursor, so the threads
+		// which finish early keep taking over the remaining work.
+		// WorkerIndex is in [0, GetThreadCount()) and can be used
+		// for addressing per-thread data.
+		//
+		// Returns after all chunks have been processed.
+		//
+		template <
+			typename FUNCTION
+		>
+		VOID
+		ParallelFor(
+			IN size_t Count,
+			IN size_t ChunkSize,
+			IN FUNCTION&& Function
+			)
+		{
+			std::atomic<size_t> NextChunk{ 0 };
+
+			auto Worker = [&](DWORD WorkerIndex) {
+				for (;;)
+				{
+					size_t Begin = NextChunk.fetch_add(ChunkSize);
+
+					if (Begin >= Count)
+					{
+						break;
+					}
+
+					Function(WorkerIndex, Begin, (std::min)(Begin + ChunkSize, Count));
+				}
+			};
+
+			size_t ChunkCount = (Count + ChunkSize - 1) / ChunkSize;
+			DWORD ThreadCount = static_cast<DWORD>((std::min)(static_cast<size_t>(m_ThreadCount), ChunkCount));
+
+			std::vector<std::thread> Threads;
+
+			for (DWORD WorkerIndex = 1; WorkerIndex < ThreadCount; WorkerIndex++)
+			{
+				Threads.emplace_back(Worker, WorkerIndex);
+			}
+
+			//
+			// Calling thread works too.
+			//
+
+			Worker(0);
+
+			for (auto&& Thread : Threads)
+			{
+				Thread.join();
+			}
+		}
+
+	private:
+		DWORD m_ThreadCount;
+};
@@ -0,0 +1,210 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+
+#include <cstdio>
+
+namespace
+{
+	std::atomic<ULONGLONG> NextTraceId{ 1 };
+
+	//
+	// Buffer of the trace the calling thread has recorded into last.
+	//
+	thread_local ULONGLONG CachedTraceId = 0;
+	thread_local void* CachedThreadBuffer = nullptr;
+
+	VOID
+	WriteEscaped(
+		std::ostream& Output,
+		const std::string& String
+		)
+	{
+		for (CHAR Character : String)
+		{
+			if (Character == '"' || Character == '\\')
+			{
+				Output << '\\' << Character;
+			}
+			else if (static_cast<BYTE>(Character) < 0x20)
+			{
+				CHAR Escaped[8];
+				snprintf(Escaped, sizeof(Escaped), "\\u%04x", static_cast<BYTE>(Character));
+
+				Output << Escaped;
+			}
+			else
+			{
+				Output << Character;
+			}
+		}
+	}
+
+	VOID
+	WriteMicroseconds(
+		std::ostream& Output,
+		ULONGLONG Nanoseconds
+		)
+	{
+		CHAR Microseconds[32];
+		snprintf(Microseconds, sizeof(Microseconds), "%llu.%03llu",
+			static_cast<unsigned long long>(Nanoseconds / 1000),
+			static_cast<unsigned long long>(Nanoseconds % 1000));
+
+		Output << Microseconds;
+	}
+}
+
+VOID
+Trace::Span::Begin(
+	IN const CHAR* Name
+	)
+{
+	m_Name = Name;
+	m_Begin = m_Trace->GetTime();
+}
+
+VOID
+Trace::Span::End()
+{
+	ULONGLONG EndTime = m_Trace->GetTime();
+
+	m_Trace->GetThreadBuffer().Events.push_back(Event{ m_Name, std::move(m_Detail), m_Begin, EndTime });
+}
+
+Trace::Trace()
+	: m_Id(NextTraceId++)
+	, m_Start(std::chrono::steady_clock::now())
+{
+
+}
+
+BOOL
+Trace::Write(
+	IN const CHAR* Path
+	) const
+{
+	std::ofstream Output(Path, std::ios::out | std::ios::binary);
+
+	if (!Output)
+	{
+		return FALSE;
+	}
+
+	//
+	// Buffers (threads) which don't overlap in time share a track,
+	// each buffer is put on the first track free at its beginning.
+	//
+
+	std::vector<std::pair<ULONGLONG, ULONGLONG>> Ranges;
+	std::vector<size_t> Order;
+
+	for (auto&& Buffer : m_Buffers)
+	{
+		ULONGLONG Begin = ~0ULL;
+		ULONGLONG End = 0;
+
+		for (auto&& e : Buffer->Events)
+		{
+			Begin = (std::min)(Begin, e.Begin);
+			End = (std::max)(End, e.End);
+		}
+
+		Order.push_back(Ranges.size());
+		Ranges.emplace_back(Begin, End);
+	}
+
+	std::stable_sort(Order.begin(), Order.end(), [&Ranges](size_t Left, size_t Right) {
+		return Ranges[Left].first < Ranges[Right].first;
+	});
+
+	std::vector<ULONGLONG> TrackEnds;
+	std::vector<size_t> Tracks(m_Buffers.size());
+
+	for (size_t Index : Order)
+	{
+		size_t Track = 0;
+
+		while (Track < TrackEnds.size() && TrackEnds[Track] > Ranges[Index].first)
+		{
+			Track++;
+		}
+
+		if (Track == TrackEnds.size())
+		{
+			TrackEnds.push_back(0);
+		}
+
+		TrackEnds[Track] = Ranges[Index].second;
+		Tracks[Index] = Track;
+	}
+
+	Output << "{\"traceEvents\":[\n";
+
+	bool IsFirst = true;
+
+	for (size_t Track = 0; Track < TrackEnds.size(); Track++)
+	{
+		Output
+			<< (IsFirst ? "" : ",\n")
+			<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << Track + 1
+			<< ",\"args\":{\"name\":\"thread " << Track + 1 << "\"}}";
+
+		IsFirst = false;
+	}
+
+	for (size_t Index = 0; Index < m_Buffers.size(); Index++)
+	{
+		for (auto&& e : m_Buffers[Index]->Events)
+		{
+			Output
+				<< (IsFirst ? "" : ",\n")
+				<< "{\"name\":\"" << e.Name << "\",\"cat\":\"pdbex\",\"ph\":\"X\",\"ts\":";
+
+			WriteMicroseconds(Output, e.Begin);
+			Output << ",\"dur\":";
+			WriteMicroseconds(Output, e.End - e.Begin);
+
+			Output << ",\"pid\":1,\"tid\":" << Tracks[Index] + 1;
+
+			if (!e.Detail.empty())
+			{
+				Output << ",\"args\":{\"detail\":\"";
+				WriteEscaped(Output, e.Detail);
+				Output << "\"}";
+			}
+
+			Output << "}";
+
+			IsFirst = false;
+		}
+	}
+
+	Output << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	return Output.good() ? TRUE : FALSE;
+}
+
+Trace::ThreadBuffer&
+Trace::GetThreadBuffer()
+{
+	if (CachedTraceId != m_Id)
+	{
+		std::lock_guard<std::mutex> Lock(m_BufferLock);
+
+		m_Buffers.push_back(std::make_unique<ThreadBuffer>());
+
+		CachedTraceId = m_Id;
+		CachedThreadBuffer = m_Buffers.back().get();
+	}
+
+	return *static_cast<ThreadBuffer*>(CachedThreadBuffer);
+}
+
+ULONGLONG
+Trace::GetTime() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_Start).count();
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include "Platform.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// Recorder of the spans of one extraction (--trace), written
+// in the Chrome trace-event format (chrome://tracing, Perfetto).
+//
+// Each thread records its spans into its own buffer, the buffers
+// are merged only by Write().  Spans of a nullptr Trace are not
+// recorded, they cost only the check of the pointer.
+//
+// Threads of the pools are created for each ParallelFor(), in the
+// written trace they're laid out on as few tracks as possible -
+// a track per worker of the pool.
+//
+class Trace
+{
+	public:
+		//
+		// Records the time between its construction and destruction.
+		//
+		class Span
+		{
+			public:
+				Span(
+					IN Trace* Tracer,
+					IN const CHAR* Name,
+					IN const CHAR* Detail = nullptr
+					)
+					: m_Trace(Tracer)
+				{
+					if (m_Trace != nullptr)
+					{
+						Begin(Name);
+						m_Detail = Detail != nullptr ? Detail : "";
+					}
+				}
+
+				//
+				// Detail of the span is the range [First, Last).
+				//
+				Span(
+					IN Trace* Tracer,
+					IN const CHAR* Name,
+					IN ULONGLONG First,
+					IN ULONGLONG Last
+					)
+					: m_Trace(Tracer)
+				{
+					if (m_Trace != nullptr)
+					{
+						Begin(Name);
+						m_Detail = std::to_string(First) + "-" + std::to_string(Last);
+					}
+				}
+
+				~Span()
+				{
+					if (m_Trace != nullptr)
+					{
+						End();
+					}
+				}
+
+				Span(const Span&) = delete;
+				Span& operator=(const Span&) = delete;
+
+			private:
+				VOID
+				Begin(
+					IN const CHAR* Name
+					);
+
+				VOID
+				End();
+
+			private:
+				Trace*      m_Trace;
+				const CHAR* m_Name = nullptr;
+				std::string m_Detail;
+				ULONGLONG   m_Begin = 0;
+		};
+
+		Trace();
+
+		//
+		// Writes all spans recorded so far.  Must not be called
+		// while any other thread records a span.
+		//
+		// Returns non-zero value on success.
+		//
+		BOOL
+		Write(
+			IN const CHAR* Path
+			) const;
+
+	private:
+		struct Event
+		{
+			const CHAR* Name;
+			std::string Detail;
+			ULONGLONG   Begin;
+			ULONGLONG   End;
+		};
+
+		struct ThreadBuffer
+		{
+			std::vector<Event> Events;
+		};
+
+		//
+		// Buffer of the calling thread, created on its first span.
+		//
+		ThreadBuffer&
+		GetThreadBuffer();
+
+		//
+		// Nanoseconds since the construction.
+		//
+		ULONGLONG
+		GetTime() const;
+
+	private:
+		//
+		// Unique for each instance, identifies the instance
+		// the buffer cached by the thread belongs to.
+		//
+		ULONGLONG m_Id;
+
+		std::chrono::steady_clock::time_point m_Start;
+
+		std::mutex m_BufferLock;
+		std::vector<std::unique_ptr<ThreadBuffer>> m_Buffers;
+};
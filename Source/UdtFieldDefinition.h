@@ -1,5 +1,6 @@
 #pragma once
 #include "UdtFieldDefinitionBase.h"
+#include "InlineString.h"
 
 #include <string>
 
@@ -24,17 +25,17 @@ class UdtFieldDefinition
 
 			if (Symbol->BaseType == btFloat && Symbol->Size == 10)
 			{
-				m_Comment += " /* 80-bit float */";
+				m_Comment.Append(" /* 80-bit float */");
 			}
 
 			if (Symbol->IsConst)
 			{
-				m_TypePrefix += "const ";
+				m_TypePrefix.Append("const ");
 			}
 
 			if (Symbol->IsVolatile)
 			{
-				m_TypePrefix += "volatile ";
+				m_TypePrefix.Append("volatile ");
 			}
 
 			//
@@ -43,7 +44,7 @@ class UdtFieldDefinition
 			//
 
 			const CHAR* BasicTypeString = PDB::GetBasicTypeString(Symbol, m_Settings->UseStdInt);
-			m_TypePrefix += (BasicTypeString != nullptr ? BasicTypeString : "<unknown_type>");
+			m_TypePrefix.Append(BasicTypeString != nullptr ? BasicTypeString : "<unknown_type>");
 		}
 
 		void
@@ -53,21 +54,21 @@ class UdtFieldDefinition
 		{
 			if (Symbol->u.Pointer.IsReference)
 			{
-				m_TypePrefix += "&";
+				m_TypePrefix.Append("&");
 			}
 			else
 			{
-				m_TypePrefix += "*";
+				m_TypePrefix.Append("*");
 			}
 
 			if (Symbol->IsConst)
 			{
-				m_TypePrefix += " const";
+				m_TypePrefix.Append(" const");
 			}
 
 			if (Symbol->IsVolatile)
 			{
-				m_TypePrefix += " volatile";
+				m_TypePrefix.Append(" volatile");
 			}
 		}
 
@@ -102,13 +103,15 @@ class UdtFieldDefinition
 				//
 
 				const_cast<SYMBOL*>(Symbol)->Size = 1;
-				m_TypePrefix += "*";
+				m_TypePrefix.Append("*");
 
-				m_Comment += " /* zero-length array */";
+				m_Comment.Append(" /* zero-length array */");
 			}
 			else
 			{
-				m_TypeSuffix += "[" + std::to_string(Symbol->u.Array.ElementCount) + "]";
+				m_TypeSuffix.Append("[");
+				m_TypeSuffix.AppendDecimal(Symbol->u.Array.ElementCount);
+				m_TypeSuffix.Append("]");
 			}
 		}
 
@@ -122,9 +125,9 @@ class UdtFieldDefinition
 			// Currently, show void* instead of functions.
 			//
 
-			m_TypePrefix += "void";
+			m_TypePrefix.Append("void");
 
-			m_Comment += " /* function */";
+			m_Comment.Append(" /* function */");
 		}
 
 		void
@@ -132,13 +135,42 @@ class UdtFieldDefinition
 			const CHAR* MemberName
 			) override
 		{
-			m_MemberName = MemberName ? MemberName : std::string();
+			m_MemberName = MemberName ? MemberName : "";
 		}
 
 		std::string
 		GetPrintableDefinition() const override
 		{
-			return m_TypePrefix + " " + m_MemberName + m_TypeSuffix + m_Comment;
+			std::string PrintableDefinition;
+
+			PrintableDefinition.append(m_TypePrefix.GetData(), m_TypePrefix.GetLength());
+			PrintableDefinition.append(" ");
+			PrintableDefinition.append(m_MemberName);
+			PrintableDefinition.append(m_TypeSuffix.GetData(), m_TypeSuffix.GetLength());
+			PrintableDefinition.append(m_Comment.GetData(), m_Comment.GetLength());
+
+			return PrintableDefinition;
+		}
+
+		void
+		WritePrintableDefinition(
+			OutputSink& Output
+			) const override
+		{
+			Output.Write(m_TypePrefix.GetData(), m_TypePrefix.GetLength());
+			Output.Write(" ");
+			Output.Write(m_MemberName);
+			Output.Write(m_TypeSuffix.GetData(), m_TypeSuffix.GetLength());
+			Output.Write(m_Comment.GetData(), m_Comment.GetLength());
+		}
+
+		void
+		Clear() override
+		{
+			m_TypePrefix.Clear();
+			m_MemberName = "";
+			m_TypeSuffix.Clear();
+			m_Comment.Clear();
 		}
 
 		void
@@ -146,11 +178,9 @@ class UdtFieldDefinition
 			void* MemberDefinitionSettings
 			) override
 		{
-			static Settings DefaultSettings;
-
 			if (MemberDefinitionSettings == nullptr)
 			{
-				MemberDefinitionSettings = &DefaultSettings;
+				MemberDefinitionSettings = &m_DefaultSettings;
 			}
 
 			m_Settings = static_cast<Settings*>(MemberDefinitionSettings);
@@ -164,10 +194,14 @@ class UdtFieldDefinition
 		}
 
 	private:
-		std::string m_TypePrefix; // "int*"
-		std::string m_MemberName; // "XYZ"
-		std::string m_TypeSuffix; // "[8]"
-		std::string m_Comment;
-
-		Settings* m_Settings;
+		//
+		// Member names live in the PDB, they're not copied.
+		//
+		InlineString<96> m_TypePrefix; // "int*"
+		const CHAR*      m_MemberName = ""; // "XYZ"
+		InlineString<32> m_TypeSuffix; // "[8]"
+		InlineString<32> m_Comment;
+
+		Settings* m_Settings = nullptr;
+		Settings  m_DefaultSettings;
 };
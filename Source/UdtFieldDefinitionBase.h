@@ -1,5 +1,6 @@
 #pragma once
 #include "PDB.h"
+#include "OutputSink.h"
 
 #include <string>
 
@@ -104,6 +105,30 @@ class UdtFieldDefinitionBase
 			return std::string();
 		}
 
+		//
+		// Same as Output.Write(GetPrintableDefinition()),
+		// without the temporary string.
+		//
+		virtual
+		void
+		WritePrintableDefinition(
+			OutputSink& Output
+			) const
+		{
+			Output.Write(GetPrintableDefinition());
+		}
+
+		//
+		// Member definitions are reused, this makes the
+		// definition ready for the next member.
+		//
+		virtual
+		void
+		Clear()
+		{
+
+		}
+
 		virtual
 		void
 		SetSettings(
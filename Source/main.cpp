@@ -1,9 +1,18 @@
 #include "PDBExtractor.h"
+#include "PDBBatchExtractor.h"
+
+#include <cstring>
 
 #pragma comment(lib, "dbghelp.lib")
 
 int main_impl(int argc, char** argv)
 {
+	if (argc >= 2 && strcmp(argv[1], "--batch") == 0)
+	{
+		PDBBatchExtractor Instance;
+		return Instance.Run(argc, argv);
+	}
+
 	PDBExtractor Instance;
 	return Instance.Run(argc, argv);
 }